@@ -97,6 +97,8 @@
 
 #include "libswresample/swresample.h"
 
+#include "libswscale/swscale.h"
+
 #include "cmdutils.h"
 #include "ffmpeg.h"
 #include "sync_queue.h"
@@ -376,6 +378,10 @@ static void ffmpeg_cleanup(int ret)
 
     hw_device_free_all();
 
+#if CONFIG_SWSCALE
+    sws_free_filter_cache();
+#endif
+
     av_freep(&filter_nbthreads);
 
     av_freep(&input_files);
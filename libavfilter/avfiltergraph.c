@@ -598,6 +598,126 @@ static enum AVSampleFormat find_best_sample_fmt_of_2(enum AVSampleFormat dst_fmt
     return score1 < score2 ? dst_fmt1 : dst_fmt2;
 }
 
+/**
+ * Rough estimate of the work needed to convert one pixel from src_fmt to
+ * dst_fmt: bytes read and written, plus penalties for a colorspace matrix,
+ * chroma resampling, packed/planar reordering and int/float conversion.
+ */
+static int get_pix_fmt_conversion_cost(enum AVPixelFormat dst_fmt,
+                                       enum AVPixelFormat src_fmt)
+{
+    const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(src_fmt);
+    const AVPixFmtDescriptor *dst_desc = av_pix_fmt_desc_get(dst_fmt);
+    int cost;
+
+    if (dst_fmt == src_fmt)
+        return 0;
+    if (!src_desc || !dst_desc)
+        return INT_MAX / 4;
+
+    cost = av_get_padded_bits_per_pixel(src_desc) +
+           av_get_padded_bits_per_pixel(dst_desc);
+    if ((src_desc->flags ^ dst_desc->flags) & AV_PIX_FMT_FLAG_RGB)
+        cost += 24;
+    if (src_desc->log2_chroma_w != dst_desc->log2_chroma_w ||
+        src_desc->log2_chroma_h != dst_desc->log2_chroma_h)
+        cost += 8;
+    if ((src_desc->flags ^ dst_desc->flags) & AV_PIX_FMT_FLAG_PLANAR)
+        cost += 8;
+    if ((src_desc->flags ^ dst_desc->flags) & AV_PIX_FMT_FLAG_FLOAT)
+        cost += 8;
+
+    return cost;
+}
+
+static int is_auto_conversion_filter(AVFilterContext *f)
+{
+    const AVFilterNegotiation *neg;
+
+    if (f->nb_inputs != 1 || f->nb_outputs != 1 || !f->inputs[0] ||
+        strncmp(f->name, "auto_", 5))
+        return 0;
+    neg = ff_filter_get_negotiation(f->inputs[0]);
+    return neg && !strcmp(f->filter->name, neg->conversion_filter);
+}
+
+/**
+ * Estimate the cost of choosing fmt on link, counting the conversion into
+ * link and, when the destination filter can pass fmt through to an
+ * automatically inserted converter, the conversion back out of it.
+ */
+static int get_link_conversion_cost(AVFilterLink *link, enum AVPixelFormat fmt,
+                                    enum AVPixelFormat ref_fmt)
+{
+    AVFilterContext *dst = link->dst;
+    int cost = get_pix_fmt_conversion_cost(fmt, ref_fmt);
+    int i, j;
+
+    for (i = 0; i < dst->nb_outputs; i++) {
+        AVFilterLink *out = dst->outputs[i];
+        AVFilterLink *conv_out;
+        enum AVPixelFormat target = ref_fmt;
+        int passthrough = 0;
+
+        if (!out || out->type != AVMEDIA_TYPE_VIDEO ||
+            !is_auto_conversion_filter(out->dst))
+            continue;
+
+        if (out->format >= 0) {
+            passthrough = out->format == fmt;
+        } else if (out->incfg.formats) {
+            for (j = 0; j < out->incfg.formats->nb_formats; j++)
+                passthrough |= out->incfg.formats->formats[j] == fmt;
+        }
+        if (!passthrough)
+            continue;
+
+        conv_out = out->dst->outputs[0];
+        if (conv_out->format >= 0)
+            target = conv_out->format;
+        else if (conv_out->incfg.formats && conv_out->incfg.formats->nb_formats == 1)
+            target = conv_out->incfg.formats->formats[0];
+        cost += get_pix_fmt_conversion_cost(target, fmt);
+    }
+
+    return cost;
+}
+
+/**
+ * Among the formats of link which the loss heuristic ranks the same as
+ * best, pick the one with the lowest estimated conversion cost.
+ */
+static enum AVPixelFormat pick_cheapest_pix_fmt(AVFilterLink *link, enum AVPixelFormat best,
+                                                enum AVPixelFormat ref_fmt, int has_alpha)
+{
+    const AVPixFmtDescriptor *ref_desc = av_pix_fmt_desc_get(ref_fmt);
+    int best_cost, i;
+
+    if (best == AV_PIX_FMT_NONE || best == ref_fmt ||
+        (ref_desc->flags & AV_PIX_FMT_FLAG_HWACCEL))
+        return best;
+
+    best_cost = get_link_conversion_cost(link, best, ref_fmt);
+    for (i = 0; i < link->incfg.formats->nb_formats; i++) {
+        enum AVPixelFormat p = link->incfg.formats->formats[i];
+        int cost;
+
+        /* the loss heuristic only depends on argument order on a tie */
+        if (p == best ||
+            av_find_best_pix_fmt_of_2(best, p, ref_fmt, has_alpha, NULL) != best ||
+            av_find_best_pix_fmt_of_2(p, best, ref_fmt, has_alpha, NULL) != p)
+            continue;
+
+        cost = get_link_conversion_cost(link, p, ref_fmt);
+        if (cost < best_cost) {
+            best      = p;
+            best_cost = cost;
+        }
+    }
+
+    return best;
+}
+
 static int pick_format(AVFilterLink *link, AVFilterLink *ref)
 {
     if (!link || !link->incfg.formats)
@@ -613,6 +733,7 @@ static int pick_format(AVFilterLink *link, AVFilterLink *ref)
                 enum AVPixelFormat p = link->incfg.formats->formats[i];
                 best= av_find_best_pix_fmt_of_2(best, p, ref->format, has_alpha, NULL);
             }
+            best = pick_cheapest_pix_fmt(link, best, ref->format, has_alpha);
             av_log(link->src,AV_LOG_DEBUG, "picking %s out of %d ref:%s alpha:%d\n",
                    av_get_pix_fmt_name(best), link->incfg.formats->nb_formats,
                    av_get_pix_fmt_name(ref->format), has_alpha);
@@ -1094,6 +1215,34 @@ static int pick_formats(AVFilterGraph *graph)
     return 0;
 }
 
+static void log_conversions(AVFilterGraph *graph)
+{
+    int i;
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        AVFilterLink *inlink, *outlink;
+
+        if (!is_auto_conversion_filter(f))
+            continue;
+        inlink  = f->inputs[0];
+        outlink = f->outputs[0];
+        if (inlink->type == AVMEDIA_TYPE_VIDEO)
+            av_log(graph, AV_LOG_VERBOSE,
+                   "%s: converting %s -> %s between '%s' and '%s' (estimated cost %d)\n",
+                   f->name, av_get_pix_fmt_name(inlink->format),
+                   av_get_pix_fmt_name(outlink->format), inlink->src->name,
+                   outlink->dst->name,
+                   get_pix_fmt_conversion_cost(outlink->format, inlink->format));
+        else if (inlink->type == AVMEDIA_TYPE_AUDIO)
+            av_log(graph, AV_LOG_VERBOSE,
+                   "%s: converting %s -> %s between '%s' and '%s'\n",
+                   f->name, av_get_sample_fmt_name(inlink->format),
+                   av_get_sample_fmt_name(outlink->format), inlink->src->name,
+                   outlink->dst->name);
+    }
+}
+
 /**
  * Configure the formats of all the links in the graph.
  */
@@ -1122,6 +1271,8 @@ static int graph_config_formats(AVFilterGraph *graph, void *log_ctx)
     if ((ret = pick_formats(graph)) < 0)
         return ret;
 
+    log_conversions(graph);
+
     return 0;
 }
 
@@ -160,6 +160,8 @@ typedef struct SelectContext {
     ff_scene_sad_fn sad;            ///< Sum of the absolute difference function (scene detect only)
     double prev_mafd;               ///< previous MAFD                           (scene detect only)
     AVFrame *prev_picref;           ///< previous frame                          (scene detect only)
+    uint64_t frame_sad;             ///< SAD against the previous frame          (scene detect only)
+    int64_t sad_ref_pts;            ///< previous frame pts, NOPTS if no SAD     (scene detect only)
     double select;
     int select_out;                 ///< mark the selected output pad index
     int nb_outputs;
@@ -279,22 +281,23 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
     double ret = 0;
     SelectContext *select = ctx->priv;
     AVFrame *prev_picref = select->prev_picref;
+    uint64_t sad;
+    int have_sad = ff_scene_sad_get_meta(frame, prev_picref, &sad);
 
+    select->sad_ref_pts = AV_NOPTS_VALUE;
     if (prev_picref &&
         frame->height == prev_picref->height &&
         frame->width  == prev_picref->width) {
-        uint64_t sad = 0;
         double mafd, diff;
         uint64_t count = 0;
 
-        for (int plane = 0; plane < select->nb_planes; plane++) {
-            uint64_t plane_sad;
-            select->sad(prev_picref->data[plane], prev_picref->linesize[plane],
-                    frame->data[plane], frame->linesize[plane],
-                    select->width[plane], select->height[plane], &plane_sad);
-            sad += plane_sad;
+        if (!have_sad)
+            sad = ff_scene_sad_frame(ctx, select->sad, prev_picref, frame,
+                                     select->nb_planes, select->width, select->height);
+        select->frame_sad   = sad;
+        select->sad_ref_pts = prev_picref->pts;
+        for (int plane = 0; plane < select->nb_planes; plane++)
             count += select->width[plane] * select->height[plane];
-        }
 
         mafd = (double)sad / count / (1ULL << (select->bitdepth - 8));
         diff = fabs(mafd - select->prev_mafd);
@@ -366,6 +369,9 @@ FF_ENABLE_DEPRECATION_WARNINGS
             // TODO: document metadata
             snprintf(buf, sizeof(buf), "%f", select->var_values[VAR_SCENE]);
             av_dict_set(&frame->metadata, "lavfi.scene_score", buf, 0);
+            ff_scene_sad_set_meta(ctx, frame, select->sad_ref_pts, select->frame_sad);
+        } else {
+            av_dict_set(&frame->metadata, FF_SCENE_SAD_META_KEY, NULL, 0);
         }
         break;
     }
@@ -542,6 +548,7 @@ const AVFilter ff_vf_select = {
     .priv_class    = &select_class,
     FILTER_INPUTS(avfilter_vf_select_inputs),
     FILTER_QUERY_FUNC(query_formats),
-    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_METADATA_ONLY |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif /* CONFIG_SELECT_FILTER */
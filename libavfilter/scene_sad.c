@@ -21,8 +21,21 @@
  * Scene SAD functions
  */
 
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "config_components.h"
+
+#include "libavutil/dict.h"
+#include "libavutil/frame.h"
+#include "internal.h"
 #include "scene_sad.h"
 
+#define MAX_JOBS 32
+
+extern const AVFilter ff_vf_select;
+extern const AVFilter ff_vf_scdet;
+
 void ff_scene_sad16_c(SCENE_SAD_PARAMS)
 {
     uint64_t sad = 0;
@@ -71,3 +84,98 @@ ff_scene_sad_fn ff_scene_sad_get_fn(int depth)
     return sad;
 }
 
+
+typedef struct ThreadData {
+    ff_scene_sad_fn sad;
+    const AVFrame *src1, *src2;
+    int nb_planes;
+    const ptrdiff_t *width, *height;
+    uint64_t sums[MAX_JOBS];
+} ThreadData;
+
+static int scene_sad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ThreadData *td = arg;
+    uint64_t sum = 0;
+
+    for (int plane = 0; plane < td->nb_planes; plane++) {
+        const ptrdiff_t stride1 = td->src1->linesize[plane];
+        const ptrdiff_t stride2 = td->src2->linesize[plane];
+        const ptrdiff_t slice_start = (td->height[plane] *  jobnr     ) / nb_jobs;
+        const ptrdiff_t slice_end   = (td->height[plane] * (jobnr + 1)) / nb_jobs;
+        uint64_t plane_sad;
+
+        if (!td->width[plane] || slice_end <= slice_start)
+            continue;
+
+        td->sad(td->src1->data[plane] + slice_start * stride1, stride1,
+                td->src2->data[plane] + slice_start * stride2, stride2,
+                td->width[plane], slice_end - slice_start, &plane_sad);
+        sum += plane_sad;
+    }
+    td->sums[jobnr] = sum;
+
+    return 0;
+}
+
+uint64_t ff_scene_sad_frame(AVFilterContext *ctx, ff_scene_sad_fn sad,
+                            const AVFrame *src1, const AVFrame *src2, int nb_planes,
+                            const ptrdiff_t *width, const ptrdiff_t *height)
+{
+    ThreadData td = {
+        .sad       = sad,
+        .src1      = src1,
+        .src2      = src2,
+        .nb_planes = nb_planes,
+        .width     = width,
+        .height    = height,
+    };
+    const int nb_jobs = av_clip(FFMIN(height[0], ff_filter_get_nb_threads(ctx)), 1, MAX_JOBS);
+    uint64_t sum = 0;
+
+    ff_filter_execute(ctx, scene_sad_slice, &td, NULL, nb_jobs);
+    for (int i = 0; i < nb_jobs; i++)
+        sum += td.sums[i];
+
+    return sum;
+}
+
+int ff_scene_sad_set_meta(AVFilterContext *ctx, AVFrame *frame, int64_t ref_pts,
+                          uint64_t sad)
+{
+    const AVFilterContext *next;
+    char buf[64];
+
+    if (ref_pts == AV_NOPTS_VALUE || ctx->nb_outputs != 1)
+        return 0;
+
+    /* only hand it over directly, any filter in between may change the pixels */
+    next = ctx->outputs[0]->dst;
+    if (!(CONFIG_SELECT_FILTER && next->filter == &ff_vf_select) &&
+        !(CONFIG_SCDET_FILTER  && next->filter == &ff_vf_scdet))
+        return 0;
+
+    snprintf(buf, sizeof(buf), "%"PRIu64" %"PRId64, sad, ref_pts);
+    return av_dict_set(&frame->metadata, FF_SCENE_SAD_META_KEY, buf, 0);
+}
+
+int ff_scene_sad_get_meta(AVFrame *frame, const AVFrame *ref, uint64_t *sad)
+{
+    const AVDictionaryEntry *e = av_dict_get(frame->metadata, FF_SCENE_SAD_META_KEY, NULL, 0);
+    uint64_t value;
+    int64_t ref_pts;
+    int ret = 0;
+
+    if (!e)
+        return 0;
+
+    if (ref && ref->pts != AV_NOPTS_VALUE &&
+        sscanf(e->value, "%"SCNu64" %"SCNd64, &value, &ref_pts) == 2 &&
+        ref_pts == ref->pts) {
+        *sad = value;
+        ret = 1;
+    }
+    av_dict_set(&frame->metadata, FF_SCENE_SAD_META_KEY, NULL, 0);
+
+    return ret;
+}
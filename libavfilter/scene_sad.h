@@ -41,4 +41,41 @@ ff_scene_sad_fn ff_scene_sad_get_fn_x86(int depth);
 
 ff_scene_sad_fn ff_scene_sad_get_fn(int depth);
 
+/**
+ * Compute the SAD between the planes of two frames, splitting the rows of
+ * each plane across the threads of ctx. The filter must have
+ * AVFILTER_FLAG_SLICE_THREADS set for the split to happen.
+ *
+ * @param nb_planes number of planes to compare, planes with a width of 0
+ *                  are skipped
+ * @param width     width in samples of each plane
+ * @param height    height of each plane
+ */
+uint64_t ff_scene_sad_frame(AVFilterContext *ctx, ff_scene_sad_fn sad,
+                            const AVFrame *src1, const AVFrame *src2, int nb_planes,
+                            const ptrdiff_t *width, const ptrdiff_t *height);
+
+#define FF_SCENE_SAD_META_KEY "lavfi.scene_sad"
+
+/**
+ * Pass the SAD of the first plane, or of all the planes for packed and
+ * RGB formats, between frame and the previous frame to the next filter
+ * as frame metadata, if that filter is a scene detecting one that can reuse
+ * it instead of computing it again. This must be the last metadata entry
+ * set on the frame, so that removing it keeps the order of the others.
+ *
+ * @param ref_pts pts of the previous frame
+ */
+int ff_scene_sad_set_meta(AVFilterContext *ctx, AVFrame *frame, int64_t ref_pts,
+                          uint64_t sad);
+
+/**
+ * Retrieve and remove a SAD passed by ff_scene_sad_set_meta().
+ *
+ * @param ref the previous frame, may be NULL to only remove the SAD
+ * @return 1 if *sad was set because the SAD was computed against ref,
+ *         0 otherwise
+ */
+int ff_scene_sad_get_meta(AVFrame *frame, const AVFrame *ref, uint64_t *sad);
+
 #endif /* AVFILTER_SCENE_SAD_H */
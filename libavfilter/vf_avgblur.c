@@ -41,8 +41,10 @@ typedef struct AverageBlurContext {
     int planewidth[4];
     int planeheight[4];
     void *buffer;
+    int buffer_size;
     uint16_t lut[256 * 256 * 256];
     int nb_planes;
+    int nb_threads;
 
     int (*filter[2])(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
 } AverageBlurContext;
@@ -70,6 +72,19 @@ typedef struct ThreadData {
 #define LUT_DIV(sum, area) (lut[(sum)])
 #define SLOW_DIV(sum, area) ((sum) / (area))
 
+#define FILTER_ROW(lutdiv)                                                        \
+    sum = 0;                                                                      \
+    for (int x = -size_w; x <= size_w; x++)                                       \
+        sum += col_sum[x];                                                        \
+    av_assert2(sum >= 0);                                                         \
+    dst[0] = lutdiv(sum, area);                                                   \
+                                                                                  \
+    for (int x = 1; x < width; x++) {                                             \
+        sum = sum - col_sum[x - size_w - 1] + col_sum[x + size_w];                \
+        av_assert2(sum >= 0);                                                     \
+        dst[x] = lutdiv(sum, area);                                               \
+    }
+
 #define FILTER(name, type, btype, lutunused, areaunused, lutdiv)                  \
 static int filter_##name(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs) \
 {                                                                                 \
@@ -79,61 +94,38 @@ static int filter_##name(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs
     lutunused const uint16_t *lut = s->lut;                                       \
     const int size_w = s->radius;                                                 \
     const int size_h = s->radiusV;                                                \
-    btype *col_sum = (btype *)s->buffer + size_w;                                 \
+    btype *col_sum = (btype *)s->buffer + jobnr * s->buffer_size + size_w;        \
     const int dlinesize = td->dlinesize / sizeof(type);                           \
     const int linesize = td->linesize / sizeof(type);                             \
     const int height = td->height;                                                \
     const int width = td->width;                                                  \
-    const type *src = td->ptr;                                                    \
-    type *dst = td->dptr;                                                         \
+    const int slice_start = (height * jobnr) / nb_jobs;                           \
+    const int slice_end = (height * (jobnr+1)) / nb_jobs;                         \
+    const type *src = (const type *)td->ptr + slice_start * linesize;             \
+    type *dst = (type *)td->dptr + slice_start * dlinesize;                       \
     btype sum = 0;                                                                \
                                                                                   \
-    for (int x = -size_w; x < 0; x++) {                                           \
-        sum = src[0] * size_h;                                                    \
-        for (int y = 0; y <= size_h; y++)                                         \
-            sum += src[y * linesize];                                             \
-        av_assert2(sum >= 0);                                                     \
-        col_sum[x] = sum;                                                         \
-    }                                                                             \
+    memset(col_sum - size_w, 0, (width + 2 * size_w) * sizeof(*col_sum));         \
+    for (int y = slice_start - size_h; y <= slice_start + size_h; y++) {          \
+        const type *row = (const type *)td->ptr + av_clip(y, 0, height - 1) * linesize; \
                                                                                   \
-    for (int x = 0; x < width; x++) {                                             \
-        sum = src[x] * size_h;                                                    \
-        for (int y = 0; y <= size_h; y++)                                         \
-            sum += src[x + y * linesize];                                         \
-        av_assert2(sum >= 0);                                                     \
-        col_sum[x] = sum;                                                         \
-    }                                                                             \
-                                                                                  \
-    for (int x = width; x < width + size_w; x++) {                                \
-        sum = src[width - 1] * size_h;                                            \
-        for (int y = 0; y <= size_h; y++)                                         \
-            sum += src[width - 1 + y * linesize];                                 \
-        av_assert2(sum >= 0);                                                     \
-        col_sum[x] = sum;                                                         \
+        for (int x = -size_w; x < 0; x++)                                         \
+            col_sum[x] += row[0];                                                 \
+        for (int x = 0; x < width; x++)                                           \
+            col_sum[x] += row[x];                                                 \
+        for (int x = width; x < width + size_w; x++)                              \
+            col_sum[x] += row[width - 1];                                         \
     }                                                                             \
                                                                                   \
-    sum = 0;                                                                      \
-    for (int x = -size_w; x <= size_w; x++)                                       \
-        sum += col_sum[x];                                                        \
-    av_assert2(sum >= 0);                                                         \
-    dst[0] = lutdiv(sum, area);                                                   \
+    FILTER_ROW(lutdiv)                                                            \
                                                                                   \
-    for (int x = 1; x < width; x++) {                                             \
-        sum = sum - col_sum[x - size_w - 1] + col_sum[x + size_w];                \
-        av_assert2(sum >= 0);                                                     \
-        dst[x] = lutdiv(sum, area);                                               \
-    }                                                                             \
-                                                                                  \
-    src = td->ptr;                                                                \
     src += linesize;                                                              \
     dst += dlinesize;                                                             \
                                                                                   \
-    for (int y = 1; y < height; y++) {                                            \
+    for (int y = slice_start + 1; y < slice_end; y++) {                           \
         const int syp = FFMIN(size_h, height - y - 1) * linesize;                 \
         const int syn = FFMIN(y, size_h + 1) * linesize;                          \
                                                                                   \
-        sum = 0;                                                                  \
-                                                                                  \
         for (int x = -size_w; x < 0; x++)                                         \
             col_sum[x] += src[0 + syp] - src[0 - syn];                            \
                                                                                   \
@@ -143,16 +135,7 @@ static int filter_##name(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs
         for (int x = width; x < width + size_w; x++)                              \
             col_sum[x] += src[width - 1 + syp] - src[width - 1 - syn];            \
                                                                                   \
-        for (int x = -size_w; x <= size_w; x++)                                   \
-            sum += col_sum[x];                                                    \
-        av_assert2(sum >= 0);                                                     \
-        dst[0] = lutdiv(sum, area);                                               \
-                                                                                  \
-        for (int x = 1; x < width; x++) {                                         \
-            sum = sum - col_sum[x - size_w - 1] + col_sum[x + size_w];            \
-            av_assert2(sum >= 0);                                                 \
-            dst[x] = lutdiv(sum, area);                                           \
-        }                                                                         \
+        FILTER_ROW(lutdiv)                                                        \
                                                                                   \
         src += linesize;                                                          \
         dst += dlinesize;                                                         \
@@ -210,7 +193,10 @@ static int config_input(AVFilterLink *inlink)
 
     s->nb_planes = av_pix_fmt_count_planes(inlink->format);
 
-    s->buffer = av_calloc(inlink->w + (1024 * 2 + 1), 4 * ((s->depth + 7) / 8));
+    /* one column sum row per job, wide enough for the largest radius */
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    s->buffer_size = inlink->w + (1024 * 2 + 1);
+    s->buffer = av_calloc(s->nb_threads * s->buffer_size, 4 * ((s->depth + 7) / 8));
     if (!s->buffer)
         return AVERROR(ENOMEM);
 
@@ -242,7 +228,8 @@ static void averageiir2d(AVFilterContext *ctx, AVFrame *in, AVFrame *out, int pl
     td.linesize = in->linesize[plane];
     td.dptr = out->data[plane];
     td.dlinesize = out->linesize[plane];
-    s->filter[slow](ctx, &td, 0, 0);
+    ff_filter_execute(ctx, s->filter[slow], &td, NULL,
+                      FFMIN(height, s->nb_threads));
 }
 
 static const enum AVPixelFormat pix_fmts[] = {
@@ -342,6 +329,6 @@ const AVFilter ff_vf_avgblur = {
     FILTER_INPUTS(avgblur_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
     .process_command = process_command,
 };
@@ -44,15 +44,29 @@ typedef struct BoxBlurContext {
     int hsub, vsub;
     int radius[4];
     int power[4];
-    uint8_t *temp[2]; ///< temporary buffer used in blur_power()
+    int nb_threads;
+    size_t temp_size;
+    uint8_t *temp; ///< per-job temporary buffers used in blur_power() and vblur
 } BoxBlurContext;
 
+/* number of columns the vertical pass transposes at once */
+#define TILE_W 16
+
+typedef struct ThreadData {
+    uint8_t *dst;
+    int dst_linesize;
+    const uint8_t *src;
+    int src_linesize;
+    int w, h;
+    int radius, power;
+    int pixsize;
+} ThreadData;
+
 static av_cold void uninit(AVFilterContext *ctx)
 {
     BoxBlurContext *s = ctx->priv;
 
-    av_freep(&s->temp[0]);
-    av_freep(&s->temp[1]);
+    av_freep(&s->temp);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -80,8 +94,11 @@ static int config_input(AVFilterLink *inlink)
     int w = inlink->w, h = inlink->h;
     int ret;
 
-    if (!(s->temp[0] = av_malloc(2*FFMAX(w, h))) ||
-        !(s->temp[1] = av_malloc(2*FFMAX(w, h))))
+    /* two blur_power() lines plus one transposed tile per job */
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    s->temp_size = 2 * (2 * FFMAX(w, h)) + TILE_W * 2 * h;
+    av_freep(&s->temp);
+    if (!(s->temp = av_malloc_array(s->nb_threads, s->temp_size)))
         return AVERROR(ENOMEM);
 
     s->hsub = desc->log2_chroma_w;
@@ -198,30 +215,75 @@ static inline void blur_power(uint8_t *dst, int dst_step, const uint8_t *src, in
     }
 }
 
-static void hblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
+static int hblur(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    int y;
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int slice_start = (td->h * jobnr) / nb_jobs;
+    const int slice_end = (td->h * (jobnr+1)) / nb_jobs;
+    uint8_t *buf = s->temp + jobnr * s->temp_size;
+    uint8_t *temp[2] = { buf, buf + 2 * FFMAX(td->w, td->h) };
 
-    if (radius == 0 && dst == src)
-        return;
+    for (int y = slice_start; y < slice_end; y++)
+        blur_power(td->dst + y*td->dst_linesize, td->pixsize,
+                   td->src + y*td->src_linesize, td->pixsize,
+                   td->w, td->radius, td->power, temp, td->pixsize);
 
-    for (y = 0; y < h; y++)
-        blur_power(dst + y*dst_linesize, pixsize, src + y*src_linesize, pixsize,
-                   w, radius, power, temp, pixsize);
+    return 0;
 }
 
-static void vblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
+/* The columns are copied into a transposed tile first, so that both the
+ * loads from the frame and the running sums work on contiguous memory. */
+static int vblur(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    int x;
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int pixsize = td->pixsize;
+    const int h = td->h;
+    const int nb_tiles = (td->w + TILE_W - 1) / TILE_W;
+    const int tile_start = (nb_tiles * jobnr) / nb_jobs;
+    const int tile_end = (nb_tiles * (jobnr+1)) / nb_jobs;
+    uint8_t *buf = s->temp + jobnr * s->temp_size;
+    uint8_t *temp[2] = { buf, buf + 2 * FFMAX(td->w, h) };
+    uint8_t *tile = buf + 2 * (2 * FFMAX(td->w, h));
+
+    for (int t = tile_start; t < tile_end; t++) {
+        const int x0 = t * TILE_W;
+        const int tw = FFMIN(TILE_W, td->w - x0);
+
+        for (int y = 0; y < h; y++) {
+            const uint8_t *src = td->src + y * td->src_linesize + x0 * pixsize;
+
+            if (pixsize == 1) {
+                for (int i = 0; i < tw; i++)
+                    tile[i * h + y] = src[i];
+            } else {
+                for (int i = 0; i < tw; i++)
+                    ((uint16_t *)tile)[i * h + y] = ((const uint16_t *)src)[i];
+            }
+        }
+
+        for (int i = 0; i < tw; i++) {
+            uint8_t *line = tile + i * h * pixsize;
+
+            blur_power(line, pixsize, line, pixsize,
+                       h, td->radius, td->power, temp, pixsize);
+        }
+
+        for (int y = 0; y < h; y++) {
+            uint8_t *dst = td->dst + y * td->dst_linesize + x0 * pixsize;
 
-    if (radius == 0 && dst == src)
-        return;
+            if (pixsize == 1) {
+                for (int i = 0; i < tw; i++)
+                    dst[i] = tile[i * h + y];
+            } else {
+                for (int i = 0; i < tw; i++)
+                    ((uint16_t *)dst)[i] = ((uint16_t *)tile)[i * h + y];
+            }
+        }
+    }
 
-    for (x = 0; x < w; x++)
-        blur_power(dst + x*pixsize, dst_linesize, src + x*pixsize, src_linesize,
-                   h, radius, power, temp, pixsize);
+    return 0;
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
@@ -245,17 +307,29 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        hblur(out->data[plane], out->linesize[plane],
-              in ->data[plane], in ->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
+        ThreadData td;
+
+        td.w       = w[plane];
+        td.h       = h[plane];
+        td.radius  = s->radius[plane];
+        td.power   = s->power[plane];
+        td.pixsize = pixsize;
+
+        td.dst = out->data[plane];
+        td.dst_linesize = out->linesize[plane];
+        td.src = in->data[plane];
+        td.src_linesize = in->linesize[plane];
+        ff_filter_execute(ctx, hblur, &td, NULL, FFMIN(td.h, s->nb_threads));
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        vblur(out->data[plane], out->linesize[plane],
-              out->data[plane], out->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+        if (td.radius == 0)
+            continue;
+
+        td.src = out->data[plane];
+        td.src_linesize = out->linesize[plane];
+        ff_filter_execute(ctx, vblur, &td, NULL,
+                          FFMIN((td.w + TILE_W - 1) / TILE_W, s->nb_threads));
+    }
 
     av_frame_free(&in);
 
@@ -304,5 +378,5 @@ const AVFilter ff_vf_boxblur = {
     FILTER_INPUTS(avfilter_vf_boxblur_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_QUERY_FUNC(query_formats),
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -24,6 +24,7 @@
  */
 
 #include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "libavutil/motion_vector.h"
@@ -34,6 +35,8 @@
 #include "video.h"
 #include "edge_common.h"
 
+#define COL_BLOCK 16
+
 typedef struct CropDetectContext {
     const AVClass *class;
     int x1, y1, x2, y2;
@@ -56,6 +59,10 @@ typedef struct CropDetectContext {
     uint16_t *gradients;
     char     *directions;
     int      *bboxes[4];
+    int sparse;
+    int limit_int;
+    int col_start, col_count;
+    int col_totals[COL_BLOCK];
 } CropDetectContext;
 
 static const enum AVPixelFormat pix_fmts[] = {
@@ -94,6 +101,11 @@ static int checkline(void *ctx, const unsigned char *src, int stride, int len, i
 
     switch (bpp) {
     case 1:
+        if (stride == 1) {
+            for (int i = 0; i < len; i++)
+                total += src[i];
+            break;
+        }
         while (len >= 8) {
             total += src[       0] + src[  stride] + src[2*stride] + src[3*stride]
                   +  src[4*stride] + src[5*stride] + src[6*stride] + src[7*stride];
@@ -107,6 +119,11 @@ static int checkline(void *ctx, const unsigned char *src, int stride, int len, i
         break;
     case 2:
         stride >>= 1;
+        if (stride == 1) {
+            for (int i = 0; i < len; i++)
+                total += src16[i];
+            break;
+        }
         while (len >= 8) {
             total += src16[       0] + src16[  stride] + src16[2*stride] + src16[3*stride]
                   +  src16[4*stride] + src16[5*stride] + src16[6*stride] + src16[7*stride];
@@ -141,6 +158,132 @@ static int checkline(void *ctx, const unsigned char *src, int stride, int len, i
     return total;
 }
 
+/**
+ * Compute the checkline() totals of the columns [x0, x0 + nb) in one pass
+ * over the rows, so that the accesses stay contiguous within each row.
+ */
+static void column_totals(int *totals, const uint8_t *src, ptrdiff_t linesize,
+                          int x0, int nb, int h, int bpp)
+{
+    int sum[COL_BLOCK] = { 0 };
+
+    src += x0 * bpp;
+    switch (bpp) {
+    case 1:
+        if (nb == COL_BLOCK) {
+            /* sum 8 pixels at once in 16-bit lanes, even and odd
+             * columns separately, flushing before a lane can overflow */
+            const uint64_t mask = 0x00FF00FF00FF00FFULL;
+            for (int y = 0; y < h;) {
+                const int end = FFMIN(h, y + 257);
+                uint64_t acc[4] = { 0 };
+
+                for (; y < end; y++, src += linesize) {
+                    const uint64_t a = AV_RL64(src), b = AV_RL64(src + 8);
+                    acc[0] +=  a       & mask;
+                    acc[1] += (a >> 8) & mask;
+                    acc[2] +=  b       & mask;
+                    acc[3] += (b >> 8) & mask;
+                }
+                for (int i = 0; i < 4; i++) {
+                    sum[2 * i     ] += (acc[0] >> (16 * i)) & 0xFFFF;
+                    sum[2 * i +  1] += (acc[1] >> (16 * i)) & 0xFFFF;
+                    sum[2 * i +  8] += (acc[2] >> (16 * i)) & 0xFFFF;
+                    sum[2 * i +  9] += (acc[3] >> (16 * i)) & 0xFFFF;
+                }
+            }
+            break;
+        }
+        for (int y = 0; y < h; y++, src += linesize)
+            for (int i = 0; i < nb; i++)
+                sum[i] += src[i];
+        break;
+    case 2:
+        for (int y = 0; y < h; y++, src += linesize) {
+            const uint16_t *src16 = (const uint16_t *)src;
+            for (int i = 0; i < nb; i++)
+                sum[i] += src16[i];
+        }
+        break;
+    case 3:
+    case 4:
+        for (int y = 0; y < h; y++, src += linesize)
+            for (int i = 0; i < nb; i++)
+                sum[i] += src[i * bpp] + src[i * bpp + 1] + src[i * bpp + 2];
+        h *= 3;
+        break;
+    }
+
+    for (int i = 0; i < nb; i++)
+        totals[i] = sum[i] / h;
+}
+
+static int line_total(AVFilterContext *ctx, const AVFrame *frame,
+                      int col, int idx, int dense)
+{
+    CropDetectContext *s = ctx->priv;
+    const int bpp = s->max_pixsteps[0];
+
+    if (!col)
+        return checkline(ctx, frame->data[0] + frame->linesize[0] * idx,
+                         bpp, frame->width, bpp);
+    if (!dense)
+        return checkline(ctx, frame->data[0] + bpp * idx,
+                         frame->linesize[0], frame->height, bpp);
+
+    if (idx < s->col_start || idx >= s->col_start + s->col_count) {
+        s->col_start = idx & ~(COL_BLOCK - 1);
+        s->col_count = FFMIN(COL_BLOCK, frame->width - s->col_start);
+        column_totals(s->col_totals, frame->data[0], frame->linesize[0],
+                      s->col_start, s->col_count, frame->height, bpp);
+    }
+
+    return s->col_totals[idx - s->col_start];
+}
+
+/**
+ * Scan lines from 'from' towards 'end' (exclusive) and return the position
+ * of the first non-black line, allowing for max_outliers stray lines.
+ */
+static int find_black(AVFilterContext *ctx, const AVFrame *frame,
+                      int col, int from, int end, int inc, int dst)
+{
+    CropDetectContext *s = ctx->priv;
+    int outliers = 0, last = from;
+
+    for (int y = from; inc > 0 ? y < end : y > end; y += inc) {
+        if (line_total(ctx, frame, col, y, 1) > s->limit_int) {
+            if (++outliers > s->max_outliers)
+                return last;
+        } else
+            last = y + inc;
+    }
+
+    return dst;
+}
+
+/**
+ * Sparse variant of find_black(): sample every s->sparse-th line first and
+ * only scan densely from the last black sample on. The bounds only grow
+ * between resets, so in steady state this touches end/sparse + sparse lines.
+ */
+static int find_black_sparse(AVFilterContext *ctx, const AVFrame *frame,
+                             int col, int from, int end, int inc, int dst)
+{
+    CropDetectContext *s = ctx->priv;
+    int start = from;
+
+    if (s->sparse > 1) {
+        for (int y = from; inc > 0 ? y < end : y > end; y += inc * s->sparse) {
+            if (line_total(ctx, frame, col, y, 0) > s->limit_int)
+                break;
+            start = y + inc;
+        }
+    }
+
+    return find_black(ctx, frame, col, start, end, inc, dst);
+}
+
 static int checkline_edge(void *ctx, const unsigned char *src, int stride, int len, int bpp)
 {
     const uint16_t *src16 = (const uint16_t *)src;
@@ -247,7 +390,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
     int bpp = s->max_pixsteps[0];
     int w, h, x, y, shrink_by, i;
     AVDictionary **metadata;
-    int outliers, last_y;
+    int last_y;
     int limit_upscaled = lrint(s->limit_upscaled);
     char limit_str[22];
 
@@ -281,23 +424,13 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
             s->frame_nb = 1;
         }
 
-#define FIND(DST, FROM, NOEND, INC, STEP0, STEP1, LEN) \
-        outliers = 0;\
-        for (last_y = y = FROM; NOEND; y = y INC) {\
-            if (checkline(ctx, frame->data[0] + STEP0 * y, STEP1, LEN, bpp) > limit_upscaled) {\
-                if (++outliers > s->max_outliers) { \
-                    DST = last_y;\
-                    break;\
-                }\
-            } else\
-                last_y = y INC;\
-        }
-
         if (s->mode == MODE_BLACK) {
-            FIND(s->y1,                 0,               y < s->y1, +1, frame->linesize[0], bpp, frame->width);
-            FIND(s->y2, frame->height - 1, y > FFMAX(s->y2, s->y1), -1, frame->linesize[0], bpp, frame->width);
-            FIND(s->x1,                 0,               y < s->x1, +1, bpp, frame->linesize[0], frame->height);
-            FIND(s->x2,  frame->width - 1, y > FFMAX(s->x2, s->x1), -1, bpp, frame->linesize[0], frame->height);
+            s->limit_int = limit_upscaled;
+            s->col_start = s->col_count = 0;
+            s->y1 = find_black_sparse(ctx, frame, 0, 0, s->y1, +1, s->y1);
+            s->y2 = find_black_sparse(ctx, frame, 0, frame->height - 1, FFMAX(s->y2, s->y1), -1, s->y2);
+            s->x1 = find_black_sparse(ctx, frame, 1, 0, s->x1, +1, s->x1);
+            s->x2 = find_black_sparse(ctx, frame, 1, frame->width - 1, FFMAX(s->x2, s->x1), -1, s->x2);
         } else { // MODE_MV_EDGES
             sd = av_frame_get_side_data(frame, AV_FRAME_DATA_MOTION_VECTORS);
             s->x1 = 0;
@@ -480,6 +613,7 @@ static const AVOption cropdetect_options[] = {
     { "high", "Set high threshold for edge detection",                OFFSET(high),        AV_OPT_TYPE_FLOAT, {.dbl=25/255.}, 0, 1, FLAGS },
     { "low", "Set low threshold for edge detection",                  OFFSET(low),         AV_OPT_TYPE_FLOAT, {.dbl=15/255.}, 0, 1, FLAGS },
     { "mv_threshold", "motion vector threshold when estimating video window size", OFFSET(mv_threshold), AV_OPT_TYPE_INT, {.i64=8}, 0, 100, FLAGS},
+    { "sparse", "set line step of the coarse scan, 0 scans every line", OFFSET(sparse), AV_OPT_TYPE_INT, {.i64=0}, 0, 1024, FLAGS},
     { NULL }
 };
 
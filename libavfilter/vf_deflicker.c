@@ -56,7 +56,8 @@ typedef struct DeflickerContext {
     int planewidth[4];
     int planeheight[4];
 
-    uint64_t *histogram;
+    int nb_threads;
+    uint64_t *sums;
     float luminance[SIZE];
     float sorted[SIZE];
 
@@ -64,9 +65,8 @@ typedef struct DeflickerContext {
     int available;
 
     void (*get_factor)(AVFilterContext *ctx, float *f);
-    float (*calc_avgy)(AVFilterContext *ctx, AVFrame *in);
-    int (*deflicker)(AVFilterContext *ctx, const uint8_t *src, ptrdiff_t src_linesize,
-                     uint8_t *dst, ptrdiff_t dst_linesize, int w, int h, float f);
+    int (*sum_luma)(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
+    int (*deflicker)(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
 } DeflickerContext;
 
 #define OFFSET(x) offsetof(DeflickerContext, x)
@@ -113,15 +113,27 @@ static const enum AVPixelFormat pixel_fmts[] = {
     AV_PIX_FMT_NONE
 };
 
-static int deflicker8(AVFilterContext *ctx,
-                      const uint8_t *src, ptrdiff_t src_linesize,
-                      uint8_t *dst, ptrdiff_t dst_linesize,
-                      int w, int h, float f)
-{
-    int x, y;
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    float f;
+} ThreadData;
 
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
+static int deflicker8(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DeflickerContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int w = s->planewidth[0];
+    const int h = s->planeheight[0];
+    const int slice_start = (h * jobnr) / nb_jobs;
+    const int slice_end = (h * (jobnr+1)) / nb_jobs;
+    const ptrdiff_t src_linesize = td->in->linesize[0];
+    const ptrdiff_t dst_linesize = td->out->linesize[0];
+    const uint8_t *src = td->in->data[0] + slice_start * src_linesize;
+    uint8_t *dst = td->out->data[0] + slice_start * dst_linesize;
+    const float f = td->f;
+
+    for (int y = slice_start; y < slice_end; y++) {
+        for (int x = 0; x < w; x++) {
             dst[x] = av_clip_uint8(src[x] * f);
         }
 
@@ -132,71 +144,94 @@ static int deflicker8(AVFilterContext *ctx,
     return 0;
 }
 
-static int deflicker16(AVFilterContext *ctx,
-                       const uint8_t *ssrc, ptrdiff_t src_linesize,
-                       uint8_t *ddst, ptrdiff_t dst_linesize,
-                       int w, int h, float f)
+static int deflicker16(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     DeflickerContext *s = ctx->priv;
-    const uint16_t *src = (const uint16_t *)ssrc;
-    uint16_t *dst = (uint16_t *)ddst;
+    ThreadData *td = arg;
+    const int w = s->planewidth[0];
+    const int h = s->planeheight[0];
+    const int slice_start = (h * jobnr) / nb_jobs;
+    const int slice_end = (h * (jobnr+1)) / nb_jobs;
+    const ptrdiff_t src_linesize = td->in->linesize[0] / 2;
+    const ptrdiff_t dst_linesize = td->out->linesize[0] / 2;
+    const uint16_t *src = (const uint16_t *)td->in->data[0] + slice_start * src_linesize;
+    uint16_t *dst = (uint16_t *)td->out->data[0] + slice_start * dst_linesize;
     const int max = (1 << s->depth) - 1;
-    int x, y;
+    const float f = td->f;
 
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
+    for (int y = slice_start; y < slice_end; y++) {
+        for (int x = 0; x < w; x++) {
             dst[x] = av_clip(src[x] * f, 0, max);
         }
 
-        dst += dst_linesize / 2;
-        src += src_linesize / 2;
+        dst += dst_linesize;
+        src += src_linesize;
     }
 
     return 0;
 }
 
-static float calc_avgy8(AVFilterContext *ctx, AVFrame *in)
+static int sum_luma8(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     DeflickerContext *s = ctx->priv;
-    const uint8_t *src = in->data[0];
-    int64_t sum = 0;
-    int y, x;
-
-    memset(s->histogram, 0, (1 << s->depth) * sizeof(*s->histogram));
-
-    for (y = 0; y < s->planeheight[0]; y++) {
-        for (x = 0; x < s->planewidth[0]; x++) {
-            s->histogram[src[x]]++;
-        }
+    AVFrame *in = arg;
+    const int w = s->planewidth[0];
+    const int h = s->planeheight[0];
+    const int slice_start = (h * jobnr) / nb_jobs;
+    const int slice_end = (h * (jobnr+1)) / nb_jobs;
+    const uint8_t *src = in->data[0] + slice_start * in->linesize[0];
+    uint64_t sum = 0;
+
+    for (int y = slice_start; y < slice_end; y++) {
+        uint64_t line_sum = 0;
+
+        for (int x = 0; x < w; x++)
+            line_sum += src[x];
+        sum += line_sum;
         src += in->linesize[0];
     }
 
-    for (y = 0; y < 1 << s->depth; y++) {
-        sum += s->histogram[y] * y;
+    s->sums[jobnr] = sum;
+
+    return 0;
+}
+
+static int sum_luma16(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DeflickerContext *s = ctx->priv;
+    AVFrame *in = arg;
+    const int w = s->planewidth[0];
+    const int h = s->planeheight[0];
+    const int slice_start = (h * jobnr) / nb_jobs;
+    const int slice_end = (h * (jobnr+1)) / nb_jobs;
+    const ptrdiff_t linesize = in->linesize[0] / 2;
+    const uint16_t *src = (const uint16_t *)in->data[0] + slice_start * linesize;
+    uint64_t sum = 0;
+
+    for (int y = slice_start; y < slice_end; y++) {
+        uint64_t line_sum = 0;
+
+        for (int x = 0; x < w; x++)
+            line_sum += src[x];
+        sum += line_sum;
+        src += linesize;
     }
 
-    return 1.0f * sum / (s->planeheight[0] * s->planewidth[0]);
+    s->sums[jobnr] = sum;
+
+    return 0;
 }
 
-static float calc_avgy16(AVFilterContext *ctx, AVFrame *in)
+static float calc_avgy(AVFilterContext *ctx, AVFrame *in)
 {
     DeflickerContext *s = ctx->priv;
-    const uint16_t *src = (const uint16_t *)in->data[0];
+    const int nb_jobs = FFMIN(s->planeheight[0], s->nb_threads);
     int64_t sum = 0;
-    int y, x;
-
-    memset(s->histogram, 0, (1 << s->depth) * sizeof(*s->histogram));
 
-    for (y = 0; y < s->planeheight[0]; y++) {
-        for (x = 0; x < s->planewidth[0]; x++) {
-            s->histogram[src[x]]++;
-        }
-        src += in->linesize[0] / 2;
-    }
+    ff_filter_execute(ctx, s->sum_luma, in, NULL, nb_jobs);
 
-    for (y = 0; y < 1 << s->depth; y++) {
-        sum += s->histogram[y] * y;
-    }
+    for (int i = 0; i < nb_jobs; i++)
+        sum += s->sums[i];
 
     return 1.0f * sum / (s->planeheight[0] * s->planewidth[0]);
 }
@@ -326,14 +361,15 @@ static int config_input(AVFilterLink *inlink)
     s->depth = desc->comp[0].depth;
     if (s->depth == 8) {
         s->deflicker = deflicker8;
-        s->calc_avgy = calc_avgy8;
+        s->sum_luma  = sum_luma8;
     } else {
         s->deflicker = deflicker16;
-        s->calc_avgy = calc_avgy16;
+        s->sum_luma  = sum_luma16;
     }
 
-    s->histogram = av_calloc(1 << s->depth, sizeof(*s->histogram));
-    if (!s->histogram)
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    s->sums = av_calloc(s->nb_threads, sizeof(*s->sums));
+    if (!s->sums)
         return AVERROR(ENOMEM);
 
     switch (s->mode) {
@@ -360,7 +396,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
     int y;
 
     if (s->q.available < s->size && !s->eof) {
-        s->luminance[s->available] = s->calc_avgy(ctx, buf);
+        s->luminance[s->available] = calc_avgy(ctx, buf);
         ff_bufqueue_add(ctx, &s->q, buf);
         s->available++;
         return 0;
@@ -375,9 +411,15 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
     }
 
     s->get_factor(ctx, &f);
-    if (!s->bypass)
-        s->deflicker(ctx, in->data[0], in->linesize[0], out->data[0], out->linesize[0],
-                     outlink->w, outlink->h, f);
+    if (!s->bypass) {
+        ThreadData td;
+
+        td.in = in;
+        td.out = out;
+        td.f = f;
+        ff_filter_execute(ctx, s->deflicker, &td, NULL,
+                          FFMIN(s->planeheight[0], s->nb_threads));
+    }
     for (y = 1 - s->bypass; y < s->nb_planes; y++) {
         av_image_copy_plane(out->data[y], out->linesize[y],
                             in->data[y], in->linesize[y],
@@ -402,7 +444,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
     in = ff_bufqueue_get(&s->q);
     av_frame_free(&in);
     memmove(&s->luminance[0], &s->luminance[1], sizeof(*s->luminance) * (s->size - 1));
-    s->luminance[s->available - 1] = s->calc_avgy(ctx, buf);
+    s->luminance[s->available - 1] = calc_avgy(ctx, buf);
     ff_bufqueue_add(ctx, &s->q, buf);
 
     return ff_filter_frame(outlink, out);
@@ -436,7 +478,7 @@ static av_cold void uninit(AVFilterContext *ctx)
     DeflickerContext *s = ctx->priv;
 
     ff_bufqueue_discard_all(&s->q);
-    av_freep(&s->histogram);
+    av_freep(&s->sums);
 }
 
 static const AVFilterPad inputs[] = {
@@ -465,4 +507,5 @@ const AVFilter ff_vf_deflicker = {
     FILTER_INPUTS(inputs),
     FILTER_OUTPUTS(outputs),
     FILTER_PIXFMTS_ARRAY(pixel_fmts),
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
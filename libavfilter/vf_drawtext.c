@@ -211,6 +211,8 @@ typedef struct TextLine {
     HarfbuzzData hb_data;           ///< libharfbuzz data of this text line
     GlyphInfo* glyphs;              ///< array of glyphs in this text line
     int cluster_offset;             ///< the offset at which this line begins
+    char *text;                     ///< the shaped text of this line
+    int text_len;                   ///< the length of the shaped text in bytes
 } TextLine;
 
 /** A glyph as loaded and rendered using libfreetype */
@@ -327,6 +329,7 @@ typedef struct DrawTextContext {
 
     TextLine *lines;                ///< computed information about text lines
     int line_count;                 ///< the number of text lines
+    unsigned int lines_fontsize;    ///< the font size the lines were shaped with
     uint32_t *tab_clusters;         ///< the position of tab characters in the text
     int tab_count;                  ///< the number of tab characters
     int blank_advance64;            ///< the size of the space character
@@ -1032,6 +1035,28 @@ static int glyph_enu_free(void *opaque, void *elem)
     return 0;
 }
 
+static void hb_destroy(HarfbuzzData *hb)
+{
+    hb_buffer_destroy(hb->buf);
+    hb_font_destroy(hb->font);
+    hb->buf = NULL;
+    hb->font = NULL;
+    hb->glyph_info = NULL;
+    hb->glyph_pos = NULL;
+}
+
+static void free_lines(TextLine **lines, int line_count)
+{
+    for (int l = 0; l < line_count; ++l) {
+        TextLine *line = &(*lines)[l];
+        av_freep(&line->glyphs);
+        av_freep(&line->text);
+        if (line->hb_data.buf)
+            hb_destroy(&line->hb_data);
+    }
+    av_freep(lines);
+}
+
 static av_cold void uninit(AVFilterContext *ctx)
 {
     DrawTextContext *s = ctx->priv;
@@ -1047,6 +1072,10 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_tree_destroy(s->glyphs);
     s->glyphs = NULL;
 
+    free_lines(&s->lines, s->line_count);
+    s->line_count = 0;
+    av_freep(&s->tab_clusters);
+
     FT_Done_Face(s->face);
     FT_Stroker_Done(s->stroker);
     FT_Done_FreeType(s->library);
@@ -1543,7 +1572,8 @@ static void update_alpha(DrawTextContext *s)
         s->alpha = 256 * alpha;
 }
 
-static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
+static int draw_glyphs(DrawTextContext *s, uint8_t *data[4], int linesize[4],
+                       int width, int height,
                        FFDrawColor *color,
                        TextMetrics *metrics,
                        int x, int y, int borderw)
@@ -1569,13 +1599,8 @@ static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
         offset_y = s->box_height - metrics->height;
     }
 
-    if ((!j_left || j_right) && !s->tab_warning_printed && s->tab_count > 0) {
-        s->tab_warning_printed = 1;
-        av_log(s, AV_LOG_WARNING, "Tab characters are only supported with left horizontal alignment\n");
-    }
-
-    clip_x = FFMIN(metrics->rect_x + s->box_width + s->bb_right, frame->width);
-    clip_y = FFMIN(metrics->rect_y + s->box_height + s->bb_bottom, frame->height);
+    clip_x = FFMIN(metrics->rect_x + s->box_width + s->bb_right, width);
+    clip_y = FFMIN(metrics->rect_y + s->box_height + s->bb_bottom, height);
 
     for (l = 0; l < s->line_count; ++l) {
         TextLine *line = &s->lines[l];
@@ -1623,7 +1648,7 @@ static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
             w1 = FFMIN(clip_x - x1, w1 - dx);
             h1 = FFMIN(clip_y - y1, h1 - dy);
 
-            ff_blend_mask(&s->dc, color, frame->data, frame->linesize, clip_x, clip_y,
+            ff_blend_mask(&s->dc, color, data, linesize, clip_x, clip_y,
                 bitmap.buffer + pdx, bitmap.pitch, w1, h1, 3, 0, x1, y1);
         }
     }
@@ -1655,16 +1680,6 @@ static int shape_text_hb(DrawTextContext *s, HarfbuzzData* hb, const char* text,
     return 0;
 }
 
-static void hb_destroy(HarfbuzzData *hb)
-{
-    hb_buffer_destroy(hb->buf);
-    hb_font_destroy(hb->font);
-    hb->buf = NULL;
-    hb->font = NULL;
-    hb->glyph_info = NULL;
-    hb->glyph_pos = NULL;
-}
-
 static int measure_text(AVFilterContext *ctx, TextMetrics *metrics)
 {
     DrawTextContext *s = ctx->priv;
@@ -1682,6 +1697,13 @@ static int measure_text(AVFilterContext *ctx, TextMetrics *metrics)
     int i, tab_idx = 0, last_tab_idx = 0, line_offset = 0;
     char* p;
     int ret = 0;
+    /* lines shaped for the previous frame, reused if their text is unchanged */
+    TextLine *prev_lines = s->lines;
+    int prev_nb_lines = s->line_count;
+    int prev_line_count = s->lines_fontsize == s->fontsize ? prev_nb_lines : 0;
+
+    s->lines = NULL;
+    s->line_count = 0;
 
     // Count the lines and the tab characters
     s->tab_count = 0;
@@ -1709,9 +1731,16 @@ continue_on_failed:
         hb_destroy(&hb_data);
     }
 
+    av_freep(&s->tab_clusters);
     s->line_count = line_count;
-    s->lines = av_mallocz(line_count * sizeof(TextLine));
+    s->lines_fontsize = s->fontsize;
+    s->lines = av_calloc(line_count, sizeof(TextLine));
     s->tab_clusters = av_mallocz(s->tab_count * sizeof(uint32_t));
+    if (!s->lines || (s->tab_count && !s->tab_clusters)) {
+        s->line_count = 0;
+        ret = AVERROR(ENOMEM);
+        goto done;
+    }
     for (i = 0; i < s->tab_count; ++i) {
         s->tab_clusters[i] = -1;
     }
@@ -1731,11 +1760,27 @@ continue_on_failed:
 continue_on_failed2:
         if (is_newline(code) || code == 0) {
             TextLine *cur_line = &s->lines[line_count];
+            TextLine *prev_line = line_count < prev_line_count ? &prev_lines[line_count] : NULL;
             HarfbuzzData *hb = &cur_line->hb_data;
             cur_line->cluster_offset = line_offset;
-            ret = shape_text_hb(s, hb, start, num_chars);
-            if (ret != 0) {
-                goto done;
+            if (prev_line && prev_line->hb_data.buf &&
+                prev_line->text_len == num_chars &&
+                !memcmp(prev_line->text, start, num_chars)) {
+                /* same text run and font size as in the previous frame */
+                FFSWAP(HarfbuzzData, *hb, prev_line->hb_data);
+                FFSWAP(char *, cur_line->text, prev_line->text);
+                cur_line->text_len = num_chars;
+            } else {
+                ret = shape_text_hb(s, hb, start, num_chars);
+                if (ret != 0) {
+                    goto done;
+                }
+                cur_line->text = av_memdup(start, num_chars);
+                if (!cur_line->text && num_chars) {
+                    ret = AVERROR(ENOMEM);
+                    goto done;
+                }
+                cur_line->text_len = num_chars;
             }
             w64 = 0;
             cur_min_y64 = 32000;
@@ -1821,10 +1866,79 @@ continue_on_failed2:
     metrics->max_y64 = max_y64;
 
 done:
+    free_lines(&prev_lines, prev_nb_lines);
     av_free(textdup);
     return ret;
 }
 
+typedef struct ThreadData {
+    AVFrame *frame;
+    TextMetrics *metrics;
+    FFDrawColor *fontcolor;
+    FFDrawColor *shadowcolor;
+    FFDrawColor *bordercolor;
+    FFDrawColor *boxcolor;
+    int y_start, y_end;             ///< rows covered by the text box and effects
+} ThreadData;
+
+/**
+ * Blend the box, shadow, border and text into a horizontal band of the
+ * frame. Bands start on chroma row boundaries, so the partial chroma
+ * handling of the blending functions gives the same result as drawing
+ * in one go.
+ */
+static int draw_text_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DrawTextContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *frame = td->frame;
+    TextMetrics metrics = *td->metrics;
+    const int align = 1 << s->dc.vsub_max;
+    const int rows  = td->y_end - td->y_start;
+    const int start = td->y_start + ((rows *  jobnr     ) / nb_jobs & ~(align - 1));
+    const int end   = jobnr == nb_jobs - 1 ? td->y_end :
+                      td->y_start + ((rows * (jobnr + 1)) / nb_jobs & ~(align - 1));
+    const int width = frame->width, height = end - start;
+    uint8_t *data[4] = { NULL };
+    int ret;
+
+    if (height <= 0)
+        return 0;
+
+    for (int p = 0; p < s->dc.nb_planes; p++)
+        data[p] = frame->data[p] + (start >> s->dc.vsub[p]) * frame->linesize[p];
+
+    /* draw in coordinates relative to the band */
+    metrics.rect_y -= start;
+
+    if (s->draw_box) {
+        ff_blend_rectangle(&s->dc, td->boxcolor,
+            data, frame->linesize, width, height,
+            metrics.rect_x - s->bb_left, metrics.rect_y - s->bb_top,
+            s->box_width + s->bb_right + s->bb_left,
+            s->box_height + s->bb_bottom + s->bb_top);
+    }
+
+    if (s->shadowx || s->shadowy) {
+        if ((ret = draw_glyphs(s, data, frame->linesize, width, height,
+                td->shadowcolor, &metrics,
+                s->shadowx, s->shadowy - start, s->borderw)) < 0) {
+            return ret;
+        }
+    }
+
+    if (s->borderw) {
+        if ((ret = draw_glyphs(s, data, frame->linesize, width, height,
+                td->bordercolor, &metrics,
+                0, -start, s->borderw)) < 0) {
+            return ret;
+        }
+    }
+
+    return draw_glyphs(s, data, frame->linesize, width, height,
+                       td->fontcolor, &metrics, 0, -start, 0);
+}
+
 static int draw_text(AVFilterContext *ctx, AVFrame *frame)
 {
     DrawTextContext *s = ctx->priv;
@@ -1845,7 +1959,6 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame)
 
     int width = frame->width;
     int height = frame->height;
-    int rec_x = 0, rec_y = 0, rec_width = 0, rec_height = 0;
     int is_outside = 0;
     int last_tab_idx = 0;
 
@@ -2059,44 +2172,32 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame)
                     metrics.rect_y + s->box_height + s->bb_bottom <= 0;
 
     if (!is_outside) {
-        /* draw box */
-        if (s->draw_box) {
-            rec_x = metrics.rect_x - s->bb_left;
-            rec_y = metrics.rect_y - s->bb_top;
-            rec_width = s->box_width + s->bb_right + s->bb_left;
-            rec_height = s->box_height + s->bb_bottom + s->bb_top;
-            ff_blend_rectangle(&s->dc, &boxcolor,
-                frame->data, frame->linesize, width, height,
-                rec_x, rec_y, rec_width, rec_height);
-        }
-
-        if (s->shadowx || s->shadowy) {
-            if ((ret = draw_glyphs(s, frame, &shadowcolor, &metrics,
-                    s->shadowx, s->shadowy, s->borderw)) < 0) {
-                return ret;
-            }
-        }
-
-        if (s->borderw) {
-            if ((ret = draw_glyphs(s, frame, &bordercolor, &metrics,
-                    0, 0, s->borderw)) < 0) {
-                return ret;
-            }
-        }
+        ThreadData td;
+        int j_left  = !!(s->text_align & TA_LEFT);
+        int j_right = !!(s->text_align & TA_RIGHT);
 
-        if ((ret = draw_glyphs(s, frame, &fontcolor, &metrics, 0,
-                0, 0)) < 0) {
-            return ret;
+        if ((!j_left || j_right) && !s->tab_warning_printed && s->tab_count > 0) {
+            s->tab_warning_printed = 1;
+            av_log(s, AV_LOG_WARNING, "Tab characters are only supported with left horizontal alignment\n");
         }
-    }
 
-    // FREE data structures
-    for (int l = 0; l < s->line_count; ++l) {
-        TextLine *line = &s->lines[l];
-        av_freep(&line->glyphs);
-        hb_destroy(&line->hb_data);
-    }
-    av_freep(&s->lines);
+        td.frame       = frame;
+        td.metrics     = &metrics;
+        td.fontcolor   = &fontcolor;
+        td.shadowcolor = &shadowcolor;
+        td.bordercolor = &bordercolor;
+        td.boxcolor    = &boxcolor;
+        td.y_start     = FFMAX(metrics.rect_y - s->bb_top, 0) & ~((1 << s->dc.vsub_max) - 1);
+        td.y_end       = FFMIN(metrics.rect_y + s->box_height + s->bb_bottom, height);
+        if (td.y_end > td.y_start)
+            ff_filter_execute(ctx, draw_text_slice, &td, NULL,
+                              av_clip((td.y_end - td.y_start) >> s->dc.vsub_max,
+                                      1, ff_filter_get_nb_threads(ctx)));
+    }
+
+    // FREE data structures, the shaped lines are kept for the next frame
+    for (int l = 0; l < s->line_count; ++l)
+        av_freep(&s->lines[l].glyphs);
     av_freep(&s->tab_clusters);
 
     return 0;
@@ -2200,5 +2301,5 @@ const AVFilter ff_vf_drawtext = {
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_QUERY_FUNC(query_formats),
     .process_command = command,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -35,6 +35,18 @@
 #include "vf_eq.h"
 #include "video.h"
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    const AVPixFmtDescriptor *desc;
+} ThreadData;
+
+/* Without SIMD the integer contrast path is cheaper as a table lookup. */
+static int use_process(EQParameters *param, EQContext *eq)
+{
+    return param->gamma == 1.0 && fabs(param->contrast) < 7.9 &&
+           eq->process != process_c;
+}
+
 static void create_lut(EQParameters *param)
 {
     int i;
@@ -56,22 +68,44 @@ static void create_lut(EQParameters *param)
                 param->lut[i] = 256.0 * v;
         }
     }
+}
+
+static void update_lut(EQParameters *param, EQContext *eq)
+{
+    if (param->lut_clean &&
+        param->lut_brightness   == param->brightness &&
+        param->lut_contrast     == param->contrast   &&
+        param->lut_gamma        == param->gamma      &&
+        param->lut_gamma_weight == param->gamma_weight)
+        return;
+
+    if (param->gamma == 1.0 && fabs(param->contrast) < 7.9) {
+        uint8_t ramp[256];
+
+        for (int i = 0; i < 256; i++)
+            ramp[i] = i;
+        process_c(param, param->lut, 0, ramp, 0, 256, 1);
+    } else {
+        create_lut(param);
+    }
 
+    param->lut_brightness   = param->brightness;
+    param->lut_contrast     = param->contrast;
+    param->lut_gamma        = param->gamma;
+    param->lut_gamma_weight = param->gamma_weight;
     param->lut_clean = 1;
 }
 
 static void apply_lut(EQParameters *param, uint8_t *dst, int dst_stride,
                       const uint8_t *src, int src_stride, int w, int h)
 {
-    int x, y;
+    const uint8_t *lut = param->lut;
 
-    if (!param->lut_clean)
-        create_lut(param);
-
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            dst[y * dst_stride + x] = param->lut[src[y * src_stride + x]];
-        }
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++)
+            dst[x] = lut[src[x]];
+        dst += dst_stride;
+        src += src_stride;
     }
 }
 
@@ -79,7 +113,7 @@ static void check_values(EQParameters *param, EQContext *eq)
 {
     if (param->contrast == 1.0 && param->brightness == 0.0 && param->gamma == 1.0)
         param->adjust = NULL;
-    else if (param->gamma == 1.0 && fabs(param->contrast) < 7.9)
+    else if (use_process(param, eq))
         param->adjust = eq->process;
     else
         param->adjust = apply_lut;
@@ -89,7 +123,6 @@ static void set_contrast(EQContext *eq)
 {
     eq->contrast = av_clipf(av_expr_eval(eq->contrast_pexpr, eq->var_values, eq), -1000.0, 1000.0);
     eq->param[0].contrast = eq->contrast;
-    eq->param[0].lut_clean = 0;
     check_values(&eq->param[0], eq);
 }
 
@@ -97,7 +130,6 @@ static void set_brightness(EQContext *eq)
 {
     eq->brightness = av_clipf(av_expr_eval(eq->brightness_pexpr, eq->var_values, eq), -1.0, 1.0);
     eq->param[0].brightness = eq->brightness;
-    eq->param[0].lut_clean = 0;
     check_values(&eq->param[0], eq);
 }
 
@@ -117,7 +149,6 @@ static void set_gamma(EQContext *eq)
 
     for (i = 0; i < 3; i++) {
         eq->param[i].gamma_weight = eq->gamma_weight;
-        eq->param[i].lut_clean = 0;
         check_values(&eq->param[i], eq);
     }
 }
@@ -130,7 +161,6 @@ static void set_saturation(EQContext *eq)
 
     for (i = 1; i < 3; i++) {
         eq->param[i].contrast = eq->saturation;
-        eq->param[i].lut_clean = 0;
         check_values(&eq->param[i], eq);
     }
 }
@@ -216,11 +246,48 @@ static const enum AVPixelFormat pixel_fmts_eq[] = {
     AV_PIX_FMT_NONE
 };
 
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    EQContext *eq = ctx->priv;
+    ThreadData *td = arg;
+    const AVPixFmtDescriptor *desc = td->desc;
+    AVFrame *in = td->in;
+    AVFrame *out = td->out;
+
+    for (int i = 0; i < desc->nb_components; i++) {
+        int w = in->width;
+        int h = in->height;
+        int slice_start, slice_end;
+        const uint8_t *src;
+        uint8_t *dst;
+
+        if (i == 1 || i == 2) {
+            w = AV_CEIL_RSHIFT(w, desc->log2_chroma_w);
+            h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
+        }
+
+        slice_start = (h *  jobnr   ) / nb_jobs;
+        slice_end   = (h * (jobnr+1)) / nb_jobs;
+        src = in->data[i]  + slice_start * in->linesize[i];
+        dst = out->data[i] + slice_start * out->linesize[i];
+
+        if (i == 3 || !eq->param[i].adjust)
+            av_image_copy_plane(dst, out->linesize[i],
+                                src, in->linesize[i], w, slice_end - slice_start);
+        else
+            eq->param[i].adjust(&eq->param[i], dst, out->linesize[i],
+                                src, in->linesize[i], w, slice_end - slice_start);
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     EQContext *eq = ctx->priv;
+    ThreadData td;
     AVFrame *out;
     const AVPixFmtDescriptor *desc;
     int i;
@@ -252,23 +319,15 @@ FF_ENABLE_DEPRECATION_WARNINGS
         set_saturation(eq);
     }
 
-    for (i = 0; i < desc->nb_components; i++) {
-        int w = inlink->w;
-        int h = inlink->h;
+    for (i = 0; i < 3; i++)
+        if (eq->param[i].adjust == apply_lut)
+            update_lut(&eq->param[i], eq);
 
-        if (i == 1 || i == 2) {
-            w = AV_CEIL_RSHIFT(w, desc->log2_chroma_w);
-            h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
-        }
-
-        if (i == 3 || !eq->param[i].adjust)
-            av_image_copy_plane(out->data[i], out->linesize[i],
-                                in->data[i], in->linesize[i], w, h);
-
-        else
-            eq->param[i].adjust(&eq->param[i], out->data[i], out->linesize[i],
-                                 in->data[i], in->linesize[i], w, h);
-    }
+    td.in   = in;
+    td.out  = out;
+    td.desc = desc;
+    ff_filter_execute(ctx, filter_slice, &td, NULL,
+                      FFMIN(inlink->h, ff_filter_get_nb_threads(ctx)));
 
     av_frame_free(&in);
     return ff_filter_frame(outlink, out);
@@ -353,5 +412,5 @@ const AVFilter ff_vf_eq = {
     .process_command = process_command,
     .init            = initialize,
     .uninit          = uninit,
-    .flags           = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags           = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
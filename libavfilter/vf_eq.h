@@ -57,6 +57,9 @@ typedef struct EQParameters {
     double brightness, contrast, gamma, gamma_weight;
     int lut_clean;
 
+    /* parameters the current lut was built for */
+    double lut_brightness, lut_contrast, lut_gamma, lut_gamma_weight;
+
 } EQParameters;
 
 typedef struct EQContext {
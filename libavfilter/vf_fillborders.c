@@ -33,6 +33,8 @@ enum { R, G, B };
 
 enum FillMode { FM_SMEAR, FM_MIRROR, FM_FIXED, FM_REFLECT, FM_WRAP, FM_FADE, FM_MARGINS, FM_NB_MODES };
 
+enum FillPass { PASS_SIDES, PASS_TOP_BOTTOM };
+
 typedef struct Borders {
     int left, right, top, bottom;
 } Borders;
@@ -51,9 +53,15 @@ typedef struct FillBordersContext {
     uint8_t yuv_color[4];
     uint8_t rgba_color[4];
 
-    void (*fillborders)(struct FillBordersContext *s, AVFrame *frame);
+    void (*fillborders)(struct FillBordersContext *s, AVFrame *frame,
+                        int pass, int jobnr, int nb_jobs);
 } FillBordersContext;
 
+typedef struct ThreadData {
+    AVFrame *frame;
+    int pass;
+} ThreadData;
+
 static const enum AVPixelFormat pix_fmts[] = {
     AV_PIX_FMT_YUVA444P, AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV440P,
     AV_PIX_FMT_YUVJ444P, AV_PIX_FMT_YUVJ440P,
@@ -76,320 +84,399 @@ static const enum AVPixelFormat pix_fmts[] = {
     AV_PIX_FMT_NONE
 };
 
-static void smear_borders8(FillBordersContext *s, AVFrame *frame)
+/* left/right borders of the rows between the top and bottom borders */
+static void rows_slice(const FillBordersContext *s, int p, int jobnr, int nb_jobs,
+                       int *start, int *end)
+{
+    const int top    = s->borders[p].top;
+    const int height = s->planeheight[p] - s->borders[p].bottom - top;
+
+    *start = top + (height *  jobnr   ) / nb_jobs;
+    *end   = top + (height * (jobnr+1)) / nb_jobs;
+}
+
+/* top/bottom borders are split by columns, which keeps their row order */
+static void cols_slice(const FillBordersContext *s, int p, int jobnr, int nb_jobs,
+                       int *start, int *end)
+{
+    *start = (s->planewidth[p] *  jobnr   ) / nb_jobs;
+    *end   = (s->planewidth[p] * (jobnr+1)) / nb_jobs;
+}
+
+static void smear_borders8(FillBordersContext *s, AVFrame *frame,
+                           int pass, int jobnr, int nb_jobs)
 {
-    int p, y;
+    int p, y, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint8_t *ptr = frame->data[p];
         ptrdiff_t linesize = frame->linesize[p];
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            memset(ptr + y * linesize,
-                   *(ptr + y * linesize + s->borders[p].left),
-                   s->borders[p].left);
-            memset(ptr + y * linesize + s->planewidth[p] - s->borders[p].right,
-                   *(ptr + y * linesize + s->planewidth[p] - s->borders[p].right - 1),
-                   s->borders[p].right);
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                memset(ptr + y * linesize,
+                       *(ptr + y * linesize + s->borders[p].left),
+                       s->borders[p].left);
+                memset(ptr + y * linesize + s->planewidth[p] - s->borders[p].right,
+                       *(ptr + y * linesize + s->planewidth[p] - s->borders[p].right - 1),
+                       s->borders[p].right);
+            }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + s->borders[p].top * linesize, s->planewidth[p]);
+            memcpy(ptr + y * linesize + start,
+                   ptr + s->borders[p].top * linesize + start, end - start);
         }
 
         for (y = s->planeheight[p] - s->borders[p].bottom; y < s->planeheight[p]; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + (s->planeheight[p] - s->borders[p].bottom - 1) * linesize,
-                   s->planewidth[p]);
+            memcpy(ptr + y * linesize + start,
+                   ptr + (s->planeheight[p] - s->borders[p].bottom - 1) * linesize + start,
+                   end - start);
         }
     }
 }
 
-static void smear_borders16(FillBordersContext *s, AVFrame *frame)
+static void smear_borders16(FillBordersContext *s, AVFrame *frame,
+                            int pass, int jobnr, int nb_jobs)
 {
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint16_t *ptr = (uint16_t *)frame->data[p];
         ptrdiff_t linesize = frame->linesize[p] / 2;
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            for (x = 0; x < s->borders[p].left; x++) {
-                ptr[y * linesize + x] =  *(ptr + y * linesize + s->borders[p].left);
-            }
-
-            for (x = 0; x < s->borders[p].right; x++) {
-                ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
-                   *(ptr + y * linesize + s->planewidth[p] - s->borders[p].right - 1);
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                for (x = 0; x < s->borders[p].left; x++) {
+                    ptr[y * linesize + x] =  *(ptr + y * linesize + s->borders[p].left);
+                }
+
+                for (x = 0; x < s->borders[p].right; x++) {
+                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
+                       *(ptr + y * linesize + s->planewidth[p] - s->borders[p].right - 1);
+                }
             }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + s->borders[p].top * linesize, s->planewidth[p] * 2);
+            memcpy(ptr + y * linesize + start,
+                   ptr + s->borders[p].top * linesize + start, (end - start) * 2);
         }
 
         for (y = s->planeheight[p] - s->borders[p].bottom; y < s->planeheight[p]; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + (s->planeheight[p] - s->borders[p].bottom - 1) * linesize,
-                   s->planewidth[p] * 2);
+            memcpy(ptr + y * linesize + start,
+                   ptr + (s->planeheight[p] - s->borders[p].bottom - 1) * linesize + start,
+                   (end - start) * 2);
         }
     }
 }
 
-static void mirror_borders8(FillBordersContext *s, AVFrame *frame)
+static void mirror_borders8(FillBordersContext *s, AVFrame *frame,
+                            int pass, int jobnr, int nb_jobs)
 {
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint8_t *ptr = frame->data[p];
         ptrdiff_t linesize = frame->linesize[p];
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            for (x = 0; x < s->borders[p].left; x++) {
-                ptr[y * linesize + x] = ptr[y * linesize + s->borders[p].left * 2 - 1 - x];
-            }
-
-            for (x = 0; x < s->borders[p].right; x++) {
-                ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
-                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right - 1 - x];
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                for (x = 0; x < s->borders[p].left; x++) {
+                    ptr[y * linesize + x] = ptr[y * linesize + s->borders[p].left * 2 - 1 - x];
+                }
+
+                for (x = 0; x < s->borders[p].right; x++) {
+                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
+                        ptr[y * linesize + s->planewidth[p] - s->borders[p].right - 1 - x];
+                }
             }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + (s->borders[p].top * 2 - 1 - y) * linesize,
-                   s->planewidth[p]);
+            memcpy(ptr + y * linesize + start,
+                   ptr + (s->borders[p].top * 2 - 1 - y) * linesize + start,
+                   end - start);
         }
 
         for (y = 0; y < s->borders[p].bottom; y++) {
-            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize,
-                   ptr + (s->planeheight[p] - s->borders[p].bottom - 1 - y) * linesize,
-                   s->planewidth[p]);
+            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize + start,
+                   ptr + (s->planeheight[p] - s->borders[p].bottom - 1 - y) * linesize + start,
+                   end - start);
         }
     }
 }
 
-static void mirror_borders16(FillBordersContext *s, AVFrame *frame)
+static void mirror_borders16(FillBordersContext *s, AVFrame *frame,
+                             int pass, int jobnr, int nb_jobs)
 {
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint16_t *ptr = (uint16_t *)frame->data[p];
         ptrdiff_t linesize = frame->linesize[p] / 2;
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            for (x = 0; x < s->borders[p].left; x++) {
-                ptr[y * linesize + x] = ptr[y * linesize + s->borders[p].left * 2 - 1 - x];
-            }
-
-            for (x = 0; x < s->borders[p].right; x++) {
-                ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
-                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right - 1 - x];
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                for (x = 0; x < s->borders[p].left; x++) {
+                    ptr[y * linesize + x] = ptr[y * linesize + s->borders[p].left * 2 - 1 - x];
+                }
+
+                for (x = 0; x < s->borders[p].right; x++) {
+                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
+                        ptr[y * linesize + s->planewidth[p] - s->borders[p].right - 1 - x];
+                }
             }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + (s->borders[p].top * 2 - 1 - y) * linesize,
-                   s->planewidth[p] * 2);
+            memcpy(ptr + y * linesize + start,
+                   ptr + (s->borders[p].top * 2 - 1 - y) * linesize + start,
+                   (end - start) * 2);
         }
 
         for (y = 0; y < s->borders[p].bottom; y++) {
-            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize,
-                   ptr + (s->planeheight[p] - s->borders[p].bottom - 1 - y) * linesize,
-                   s->planewidth[p] * 2);
+            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize + start,
+                   ptr + (s->planeheight[p] - s->borders[p].bottom - 1 - y) * linesize + start,
+                   (end - start) * 2);
         }
     }
 }
 
-static void fixed_borders8(FillBordersContext *s, AVFrame *frame)
+static void fixed_borders8(FillBordersContext *s, AVFrame *frame,
+                           int pass, int jobnr, int nb_jobs)
 {
-    int p, y;
+    int p, y, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint8_t *ptr = frame->data[p];
         uint8_t fill = s->fill[p];
         ptrdiff_t linesize = frame->linesize[p];
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            memset(ptr + y * linesize, fill, s->borders[p].left);
-            memset(ptr + y * linesize + s->planewidth[p] - s->borders[p].right, fill,
-                   s->borders[p].right);
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                memset(ptr + y * linesize, fill, s->borders[p].left);
+                memset(ptr + y * linesize + s->planewidth[p] - s->borders[p].right, fill,
+                       s->borders[p].right);
+            }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            memset(ptr + y * linesize, fill, s->planewidth[p]);
+            memset(ptr + y * linesize + start, fill, end - start);
         }
 
         for (y = s->planeheight[p] - s->borders[p].bottom; y < s->planeheight[p]; y++) {
-            memset(ptr + y * linesize, fill, s->planewidth[p]);
+            memset(ptr + y * linesize + start, fill, end - start);
         }
     }
 }
 
-static void fixed_borders16(FillBordersContext *s, AVFrame *frame)
+static void fixed_borders16(FillBordersContext *s, AVFrame *frame,
+                            int pass, int jobnr, int nb_jobs)
 {
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint16_t *ptr = (uint16_t *)frame->data[p];
         uint16_t fill = s->fill[p] << (s->depth - 8);
         ptrdiff_t linesize = frame->linesize[p] / 2;
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            for (x = 0; x < s->borders[p].left; x++) {
-                ptr[y * linesize + x] = fill;
-            }
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                for (x = 0; x < s->borders[p].left; x++) {
+                    ptr[y * linesize + x] = fill;
+                }
 
-            for (x = 0; x < s->borders[p].right; x++) {
-                ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] = fill;
+                for (x = 0; x < s->borders[p].right; x++) {
+                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] = fill;
+                }
             }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            for (x = 0; x < s->planewidth[p]; x++) {
+            for (x = start; x < end; x++) {
                 ptr[y * linesize + x] = fill;
             }
         }
 
         for (y = s->planeheight[p] - s->borders[p].bottom; y < s->planeheight[p]; y++) {
-            for (x = 0; x < s->planewidth[p]; x++) {
+            for (x = start; x < end; x++) {
                 ptr[y * linesize + x] = fill;
             }
         }
     }
 }
 
-static void reflect_borders8(FillBordersContext *s, AVFrame *frame)
+static void reflect_borders8(FillBordersContext *s, AVFrame *frame,
+                             int pass, int jobnr, int nb_jobs)
 {
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint8_t *ptr = frame->data[p];
         ptrdiff_t linesize = frame->linesize[p];
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            for (x = 0; x < s->borders[p].left; x++) {
-                ptr[y * linesize + x] = ptr[y * linesize + s->borders[p].left * 2 - x];
-            }
-
-            for (x = 0; x < s->borders[p].right; x++) {
-                ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
-                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right - 2 - x];
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                for (x = 0; x < s->borders[p].left; x++) {
+                    ptr[y * linesize + x] = ptr[y * linesize + s->borders[p].left * 2 - x];
+                }
+
+                for (x = 0; x < s->borders[p].right; x++) {
+                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
+                        ptr[y * linesize + s->planewidth[p] - s->borders[p].right - 2 - x];
+                }
             }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + (s->borders[p].top * 2 - y) * linesize,
-                   s->planewidth[p]);
+            memcpy(ptr + y * linesize + start,
+                   ptr + (s->borders[p].top * 2 - y) * linesize + start,
+                   end - start);
         }
 
         for (y = 0; y < s->borders[p].bottom; y++) {
-            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize,
-                   ptr + (s->planeheight[p] - s->borders[p].bottom - 2 - y) * linesize,
-                   s->planewidth[p]);
+            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize + start,
+                   ptr + (s->planeheight[p] - s->borders[p].bottom - 2 - y) * linesize + start,
+                   end - start);
         }
     }
 }
 
-static void reflect_borders16(FillBordersContext *s, AVFrame *frame)
+static void reflect_borders16(FillBordersContext *s, AVFrame *frame,
+                              int pass, int jobnr, int nb_jobs)
 {
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint16_t *ptr = (uint16_t *)frame->data[p];
         ptrdiff_t linesize = frame->linesize[p] / 2;
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            for (x = 0; x < s->borders[p].left; x++) {
-                ptr[y * linesize + x] = ptr[y * linesize + s->borders[p].left * 2 - x];
-            }
-
-            for (x = 0; x < s->borders[p].right; x++) {
-                ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
-                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right - 2 - x];
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                for (x = 0; x < s->borders[p].left; x++) {
+                    ptr[y * linesize + x] = ptr[y * linesize + s->borders[p].left * 2 - x];
+                }
+
+                for (x = 0; x < s->borders[p].right; x++) {
+                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
+                        ptr[y * linesize + s->planewidth[p] - s->borders[p].right - 2 - x];
+                }
             }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + (s->borders[p].top * 2 - y) * linesize,
-                   s->planewidth[p] * 2);
+            memcpy(ptr + y * linesize + start,
+                   ptr + (s->borders[p].top * 2 - y) * linesize + start,
+                   (end - start) * 2);
         }
 
         for (y = 0; y < s->borders[p].bottom; y++) {
-            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize,
-                   ptr + (s->planeheight[p] - s->borders[p].bottom - 2 - y) * linesize,
-                   s->planewidth[p] * 2);
+            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize + start,
+                   ptr + (s->planeheight[p] - s->borders[p].bottom - 2 - y) * linesize + start,
+                   (end - start) * 2);
         }
     }
 }
 
-static void wrap_borders8(FillBordersContext *s, AVFrame *frame)
+static void wrap_borders8(FillBordersContext *s, AVFrame *frame,
+                          int pass, int jobnr, int nb_jobs)
 {
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint8_t *ptr = frame->data[p];
         ptrdiff_t linesize = frame->linesize[p];
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            for (x = 0; x < s->borders[p].left; x++) {
-                ptr[y * linesize + x] = ptr[y * linesize + s->planewidth[p] - s->borders[p].right - s->borders[p].left + x];
-            }
-
-            for (x = 0; x < s->borders[p].right; x++) {
-                ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
-                    ptr[y * linesize + s->borders[p].left + x];
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                for (x = 0; x < s->borders[p].left; x++) {
+                    ptr[y * linesize + x] = ptr[y * linesize + s->planewidth[p] - s->borders[p].right - s->borders[p].left + x];
+                }
+
+                for (x = 0; x < s->borders[p].right; x++) {
+                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
+                        ptr[y * linesize + s->borders[p].left + x];
+                }
             }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + (s->planeheight[p] - s->borders[p].bottom - s->borders[p].top + y) * linesize,
-                   s->planewidth[p]);
+            memcpy(ptr + y * linesize + start,
+                   ptr + (s->planeheight[p] - s->borders[p].bottom - s->borders[p].top + y) * linesize + start,
+                   end - start);
         }
 
         for (y = 0; y < s->borders[p].bottom; y++) {
-            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize,
-                   ptr + (s->borders[p].top + y) * linesize,
-                   s->planewidth[p]);
+            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize + start,
+                   ptr + (s->borders[p].top + y) * linesize + start,
+                   end - start);
         }
     }
 }
 
-static void wrap_borders16(FillBordersContext *s, AVFrame *frame)
+static void wrap_borders16(FillBordersContext *s, AVFrame *frame,
+                           int pass, int jobnr, int nb_jobs)
 {
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint16_t *ptr = (uint16_t *)frame->data[p];
         ptrdiff_t linesize = frame->linesize[p] / 2;
 
-        for (y = s->borders[p].top; y < s->planeheight[p] - s->borders[p].bottom; y++) {
-            for (x = 0; x < s->borders[p].left; x++) {
-                ptr[y * linesize + x] = ptr[y * linesize + s->planewidth[p] - s->borders[p].right - s->borders[p].left + x];
-            }
-
-            for (x = 0; x < s->borders[p].right; x++) {
-                ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
-                    ptr[y * linesize + s->borders[p].left + x];
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = start; y < end; y++) {
+                for (x = 0; x < s->borders[p].left; x++) {
+                    ptr[y * linesize + x] = ptr[y * linesize + s->planewidth[p] - s->borders[p].right - s->borders[p].left + x];
+                }
+
+                for (x = 0; x < s->borders[p].right; x++) {
+                    ptr[y * linesize + s->planewidth[p] - s->borders[p].right + x] =
+                        ptr[y * linesize + s->borders[p].left + x];
+                }
             }
+            continue;
         }
 
+        cols_slice(s, p, jobnr, nb_jobs, &start, &end);
         for (y = 0; y < s->borders[p].top; y++) {
-            memcpy(ptr + y * linesize,
-                   ptr + (s->planeheight[p] - s->borders[p].bottom - s->borders[p].top + y) * linesize,
-                   s->planewidth[p] * 2);
+            memcpy(ptr + y * linesize + start,
+                   ptr + (s->planeheight[p] - s->borders[p].bottom - s->borders[p].top + y) * linesize + start,
+                   (end - start) * 2);
         }
 
         for (y = 0; y < s->borders[p].bottom; y++) {
-            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize,
-                   ptr + (s->borders[p].top + y) * linesize,
-                   s->planewidth[p] * 2);
+            memcpy(ptr + (s->planeheight[p] - s->borders[p].bottom + y) * linesize + start,
+                   ptr + (s->borders[p].top + y) * linesize + start,
+                   (end - start) * 2);
         }
     }
 }
@@ -404,9 +491,12 @@ static int lerp16(int fill, int src, int pos, int size, int depth)
     return av_clip_uintp2_c(((fill * (1LL << depth) * pos / size) + (src * (1LL << depth) * (size - pos) / size)) >> depth, depth);
 }
 
-static void fade_borders8(FillBordersContext *s, AVFrame *frame)
+/* fade blends in place: the top/bottom pass runs first, then the
+ * left/right pass over the full plane height */
+static void fade_borders8(FillBordersContext *s, AVFrame *frame,
+                          int pass, int jobnr, int nb_jobs)
 {
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint8_t *ptr = frame->data[p];
@@ -417,21 +507,27 @@ static void fade_borders8(FillBordersContext *s, AVFrame *frame)
         const int start_top = s->borders[p].top;
         const int start_bottom = s->planeheight[p] - s->borders[p].bottom;
 
-        for (y = 0; y < start_top; y++) {
-            for (x = 0; x < s->planewidth[p]; x++) {
-                int src = ptr[y * linesize + x];
-                ptr[y * linesize + x] = lerp8(fill, src, start_top - y, start_top);
+        if (pass == PASS_TOP_BOTTOM) {
+            cols_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = 0; y < start_top; y++) {
+                for (x = start; x < end; x++) {
+                    int src = ptr[y * linesize + x];
+                    ptr[y * linesize + x] = lerp8(fill, src, start_top - y, start_top);
+                }
             }
-        }
 
-        for (y = start_bottom; y < s->planeheight[p]; y++) {
-            for (x = 0; x < s->planewidth[p]; x++) {
-                int src = ptr[y * linesize + x];
-                ptr[y * linesize + x] = lerp8(fill, src, y - start_bottom, s->borders[p].bottom);
+            for (y = start_bottom; y < s->planeheight[p]; y++) {
+                for (x = start; x < end; x++) {
+                    int src = ptr[y * linesize + x];
+                    ptr[y * linesize + x] = lerp8(fill, src, y - start_bottom, s->borders[p].bottom);
+                }
             }
+            continue;
         }
 
-        for (y = 0; y < s->planeheight[p]; y++) {
+        start = (s->planeheight[p] *  jobnr   ) / nb_jobs;
+        end   = (s->planeheight[p] * (jobnr+1)) / nb_jobs;
+        for (y = start; y < end; y++) {
             for (x = 0; x < start_left; x++) {
                 int src = ptr[y * linesize + x];
                 ptr[y * linesize + x] = lerp8(fill, src, start_left - x, start_left);
@@ -445,10 +541,11 @@ static void fade_borders8(FillBordersContext *s, AVFrame *frame)
     }
 }
 
-static void fade_borders16(FillBordersContext *s, AVFrame *frame)
+static void fade_borders16(FillBordersContext *s, AVFrame *frame,
+                           int pass, int jobnr, int nb_jobs)
 {
     const int depth = s->depth;
-    int p, y, x;
+    int p, y, x, start, end;
 
     for (p = 0; p < s->nb_planes; p++) {
         uint16_t *ptr = (uint16_t *)frame->data[p];
@@ -459,21 +556,27 @@ static void fade_borders16(FillBordersContext *s, AVFrame *frame)
         const int start_top = s->borders[p].top;
         const int start_bottom = s->planeheight[p] - s->borders[p].bottom;
 
-        for (y = 0; y < start_top; y++) {
-            for (x = 0; x < s->planewidth[p]; x++) {
-                int src = ptr[y * linesize + x];
-                ptr[y * linesize + x] = lerp16(fill, src, start_top - y, start_top, depth);
+        if (pass == PASS_TOP_BOTTOM) {
+            cols_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (y = 0; y < start_top; y++) {
+                for (x = start; x < end; x++) {
+                    int src = ptr[y * linesize + x];
+                    ptr[y * linesize + x] = lerp16(fill, src, start_top - y, start_top, depth);
+                }
             }
-        }
 
-        for (y = start_bottom; y < s->planeheight[p]; y++) {
-            for (x = 0; x < s->planewidth[p]; x++) {
-                int src = ptr[y * linesize + x];
-                ptr[y * linesize + x] = lerp16(fill, src, y - start_bottom, s->borders[p].bottom, depth);
+            for (y = start_bottom; y < s->planeheight[p]; y++) {
+                for (x = start; x < end; x++) {
+                    int src = ptr[y * linesize + x];
+                    ptr[y * linesize + x] = lerp16(fill, src, y - start_bottom, s->borders[p].bottom, depth);
+                }
             }
+            continue;
         }
 
-        for (y = 0; y < s->planeheight[p]; y++) {
+        start = (s->planeheight[p] *  jobnr   ) / nb_jobs;
+        end   = (s->planeheight[p] * (jobnr+1)) / nb_jobs;
+        for (y = start; y < end; y++) {
             for (x = 0; x < start_left; x++) {
                 int src = ptr[y * linesize + x];
                 ptr[y * linesize + x] = lerp16(fill, src, start_left - x, start_left, depth);
@@ -487,7 +590,10 @@ static void fade_borders16(FillBordersContext *s, AVFrame *frame)
     }
 }
 
-static void margins_borders8(FillBordersContext *s, AVFrame *frame)
+/* each margin row is filtered from its neighbour towards the frame edge,
+ * so the top/bottom pass cannot be split and runs in the first job only */
+static void margins_borders8(FillBordersContext *s, AVFrame *frame,
+                             int pass, int jobnr, int nb_jobs)
 {
     for (int p = 0; p < s->nb_planes; p++) {
         uint8_t *ptr = (uint8_t *)frame->data[p];
@@ -498,12 +604,20 @@ static void margins_borders8(FillBordersContext *s, AVFrame *frame)
         const int bottom = s->borders[p].bottom;
         const int width = s->planewidth[p];
         const int height = s->planeheight[p];
+        int start, end;
 
-        for (int y = top; y < height - bottom; y++) {
-            memset(ptr + linesize * y, ptr[linesize * y + left], left);
-            memset(ptr + linesize * y + width - right, (ptr + linesize * y + width - right)[-1], right);
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (int y = start; y < end; y++) {
+                memset(ptr + linesize * y, ptr[linesize * y + left], left);
+                memset(ptr + linesize * y + width - right, (ptr + linesize * y + width - right)[-1], right);
+            }
+            continue;
         }
 
+        if (jobnr)
+            continue;
+
         for (int y = top - 1; y >= 0; y--) {
             ptr[linesize * y] = ptr[linesize * (y + 1)];
             memcpy(ptr + linesize * y + width - 8, ptr + linesize * (y + 1) + width - 8, 8);
@@ -532,7 +646,8 @@ static void margins_borders8(FillBordersContext *s, AVFrame *frame)
     }
 }
 
-static void margins_borders16(FillBordersContext *s, AVFrame *frame)
+static void margins_borders16(FillBordersContext *s, AVFrame *frame,
+                              int pass, int jobnr, int nb_jobs)
 {
     for (int p = 0; p < s->nb_planes; p++) {
         uint16_t *ptr = (uint16_t *)frame->data[p];
@@ -543,15 +658,23 @@ static void margins_borders16(FillBordersContext *s, AVFrame *frame)
         const int bottom = s->borders[p].bottom;
         const int width = s->planewidth[p];
         const int height = s->planeheight[p];
+        int start, end;
 
-        for (int y = top; y < height - bottom; y++) {
-            for (int x = 0; x < left; x++)
-                ptr[linesize * y + x] = ptr[linesize * y + left];
+        if (pass == PASS_SIDES) {
+            rows_slice(s, p, jobnr, nb_jobs, &start, &end);
+            for (int y = start; y < end; y++) {
+                for (int x = 0; x < left; x++)
+                    ptr[linesize * y + x] = ptr[linesize * y + left];
 
-            for (int x = 0; x < right; x++)
-                ptr[linesize * y + width - right + x] = ptr[linesize * y + width - right - 1];
+                for (int x = 0; x < right; x++)
+                    ptr[linesize * y + width - right + x] = ptr[linesize * y + width - right - 1];
+            }
+            continue;
         }
 
+        if (jobnr)
+            continue;
+
         for (int y = top - 1; y >= 0; y--) {
             ptr[linesize * y] = ptr[linesize * (y + 1)];
             memcpy(ptr + linesize * y + width - 8, ptr + linesize * (y + 1) + width - 8, 16);
@@ -580,13 +703,28 @@ static void margins_borders16(FillBordersContext *s, AVFrame *frame)
     }
 }
 
+static int fill_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    FillBordersContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    s->fillborders(s, td->frame, td->pass, jobnr, nb_jobs);
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
 {
-    FillBordersContext *s = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    FillBordersContext *s = ctx->priv;
+    const int nb_jobs = FFMIN(FFMAX(inlink->w, inlink->h), ff_filter_get_nb_threads(ctx));
+    ThreadData td = { .frame = frame };
 
-    s->fillborders(s, frame);
+    td.pass = s->mode == FM_FADE ? PASS_TOP_BOTTOM : PASS_SIDES;
+    ff_filter_execute(ctx, fill_slice, &td, NULL, nb_jobs);
+    td.pass = s->mode == FM_FADE ? PASS_SIDES : PASS_TOP_BOTTOM;
+    ff_filter_execute(ctx, fill_slice, &td, NULL, nb_jobs);
 
-    return ff_filter_frame(inlink->dst->outputs[0], frame);
+    return ff_filter_frame(ctx->outputs[0], frame);
 }
 
 static int config_input(AVFilterLink *inlink)
@@ -714,6 +852,6 @@ const AVFilter ff_vf_fillborders = {
     FILTER_INPUTS(fillborders_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
     .process_command = process_command,
 };
@@ -116,21 +116,16 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_frame_free(&s->reference_frame);
 }
 
-static int is_frozen(FreezeDetectContext *s, AVFrame *reference, AVFrame *frame)
+static int is_frozen(AVFilterContext *ctx, AVFrame *reference, AVFrame *frame)
 {
-    uint64_t sad = 0;
+    FreezeDetectContext *s = ctx->priv;
+    uint64_t sad;
     uint64_t count = 0;
     double mafd;
-    for (int plane = 0; plane < 4; plane++) {
-        if (s->width[plane]) {
-            uint64_t plane_sad;
-            s->sad(frame->data[plane], frame->linesize[plane],
-                   reference->data[plane], reference->linesize[plane],
-                   s->width[plane], s->height[plane], &plane_sad);
-            sad += plane_sad;
-            count += s->width[plane] * s->height[plane];
-        }
-    }
+
+    sad = ff_scene_sad_frame(ctx, s->sad, frame, reference, 4, s->width, s->height);
+    for (int plane = 0; plane < 4; plane++)
+        count += s->width[plane] * s->height[plane];
     mafd = (double)sad / count / (1ULL << s->bitdepth);
     return (mafd <= s->noise);
 }
@@ -166,7 +161,7 @@ static int activate(AVFilterContext *ctx)
             else
                 duration = av_rescale_q(frame->pts - s->reference_frame->pts, inlink->time_base, AV_TIME_BASE_Q);
 
-            frozen = is_frozen(s, s->reference_frame, frame);
+            frozen = is_frozen(ctx, s->reference_frame, frame);
             if (duration >= s->duration) {
                 if (!s->frozen)
                     set_meta(s, frame, "lavfi.freezedetect.freeze_start", av_ts2timestr(s->reference_frame->pts, &inlink->time_base));
@@ -210,7 +205,7 @@ const AVFilter ff_vf_freezedetect = {
     .priv_size     = sizeof(FreezeDetectContext),
     .priv_class    = &freezedetect_class,
     .uninit        = uninit,
-    .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_METADATA_ONLY | AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(freezedetect_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
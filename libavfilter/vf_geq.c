@@ -37,6 +37,7 @@
 
 #define MAX_NB_THREADS 32
 #define NB_PLANES 4
+#define GEQ_BATCH 256
 
 enum InterpolationMethods {
     INTERP_NEAREST,
@@ -52,9 +53,7 @@ typedef struct GEQContext {
     AVExpr *e[NB_PLANES][MAX_NB_THREADS]; ///< expressions for each plane and thread
     char *expr_str[4+3];        ///< expression strings for each plane
     AVFrame *picref;            ///< current input buffer
-    uint8_t *dst;               ///< reference pointer to the 8bits output
-    uint16_t *dst16;            ///< reference pointer to the 16bits output
-    float *dst32;               ///< reference pointer to the 32bits output
+    uint8_t *dst;               ///< reference pointer to the output plane
     double values[VAR_VARS_NB]; ///< expression values
     int hsub, vsub;             ///< chroma subsampling
     int planes;                 ///< number of planes
@@ -402,43 +401,43 @@ static int slice_geq_filter(AVFilterContext *ctx, void *arg, int jobnr, int nb_j
     int x, y;
 
     double values[VAR_VARS_NB];
+    const double *arrays[VAR_VARS_NB] = { NULL };
+    double xs[GEQ_BATCH], res[GEQ_BATCH];
     values[VAR_W] = geq->values[VAR_W];
     values[VAR_H] = geq->values[VAR_H];
     values[VAR_N] = geq->values[VAR_N];
     values[VAR_SW] = geq->values[VAR_SW];
     values[VAR_SH] = geq->values[VAR_SH];
     values[VAR_T] = geq->values[VAR_T];
+    values[VAR_X] = 0; // read from xs[] per pixel
+    arrays[VAR_X] = xs;
 
-    if (geq->bps == 8) {
-        uint8_t *ptr = geq->dst + linesize * slice_start;
-        for (y = slice_start; y < slice_end; y++) {
-            values[VAR_Y] = y;
+    for (y = slice_start; y < slice_end; y++) {
+        uint8_t *ptr = geq->dst + linesize * y;
+        values[VAR_Y] = y;
 
-            for (x = 0; x < width; x++) {
-                values[VAR_X] = x;
-                ptr[x] = av_expr_eval(geq->e[plane][jobnr], values, geq);
-            }
-            ptr += linesize;
-        }
-    } else if (geq->bps <= 16) {
-        uint16_t *ptr16 = geq->dst16 + (linesize/2) * slice_start;
-        for (y = slice_start; y < slice_end; y++) {
-            values[VAR_Y] = y;
-            for (x = 0; x < width; x++) {
-                values[VAR_X] = x;
-                ptr16[x] = av_expr_eval(geq->e[plane][jobnr], values, geq);
-            }
-            ptr16 += linesize/2;
-        }
-    } else {
-        float *ptr32 = geq->dst32 + (linesize/4) * slice_start;
-        for (y = slice_start; y < slice_end; y++) {
-            values[VAR_Y] = y;
-            for (x = 0; x < width; x++) {
-                values[VAR_X] = x;
-                ptr32[x] = av_expr_eval(geq->e[plane][jobnr], values, geq);
+        for (x = 0; x < width; x += GEQ_BATCH) {
+            const int n = FFMIN(GEQ_BATCH, width - x);
+            int i, ret;
+
+            for (i = 0; i < n; i++)
+                xs[i] = x + i;
+            ret = av_expr_eval_batch(geq->e[plane][jobnr], res, n, values, arrays, geq);
+            if (ret < 0)
+                return ret;
+
+            if (geq->bps == 8) {
+                for (i = 0; i < n; i++)
+                    ptr[x + i] = res[i];
+            } else if (geq->bps <= 16) {
+                uint16_t *ptr16 = (uint16_t *)ptr;
+                for (i = 0; i < n; i++)
+                    ptr16[x + i] = res[i];
+            } else {
+                float *ptr32 = (float *)ptr;
+                for (i = 0; i < n; i++)
+                    ptr32[x + i] = res[i];
             }
-            ptr32 += linesize/4;
         }
     }
 
@@ -469,11 +468,11 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
         const int width = (plane == 1 || plane == 2) ? AV_CEIL_RSHIFT(inlink->w, geq->hsub) : inlink->w;
         const int height = (plane == 1 || plane == 2) ? AV_CEIL_RSHIFT(inlink->h, geq->vsub) : inlink->h;
         const int linesize = out->linesize[plane];
+        const int nb_jobs = FFMIN(height, nb_threads);
+        int ret[MAX_NB_THREADS];
         ThreadData td;
 
         geq->dst = out->data[plane];
-        geq->dst16 = (uint16_t*)out->data[plane];
-        geq->dst32 = (float*)out->data[plane];
 
         geq->values[VAR_W]  = width;
         geq->values[VAR_H]  = height;
@@ -488,8 +487,14 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
         if (geq->needs_sum[plane])
             calculate_sums(geq, plane, width, height);
 
-        ff_filter_execute(ctx, slice_geq_filter, &td,
-                          NULL, FFMIN(height, nb_threads));
+        ff_filter_execute(ctx, slice_geq_filter, &td, ret, nb_jobs);
+        for (int i = 0; i < nb_jobs; i++) {
+            if (ret[i] < 0) {
+                av_frame_free(&geq->picref);
+                av_frame_free(&out);
+                return ret[i];
+            }
+        }
     }
 
     av_frame_free(&geq->picref);
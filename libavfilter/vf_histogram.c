@@ -60,6 +60,9 @@ typedef struct HistogramContext {
     int            planewidth[4];
     int            planeheight[4];
     int            start[4];
+    int            step;
+    int            nb_jobs;
+    unsigned      *partial;
     AVFrame       *out;
 } HistogramContext;
 
@@ -77,7 +80,8 @@ typedef struct HistogramContext {
         { "linear",      NULL, 0, AV_OPT_TYPE_CONST, {.i64=0}, 0, 0, FLAGS, "levels_mode" }, \
         { "logarithmic", NULL, 0, AV_OPT_TYPE_CONST, {.i64=1}, 0, 0, FLAGS, "levels_mode" }, \
     { "components", "set color components to display", OFFSET(components), AV_OPT_TYPE_INT, {.i64=7}, 1, 15, FLAGS}, \
-    { "c",          "set color components to display", OFFSET(components), AV_OPT_TYPE_INT, {.i64=7}, 1, 15, FLAGS},
+    { "c",          "set color components to display", OFFSET(components), AV_OPT_TYPE_INT, {.i64=7}, 1, 15, FLAGS}, \
+    { "step", "set pixel and row sampling step", OFFSET(step), AV_OPT_TYPE_INT, {.i64=1}, 1, 64, FLAGS},
 
 static const AVOption histogram_options[] = {
     { "level_height", "set level height", OFFSET(level_height), AV_OPT_TYPE_INT, {.i64=200}, 50, 2048, FLAGS},
@@ -229,7 +233,8 @@ static const uint8_t blue_gbrp_color[4]  = {   0,   0, 255, 255 };
 
 static int config_input(AVFilterLink *inlink)
 {
-    HistogramContext *s = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    HistogramContext *s = ctx->priv;
     int rgb = 0;
 
     s->desc  = av_pix_fmt_desc_get(inlink->format);
@@ -365,6 +370,12 @@ static int config_input(AVFilterLink *inlink)
     s->planewidth[1]  = s->planewidth[2]  = AV_CEIL_RSHIFT(inlink->w, s->desc->log2_chroma_w);
     s->planewidth[0]  = s->planewidth[3]  = inlink->w;
 
+    s->nb_jobs = ff_filter_get_nb_threads(ctx);
+    av_freep(&s->partial);
+    s->partial = av_calloc(s->nb_jobs, s->histogram_size * sizeof(*s->partial));
+    if (!s->partial)
+        return AVERROR(ENOMEM);
+
     return 0;
 }
 
@@ -399,6 +410,43 @@ static int config_output(AVFilterLink *outlink)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in;
+    int plane;
+} ThreadData;
+
+static int count_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    HistogramContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int p = td->plane;
+    const int step = s->step;
+    const int width = s->planewidth[p];
+    const int height = s->planeheight[p];
+    const int slice_start = (height * jobnr) / nb_jobs;
+    const int slice_end = (height * (jobnr+1)) / nb_jobs;
+    const ptrdiff_t linesize = td->in->linesize[p];
+    unsigned *histogram = s->partial + jobnr * s->histogram_size;
+
+    memset(histogram, 0, s->histogram_size * sizeof(*histogram));
+
+    for (int i = (slice_start + step - 1) / step * step; i < slice_end; i += step) {
+        const uint8_t *src = td->in->data[p] + i * linesize;
+
+        if (s->histogram_size <= 256) {
+            for (int j = 0; j < width; j += step)
+                histogram[src[j]]++;
+        } else {
+            const uint16_t *src16 = (const uint16_t *)src;
+
+            for (int j = 0; j < width; j += step)
+                histogram[src16[j]]++;
+        }
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     HistogramContext *s   = inlink->dst->priv;
@@ -441,8 +489,9 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         const int p = s->desc->comp[k].plane;
         const int max_value = s->histogram_size - 1 - s->start[p];
         const int height = s->planeheight[p];
-        const int width = s->planewidth[p];
         const int mid = s->mid;
+        ThreadData td;
+        int nb_jobs;
         double max_hval_log;
         unsigned max_hval = 0;
         int starty, startx;
@@ -457,18 +506,17 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
             starty = m++ * (s->level_height + s->scale_height) * (s->display_mode == 2);
         }
 
-        if (s->histogram_size <= 256) {
-            for (i = 0; i < height; i++) {
-                const uint8_t *src = in->data[p] + i * in->linesize[p];
-                for (j = 0; j < width; j++)
-                    s->histogram[src[j]]++;
-            }
-        } else {
-            for (i = 0; i < height; i++) {
-                const uint16_t *src = (const uint16_t *)(in->data[p] + i * in->linesize[p]);
-                for (j = 0; j < width; j++)
-                    s->histogram[src[j]]++;
-            }
+        td.in = in;
+        td.plane = p;
+        nb_jobs = FFMIN(height, s->nb_jobs);
+        ff_filter_execute(ctx, count_slice, &td, NULL, nb_jobs);
+
+        memcpy(s->histogram, s->partial, s->histogram_size * sizeof(*s->histogram));
+        for (i = 1; i < nb_jobs; i++) {
+            const unsigned *partial = s->partial + i * s->histogram_size;
+
+            for (j = 0; j < s->histogram_size; j++)
+                s->histogram[j] += partial[j];
         }
 
         for (i = 0; i < s->histogram_size; i++)
@@ -589,8 +637,6 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
                 }
             }
         }
-
-        memset(s->histogram, 0, s->histogram_size * sizeof(unsigned));
     }
 
     av_frame_copy_props(out, in);
@@ -634,6 +680,15 @@ static const AVFilterPad outputs[] = {
     },
 };
 
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    HistogramContext *s = ctx->priv;
+
+    av_freep(&s->partial);
+    if (s->thistogram)
+        av_frame_free(&s->out);
+}
+
 #if CONFIG_HISTOGRAM_FILTER
 
 const AVFilter ff_vf_histogram = {
@@ -643,20 +698,15 @@ const AVFilter ff_vf_histogram = {
     FILTER_INPUTS(inputs),
     FILTER_OUTPUTS(outputs),
     FILTER_QUERY_FUNC(query_formats),
+    .uninit        = uninit,
     .priv_class    = &histogram_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
 
 #endif /* CONFIG_HISTOGRAM_FILTER */
 
 #if CONFIG_THISTOGRAM_FILTER
 
-static av_cold void uninit(AVFilterContext *ctx)
-{
-    HistogramContext *s = ctx->priv;
-
-    av_frame_free(&s->out);
-}
-
 static const AVOption thistogram_options[] = {
     { "width", "set width", OFFSET(width), AV_OPT_TYPE_INT, {.i64=0}, 0, 8192, FLAGS},
     { "w",     "set width", OFFSET(width), AV_OPT_TYPE_INT, {.i64=0}, 0, 8192, FLAGS},
@@ -687,6 +737,7 @@ const AVFilter ff_vf_thistogram = {
     FILTER_QUERY_FUNC(query_formats),
     .uninit        = uninit,
     .priv_class    = &thistogram_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
 
 #endif /* CONFIG_THISTOGRAM_FILTER */
@@ -34,6 +34,7 @@ static const AVOption idet_options[] = {
     { "rep_thres",  "set repeat threshold",      OFFSET(repeat_threshold),      AV_OPT_TYPE_FLOAT, {.dbl = 3.0},  -1, FLT_MAX, FLAGS },
     { "half_life", "half life of cumulative statistics", OFFSET(half_life),     AV_OPT_TYPE_FLOAT, {.dbl = 0.0},  -1, INT_MAX, FLAGS },
     { "analyze_interlaced_flag", "set number of frames to use to determine if the interlace flag is accurate", OFFSET(analyze_interlaced_flag), AV_OPT_TYPE_INT, {.i64 = 0 }, 0, INT_MAX, FLAGS },
+    { "step", "analyze only every Nth pair of lines", OFFSET(step), AV_OPT_TYPE_INT, {.i64 = 1}, 1, INT_MAX, FLAGS },
     { NULL }
 };
 
@@ -109,39 +110,71 @@ int ff_idet_filter_line_c_16bit(const uint16_t *a, const uint16_t *b, const uint
     return ret;
 }
 
-static void filter(AVFilterContext *ctx)
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     IDETContext *idet = ctx->priv;
+    IDETSliceStats *stats = &idet->slice_stats[jobnr];
     int y, i;
-    int64_t alpha[2]={0};
-    int64_t delta=0;
-    int64_t gamma[2]={0};
-    Type type, best_type;
-    RepeatedField repeat;
-    int match = 0;
-    AVDictionary **metadata = &idet->cur->metadata;
+
+    memset(stats, 0, sizeof(*stats));
 
     for (i = 0; i < idet->csp->nb_components; i++) {
         int w = idet->cur->width;
         int h = idet->cur->height;
         int refs = idet->cur->linesize[i];
+        int slice_start, slice_end;
 
         if (i && i<3) {
             w = AV_CEIL_RSHIFT(w, idet->csp->log2_chroma_w);
             h = AV_CEIL_RSHIFT(h, idet->csp->log2_chroma_h);
         }
 
-        for (y = 2; y < h - 2; y++) {
+        slice_start = 2 + (FFMAX(h - 4, 0) *  jobnr   ) / nb_jobs;
+        slice_end   = 2 + (FFMAX(h - 4, 0) * (jobnr+1)) / nb_jobs;
+
+        for (y = slice_start; y < slice_end; y++) {
             uint8_t *prev = &idet->prev->data[i][y*refs];
             uint8_t *cur  = &idet->cur ->data[i][y*refs];
             uint8_t *next = &idet->next->data[i][y*refs];
-            alpha[ y   &1] += idet->filter_line(cur-refs, prev, cur+refs, w);
-            alpha[(y^1)&1] += idet->filter_line(cur-refs, next, cur+refs, w);
-            delta          += idet->filter_line(cur-refs,  cur, cur+refs, w);
-            gamma[(y^1)&1] += idet->filter_line(cur     , prev, cur     , w);
+
+            if (((y - 2) >> 1) % idet->step)
+                continue;
+
+            stats->alpha[ y   &1] += idet->filter_line(cur-refs, prev, cur+refs, w);
+            stats->alpha[(y^1)&1] += idet->filter_line(cur-refs, next, cur+refs, w);
+            stats->delta          += idet->filter_line(cur-refs,  cur, cur+refs, w);
+            stats->gamma[(y^1)&1] += idet->filter_line(cur     , prev, cur     , w);
         }
     }
 
+    return 0;
+}
+
+static void filter(AVFilterContext *ctx)
+{
+    IDETContext *idet = ctx->priv;
+    int i;
+    int64_t alpha[2]={0};
+    int64_t delta=0;
+    int64_t gamma[2]={0};
+    Type type, best_type;
+    RepeatedField repeat;
+    int match = 0;
+    AVDictionary **metadata = &idet->cur->metadata;
+    const int nb_jobs = FFMIN(idet->cur->height, idet->nb_threads);
+
+    ff_filter_execute(ctx, filter_slice, NULL, NULL, nb_jobs);
+
+    for (i = 0; i < nb_jobs; i++) {
+        const IDETSliceStats *stats = &idet->slice_stats[i];
+
+        alpha[0] += stats->alpha[0];
+        alpha[1] += stats->alpha[1];
+        delta    += stats->delta;
+        gamma[0] += stats->gamma[0];
+        gamma[1] += stats->gamma[1];
+    }
+
     if      (alpha[0] > idet->interlace_threshold * alpha[1]){
         type = TFF;
     }else if(alpha[1] > idet->interlace_threshold * alpha[0]){
@@ -391,6 +424,21 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_frame_free(&idet->prev);
     av_frame_free(&idet->cur );
     av_frame_free(&idet->next);
+    av_freep(&idet->slice_stats);
+}
+
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    IDETContext *idet = ctx->priv;
+
+    idet->nb_threads = ff_filter_get_nb_threads(ctx);
+    av_freep(&idet->slice_stats);
+    idet->slice_stats = av_calloc(idet->nb_threads, sizeof(*idet->slice_stats));
+    if (!idet->slice_stats)
+        return AVERROR(ENOMEM);
+
+    return 0;
 }
 
 static const enum AVPixelFormat pix_fmts[] = {
@@ -454,6 +502,7 @@ static const AVFilterPad idet_inputs[] = {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
         .filter_frame = filter_frame,
+        .config_props = config_input,
     },
 };
 
@@ -471,7 +520,7 @@ const AVFilter ff_vf_idet = {
     .priv_size     = sizeof(IDETContext),
     .init          = init,
     .uninit        = uninit,
-    .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_METADATA_ONLY | AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(idet_inputs),
     FILTER_OUTPUTS(idet_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
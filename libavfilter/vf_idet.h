@@ -39,6 +39,12 @@ typedef enum {
     REPEAT_BOTTOM,
 } RepeatedField;
 
+typedef struct IDETSliceStats {
+    int64_t alpha[2];
+    int64_t delta;
+    int64_t gamma[2];
+} IDETSliceStats;
+
 typedef struct IDETContext {
     const AVClass *class;
     float interlace_threshold;
@@ -46,6 +52,7 @@ typedef struct IDETContext {
     float repeat_threshold;
     float half_life;
     uint64_t decay_coefficient;
+    int step;
 
     Type last_type;
 
@@ -69,6 +76,9 @@ typedef struct IDETContext {
 
     const AVPixFmtDescriptor *csp;
     int eof;
+
+    int nb_threads;
+    IDETSliceStats *slice_stats;
 } IDETContext;
 
 void ff_idet_init_x86(IDETContext *idet, int for_16b);
@@ -0,0 +1,450 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * scale one input to several output sizes (e.g. an ABR ladder), optionally
+ * deriving the smaller outputs from the larger ones
+ */
+
+#include "libavutil/avstring.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+
+#include "avfilter.h"
+#include "filters.h"
+#include "formats.h"
+#include "internal.h"
+#include "video.h"
+
+typedef struct MultiScaleOutput {
+    int req_w, req_h;           ///< requested size, req_w = 0 keeps the input aspect
+    int w, h;                   ///< output size, derived from the input on each configuration
+    int src;                    ///< output scaled from, -1 for the input
+    int needed;                 ///< output or one derived from it is open
+    struct SwsContext *sws;
+} MultiScaleOutput;
+
+typedef struct MultiScaleContext {
+    const AVClass *class;
+    char *sizes_str;
+    char *flags_str;
+    int cascade;
+
+    MultiScaleOutput *outs;
+    int *order;                 ///< outputs sorted by decreasing area
+    AVFrame **frames;
+} MultiScaleContext;
+
+static int query_formats(AVFilterContext *ctx)
+{
+    const AVPixFmtDescriptor *desc = NULL;
+    AVFilterFormats *formats = NULL;
+    int ret;
+
+    while ((desc = av_pix_fmt_desc_next(desc))) {
+        enum AVPixelFormat pix_fmt = av_pix_fmt_desc_get_id(desc);
+
+        if (sws_isSupportedInput(pix_fmt) &&
+            (ret = ff_add_format(&formats, pix_fmt)) < 0)
+            return ret;
+    }
+    if ((ret = ff_formats_ref(formats, &ctx->inputs[0]->outcfg.formats)) < 0)
+        return ret;
+
+    /* a list per output, so that their formats are negotiated separately */
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        formats = NULL;
+        desc    = NULL;
+        while ((desc = av_pix_fmt_desc_next(desc))) {
+            enum AVPixelFormat pix_fmt = av_pix_fmt_desc_get_id(desc);
+
+            /* outputs can be the input of a smaller output */
+            if (sws_isSupportedInput(pix_fmt) && sws_isSupportedOutput(pix_fmt) &&
+                (ret = ff_add_format(&formats, pix_fmt)) < 0)
+                return ret;
+        }
+        if ((ret = ff_formats_ref(formats, &ctx->outputs[i]->incfg.formats)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    MultiScaleContext *s = ctx->priv;
+    int ret;
+
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        MultiScaleOutput *out = &s->outs[i];
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(ctx->outputs[i]->format);
+
+        out->w = out->req_w;
+        out->h = out->req_h;
+        if (!out->w) {
+            int64_t w = av_rescale(out->h, inlink->w, inlink->h);
+            out->w = FFMAX(FFALIGN(w, 1 << desc->log2_chroma_w), 1);
+        }
+        s->order[i] = i;
+    }
+
+    /* insertion sort by decreasing area, stable for equal sizes */
+    for (int i = 1; i < ctx->nb_outputs; i++) {
+        for (int j = i; j > 0; j--) {
+            const MultiScaleOutput *a = &s->outs[s->order[j - 1]];
+            const MultiScaleOutput *b = &s->outs[s->order[j]];
+            if ((int64_t)a->w * a->h >= (int64_t)b->w * b->h)
+                break;
+            FFSWAP(int, s->order[j - 1], s->order[j]);
+        }
+    }
+
+    for (int k = 0; k < ctx->nb_outputs; k++) {
+        const int i = s->order[k];
+        MultiScaleOutput *out = &s->outs[i];
+        AVFilterLink *outlink = ctx->outputs[i];
+        const AVPixFmtDescriptor *outdesc = av_pix_fmt_desc_get(outlink->format);
+        const AVPixFmtDescriptor *srcdesc;
+        int src_w = inlink->w, src_h = inlink->h;
+        enum AVPixelFormat src_format = inlink->format;
+        struct SwsContext *sws;
+
+        /* Derive the output from the smallest already scaled one that is at
+         * least as large and has the same format, so no precision is lost
+         * on the way and the input is converted only once. */
+        out->src = -1;
+        for (int l = 0; s->cascade && l < k; l++) {
+            const MultiScaleOutput *prev = &s->outs[s->order[l]];
+            if (prev->w >= out->w && prev->h >= out->h &&
+                prev->w <= inlink->w && prev->h <= inlink->h &&
+                ctx->outputs[s->order[l]]->format == outlink->format)
+                out->src = s->order[l];
+        }
+        if (out->src >= 0) {
+            src_w      = s->outs[out->src].w;
+            src_h      = s->outs[out->src].h;
+            src_format = ctx->outputs[out->src]->format;
+        }
+        srcdesc = av_pix_fmt_desc_get(src_format);
+
+        sws_freeContext(out->sws);
+        out->sws = sws = sws_alloc_context();
+        if (!sws)
+            return AVERROR(ENOMEM);
+
+        if (s->flags_str && *s->flags_str &&
+            (ret = av_opt_set(sws, "sws_flags", s->flags_str, 0)) < 0)
+            return ret;
+        av_opt_set_int(sws, "threads",    ff_filter_get_nb_threads(ctx), 0);
+        av_opt_set_int(sws, "srcw",       src_w, 0);
+        av_opt_set_int(sws, "srch",       src_h, 0);
+        av_opt_set_int(sws, "src_format", src_format, 0);
+        av_opt_set_int(sws, "dstw",       out->w, 0);
+        av_opt_set_int(sws, "dsth",       out->h, 0);
+        av_opt_set_int(sws, "dst_format", outlink->format, 0);
+        /* MPEG-2 chroma positions, as in the scale filter */
+        if (srcdesc->log2_chroma_h == 1)
+            av_opt_set_int(sws, "src_v_chr_pos", 128, 0);
+        if (outdesc->log2_chroma_h == 1)
+            av_opt_set_int(sws, "dst_v_chr_pos", 128, 0);
+
+        if ((ret = sws_init_context(sws, NULL, NULL)) < 0)
+            return ret;
+
+        av_log(ctx, AV_LOG_VERBOSE, "output%d: %dx%d %s from %s\n",
+               i, out->w, out->h, av_get_pix_fmt_name(outlink->format),
+               out->src < 0 ? "input" : ctx->output_pads[out->src].name);
+    }
+
+    return 0;
+}
+
+static int config_output(AVFilterLink *outlink)
+{
+    AVFilterContext *ctx = outlink->src;
+    AVFilterLink *inlink = ctx->inputs[0];
+    MultiScaleContext *s = ctx->priv;
+    const MultiScaleOutput *out = &s->outs[FF_OUTLINK_IDX(outlink)];
+
+    outlink->w = out->w;
+    outlink->h = out->h;
+    if (inlink->sample_aspect_ratio.num)
+        outlink->sample_aspect_ratio = av_mul_q((AVRational){ outlink->h * inlink->w,
+                                                              outlink->w * inlink->h },
+                                                inlink->sample_aspect_ratio);
+    else
+        outlink->sample_aspect_ratio = inlink->sample_aspect_ratio;
+
+    return 0;
+}
+
+static av_cold int init(AVFilterContext *ctx)
+{
+    MultiScaleContext *s = ctx->priv;
+    const char *p = s->sizes_str;
+    int nb_outputs = 0, ret;
+
+    if (!p || !*p) {
+        av_log(ctx, AV_LOG_ERROR, "No output sizes given.\n");
+        return AVERROR(EINVAL);
+    }
+
+    while (*p) {
+        MultiScaleOutput *out;
+        AVFilterPad pad = { 0 };
+        char *size = av_get_token(&p, "|");
+        char *end;
+
+        if (!size)
+            return AVERROR(ENOMEM);
+        if (*p)
+            p++;
+
+        out = av_dynarray2_add((void **)&s->outs, &nb_outputs,
+                               sizeof(*s->outs), NULL);
+        if (!out) {
+            av_free(size);
+            return AVERROR(ENOMEM);
+        }
+        memset(out, 0, sizeof(*out));
+
+        /* a bare number is a height, the width follows the input aspect */
+        out->req_h = strtol(size, &end, 10);
+        if (*end || end == size) {
+            out->req_h = 0;
+            ret = av_parse_video_size(&out->req_w, &out->req_h, size);
+        } else {
+            ret = out->req_h > 0 ? 0 : AVERROR(EINVAL);
+        }
+        if (ret < 0) {
+            av_log(ctx, AV_LOG_ERROR, "Invalid size '%s'\n", size);
+            av_free(size);
+            return ret;
+        }
+        av_free(size);
+
+        pad.type         = AVMEDIA_TYPE_VIDEO;
+        pad.config_props = config_output;
+        pad.name = av_asprintf("output%d", nb_outputs - 1);
+        if (!pad.name)
+            return AVERROR(ENOMEM);
+        if ((ret = ff_append_outpad_free_name(ctx, &pad)) < 0)
+            return ret;
+    }
+
+    s->order  = av_calloc(nb_outputs, sizeof(*s->order));
+    s->frames = av_calloc(nb_outputs, sizeof(*s->frames));
+    if (!s->order || !s->frames)
+        return AVERROR(ENOMEM);
+
+    return 0;
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    MultiScaleContext *s = ctx->priv;
+
+    for (int i = 0; i < ctx->nb_outputs && s->outs; i++)
+        sws_freeContext(s->outs[i].sws);
+    av_freep(&s->outs);
+    av_freep(&s->order);
+    av_freep(&s->frames);
+}
+
+static const int *get_yuv_coeffs(enum AVColorSpace colorspace)
+{
+    if (colorspace < 1 || colorspace > 10 || colorspace == 8)
+        colorspace = AVCOL_SPC_BT470BG;
+
+    return sws_getCoefficients(colorspace);
+}
+
+static int scale_output(AVFilterContext *ctx, int i, AVFrame *in)
+{
+    MultiScaleContext *s = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[i];
+    const MultiScaleOutput *out = &s->outs[i];
+    AVFrame *src = out->src < 0 ? in : s->frames[out->src];
+    int in_full, out_full, brightness, contrast, saturation;
+    const int *inv_table, *table;
+    AVFrame *dst;
+    int ret;
+
+    dst = s->frames[i] = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+    if (!dst)
+        return AVERROR(ENOMEM);
+    ret = av_frame_copy_props(dst, src);
+    if (ret < 0)
+        return ret;
+    dst->width  = outlink->w;
+    dst->height = outlink->h;
+
+    if (av_pix_fmt_desc_get(outlink->format)->flags & AV_PIX_FMT_FLAG_RGB)
+        dst->colorspace = AVCOL_SPC_RGB;
+    else if (dst->colorspace == AVCOL_SPC_RGB)
+        dst->colorspace = AVCOL_SPC_UNSPECIFIED;
+
+    sws_getColorspaceDetails(out->sws, (int **)&inv_table, &in_full,
+                             (int **)&table, &out_full,
+                             &brightness, &contrast, &saturation);
+    /* same matrix on both sides, as the scale filter does by default */
+    inv_table = table = get_yuv_coeffs(src->colorspace);
+    if (src->color_range != AVCOL_RANGE_UNSPECIFIED)
+        in_full = src->color_range == AVCOL_RANGE_JPEG;
+    sws_setColorspaceDetails(out->sws, inv_table, in_full,
+                             table, out_full,
+                             brightness, contrast, saturation);
+    dst->color_range = out_full ? AVCOL_RANGE_JPEG : AVCOL_RANGE_MPEG;
+
+    av_reduce(&dst->sample_aspect_ratio.num, &dst->sample_aspect_ratio.den,
+              (int64_t)in->sample_aspect_ratio.num * outlink->h * ctx->inputs[0]->w,
+              (int64_t)in->sample_aspect_ratio.den * outlink->w * ctx->inputs[0]->h,
+              INT_MAX);
+
+    return sws_scale_frame(out->sws, dst, src);
+}
+
+static int filter_frame(AVFilterContext *ctx, AVFrame *in)
+{
+    MultiScaleContext *s = ctx->priv;
+    int ret = 0;
+
+    /* sources always come before the outputs derived from them */
+    for (int k = ctx->nb_outputs - 1; k >= 0; k--) {
+        MultiScaleOutput *out = &s->outs[s->order[k]];
+
+        out->needed |= !ff_outlink_get_status(ctx->outputs[s->order[k]]);
+        if (out->needed && out->src >= 0)
+            s->outs[out->src].needed = 1;
+    }
+
+    /* scale everything first, later outputs may read the earlier ones */
+    for (int k = 0; k < ctx->nb_outputs; k++) {
+        MultiScaleOutput *out = &s->outs[s->order[k]];
+
+        if (!out->needed)
+            continue;
+        out->needed = 0;
+        if ((ret = scale_output(ctx, s->order[k], in)) < 0)
+            goto fail;
+    }
+
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        AVFrame *out = s->frames[i];
+
+        s->frames[i] = NULL;
+        if (!out)
+            continue;
+        if (ff_outlink_get_status(ctx->outputs[i])) {
+            av_frame_free(&out);
+            continue;
+        }
+        if ((ret = ff_filter_frame(ctx->outputs[i], out)) < 0)
+            goto fail;
+    }
+
+fail:
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        av_frame_free(&s->frames[i]);
+        s->outs[i].needed = 0;
+    }
+    av_frame_free(&in);
+    return ret;
+}
+
+static int activate(AVFilterContext *ctx)
+{
+    AVFilterLink *inlink = ctx->inputs[0];
+    AVFrame *in;
+    int status, ret, nb_eofs = 0;
+    int64_t pts;
+
+    for (int i = 0; i < ctx->nb_outputs; i++)
+        nb_eofs += ff_outlink_get_status(ctx->outputs[i]) == AVERROR_EOF;
+
+    if (nb_eofs == ctx->nb_outputs) {
+        ff_inlink_set_status(inlink, AVERROR_EOF);
+        return 0;
+    }
+
+    ret = ff_inlink_consume_frame(inlink, &in);
+    if (ret < 0)
+        return ret;
+    if (ret > 0)
+        return filter_frame(ctx, in);
+
+    if (ff_inlink_acknowledge_status(inlink, &status, &pts)) {
+        for (int i = 0; i < ctx->nb_outputs; i++) {
+            if (ff_outlink_get_status(ctx->outputs[i]))
+                continue;
+            ff_outlink_set_status(ctx->outputs[i], status, pts);
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        if (ff_outlink_get_status(ctx->outputs[i]))
+            continue;
+
+        if (ff_outlink_frame_wanted(ctx->outputs[i])) {
+            ff_inlink_request_frame(inlink);
+            return 0;
+        }
+    }
+
+    return FFERROR_NOT_READY;
+}
+
+#define OFFSET(x) offsetof(MultiScaleContext, x)
+#define FLAGS AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_FILTERING_PARAM
+
+static const AVOption multiscale_options[] = {
+    { "sizes",   "set the '|'-separated output sizes", OFFSET(sizes_str), AV_OPT_TYPE_STRING, { .str = NULL }, .flags = FLAGS },
+    { "flags",   "Flags to pass to libswscale",        OFFSET(flags_str), AV_OPT_TYPE_STRING, { .str = ""   }, .flags = FLAGS },
+    { "cascade", "scale smaller outputs from larger ones", OFFSET(cascade), AV_OPT_TYPE_BOOL, { .i64 = 1 }, 0, 1, FLAGS },
+    { NULL }
+};
+
+AVFILTER_DEFINE_CLASS(multiscale);
+
+static const AVFilterPad multiscale_inputs[] = {
+    {
+        .name         = "default",
+        .type         = AVMEDIA_TYPE_VIDEO,
+        .config_props = config_input,
+    },
+};
+
+const AVFilter ff_vf_multiscale = {
+    .name          = "multiscale",
+    .description   = NULL_IF_CONFIG_SMALL("Scale the input video to several sizes."),
+    .priv_size     = sizeof(MultiScaleContext),
+    .priv_class    = &multiscale_class,
+    .init          = init,
+    .uninit        = uninit,
+    .activate      = activate,
+    FILTER_INPUTS(multiscale_inputs),
+    .outputs       = NULL,
+    FILTER_QUERY_FUNC(query_formats),
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+};
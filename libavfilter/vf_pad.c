@@ -320,10 +320,63 @@ static int frame_needs_copy(PadContext *s, AVFrame *frame)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int needs_copy;
+} ThreadData;
+
+static int pad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PadContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    const int align = 1 << s->draw.vsub_max;
+    const int start = ((s->h *  jobnr     ) / nb_jobs) & ~(align - 1);
+    const int end   = jobnr == nb_jobs - 1 ? s->h :
+                      ((s->h * (jobnr + 1)) / nb_jobs) & ~(align - 1);
+    int y0, y1;
+
+    /* top bar */
+    y0 = start;
+    y1 = FFMIN(end, s->y);
+    if (y1 > y0)
+        ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
+                          0, y0, s->w, y1 - y0);
+
+    /* bottom bar */
+    y0 = FFMAX(start, s->y + s->in_h);
+    y1 = end;
+    if (y1 > y0)
+        ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
+                          0, y0, s->w, y1 - y0);
+
+    y0 = FFMAX(start, s->y);
+    y1 = FFMIN(end, s->y + in->height);
+    if (y1 <= y0)
+        return 0;
+
+    /* left border */
+    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
+                      0, y0, s->x, y1 - y0);
+
+    if (td->needs_copy) {
+        ff_copy_rectangle2(&s->draw,
+                          out->data, out->linesize, in->data, in->linesize,
+                          s->x, y0, 0, y0 - s->y, in->width, y1 - y0);
+    }
+
+    /* right border */
+    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
+                      s->x + s->in_w, y0, s->w - s->x - s->in_w, y1 - y0);
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     PadContext *s = inlink->dst->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
+    ThreadData td;
     AVFrame *out;
     int needs_copy;
     if(s->eval_mode == EVAL_MODE_FRAME && (
@@ -376,34 +429,12 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         }
     }
 
-    /* top bar */
-    if (s->y) {
-        ff_fill_rectangle(&s->draw, &s->color,
-                          out->data, out->linesize,
-                          0, 0, s->w, s->y);
-    }
-
-    /* bottom bar */
-    if (s->h > s->y + s->in_h) {
-        ff_fill_rectangle(&s->draw, &s->color,
-                          out->data, out->linesize,
-                          0, s->y + s->in_h, s->w, s->h - s->y - s->in_h);
-    }
-
-    /* left border */
-    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
-                      0, s->y, s->x, in->height);
-
-    if (needs_copy) {
-        ff_copy_rectangle2(&s->draw,
-                          out->data, out->linesize, in->data, in->linesize,
-                          s->x, s->y, 0, 0, in->width, in->height);
-    }
-
-    /* right border */
-    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
-                      s->x + s->in_w, s->y, s->w - s->x - s->in_w,
-                      in->height);
+    td.in  = in;
+    td.out = out;
+    td.needs_copy = needs_copy;
+    ff_filter_execute(inlink->dst, pad_slice, &td, NULL,
+                      av_clip(s->h >> s->draw.vsub_max, 1,
+                              ff_filter_get_nb_threads(inlink->dst)));
 
     out->width  = s->w;
     out->height = s->h;
@@ -459,4 +490,5 @@ const AVFilter ff_vf_pad = {
     FILTER_INPUTS(avfilter_vf_pad_inputs),
     FILTER_OUTPUTS(avfilter_vf_pad_outputs),
     FILTER_QUERY_FUNC(query_formats),
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
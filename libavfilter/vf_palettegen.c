@@ -76,6 +76,9 @@ typedef struct PaletteGenContext {
 
     AVFrame *prev_frame;                    // previous frame used for the diff stats_mode
     struct hist_node histogram[HIST_SIZE];  // histogram/hashtable of the colors
+    struct hist_node *thread_hist;          // per-thread partial histograms, HIST_SIZE nodes each
+    int nb_thread_hist;                     // number of per-thread histograms
+    int *job_ret;                           // return values of the histogram jobs
     struct color_ref **refs;                // references of all the colors used in the stream
     int nb_refs;                            // number of color references (or number of different colors)
     struct range_box boxes[256];            // define the segmentation of the colorspace (the final palette)
@@ -419,11 +422,12 @@ static int color_inc(struct hist_node *hist, uint32_t color)
  * Update histogram when pixels differ from previous frame.
  */
 static int update_histogram_diff(struct hist_node *hist,
-                                 const AVFrame *f1, const AVFrame *f2)
+                                 const AVFrame *f1, const AVFrame *f2,
+                                 int y_start, int y_end)
 {
     int x, y, ret, nb_diff_colors = 0;
 
-    for (y = 0; y < f1->height; y++) {
+    for (y = y_start; y < y_end; y++) {
         const uint32_t *p = (const uint32_t *)(f1->data[0] + y*f1->linesize[0]);
         const uint32_t *q = (const uint32_t *)(f2->data[0] + y*f2->linesize[0]);
 
@@ -442,11 +446,12 @@ static int update_histogram_diff(struct hist_node *hist,
 /**
  * Simple histogram of the frame.
  */
-static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
+static int update_histogram_frame(struct hist_node *hist, const AVFrame *f,
+                                  int y_start, int y_end)
 {
     int x, y, ret, nb_diff_colors = 0;
 
-    for (y = 0; y < f->height; y++) {
+    for (y = y_start; y < y_end; y++) {
         const uint32_t *p = (const uint32_t *)(f->data[0] + y*f->linesize[0]);
 
         for (x = 0; x < f->width; x++) {
@@ -459,6 +464,85 @@ static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
     return nb_diff_colors;
 }
 
+typedef struct ThreadData {
+    const AVFrame *in, *prev;
+} ThreadData;
+
+static int update_histogram_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteGenContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    struct hist_node *hist = s->thread_hist + (size_t)jobnr * HIST_SIZE;
+    const int slice_start = (td->in->height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (td->in->height * (jobnr + 1)) / nb_jobs;
+
+    return td->prev ? update_histogram_diff(hist, td->prev, td->in, slice_start, slice_end)
+                    : update_histogram_frame(hist, td->in, slice_start, slice_end);
+}
+
+/**
+ * Move the colors counted in a partial histogram into the main one.
+ * Entries are appended in the order they were first met, so merging the
+ * slices top to bottom keeps the same layout as a single-threaded pass.
+ */
+static int merge_histogram(struct hist_node *dst, struct hist_node *src)
+{
+    int nb_new_colors = 0;
+
+    for (int i = 0; i < HIST_SIZE; i++) {
+        struct hist_node *node = &dst[i];
+
+        for (int j = 0; j < src[i].nb_entries; j++) {
+            const struct color_ref *ref = &src[i].entries[j];
+            struct color_ref *e = NULL;
+
+            for (int k = 0; k < node->nb_entries; k++) {
+                if (node->entries[k].color == ref->color) {
+                    e = &node->entries[k];
+                    break;
+                }
+            }
+            if (e) {
+                e->count += ref->count;
+                continue;
+            }
+
+            e = av_dynarray2_add((void**)&node->entries, &node->nb_entries,
+                                 sizeof(*node->entries), (const uint8_t *)ref);
+            if (!e)
+                return AVERROR(ENOMEM);
+            nb_new_colors++;
+        }
+        src[i].nb_entries = 0;
+    }
+    return nb_new_colors;
+}
+
+static int update_histogram(AVFilterContext *ctx, const AVFrame *prev, const AVFrame *in)
+{
+    PaletteGenContext *s = ctx->priv;
+    ThreadData td = { .in = in, .prev = prev };
+    const int nb_jobs = FFMIN(in->height, s->nb_thread_hist);
+    int ret, nb_diff_colors = 0;
+
+    if (nb_jobs <= 1)
+        return prev ? update_histogram_diff(s->histogram, prev, in, 0, in->height)
+                    : update_histogram_frame(s->histogram, in, 0, in->height);
+
+    ff_filter_execute(ctx, update_histogram_slice, &td, s->job_ret, nb_jobs);
+    for (int i = 0; i < nb_jobs; i++) {
+        struct hist_node *hist = s->thread_hist + (size_t)i * HIST_SIZE;
+
+        if (s->job_ret[i] < 0)
+            return s->job_ret[i];
+        ret = merge_histogram(s->histogram, hist);
+        if (ret < 0)
+            return ret;
+        nb_diff_colors += ret;
+    }
+    return nb_diff_colors;
+}
+
 /**
  * Update the histogram for each passing frame. No frame will be pushed here.
  */
@@ -471,8 +555,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     if (in->color_trc != AVCOL_TRC_UNSPECIFIED && in->color_trc != AVCOL_TRC_IEC61966_2_1)
         av_log(ctx, AV_LOG_WARNING, "The input frame is not in sRGB, colors may be off\n");
 
-    ret = s->prev_frame ? update_histogram_diff(s->histogram, s->prev_frame, in)
-                        : update_histogram_frame(s->histogram, in);
+    ret = update_histogram(ctx, s->prev_frame, in);
     if (ret > 0)
         s->nb_refs += ret;
 
@@ -525,8 +608,26 @@ static int request_frame(AVFilterLink *outlink)
  */
 static int config_output(AVFilterLink *outlink)
 {
+    AVFilterContext *ctx = outlink->src;
+    PaletteGenContext *s = ctx->priv;
+
     outlink->w = outlink->h = 16;
     outlink->sample_aspect_ratio = av_make_q(1, 1);
+
+    if (!s->thread_hist) {
+        const int nb_threads = ff_filter_get_nb_threads(ctx);
+
+        if (nb_threads > 1) {
+            s->thread_hist = av_calloc(nb_threads, HIST_SIZE * sizeof(*s->thread_hist));
+            s->job_ret     = av_calloc(nb_threads, sizeof(*s->job_ret));
+            if (!s->thread_hist || !s->job_ret) {
+                av_freep(&s->thread_hist);
+                av_freep(&s->job_ret);
+                return AVERROR(ENOMEM);
+            }
+            s->nb_thread_hist = nb_threads;
+        }
+    }
     return 0;
 }
 
@@ -549,6 +650,10 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     for (i = 0; i < HIST_SIZE; i++)
         av_freep(&s->histogram[i].entries);
+    for (i = 0; i < s->nb_thread_hist * HIST_SIZE; i++)
+        av_freep(&s->thread_hist[i].entries);
+    av_freep(&s->thread_hist);
+    av_freep(&s->job_ret);
     av_freep(&s->refs);
     av_frame_free(&s->prev_frame);
 }
@@ -580,4 +685,5 @@ const AVFilter ff_vf_palettegen = {
     FILTER_OUTPUTS(palettegen_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &palettegen_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -82,13 +82,16 @@ struct cache_node {
 
 struct PaletteUseContext;
 
-typedef int (*set_frame_func)(struct PaletteUseContext *s, AVFrame *out, AVFrame *in,
+typedef int (*set_frame_func)(struct PaletteUseContext *s, struct cache_node *cache,
+                              AVFrame *out, AVFrame *in,
                               int x_start, int y_start, int width, int height);
 
 typedef struct PaletteUseContext {
     const AVClass *class;
     FFFrameSync fs;
-    struct cache_node cache[CACHE_SIZE];    /* lookup cache */
+    struct cache_node *caches;              /* lookup caches, CACHE_SIZE entries per thread */
+    int nb_caches;
+    int *job_ret;
     struct color_node map[AVPALETTE_COUNT]; /* 3D-Tree (KD-Tree with K=3) for reverse colormap */
     uint32_t palette[AVPALETTE_COUNT];
     int transparency_index; /* index in the palette of transparency. -1 if there is no transparency in the palette. */
@@ -237,11 +240,12 @@ struct stack_node {
  * Check if the requested color is in the cache already. If not, find it in the
  * color tree and cache it.
  */
-static av_always_inline int color_get(PaletteUseContext *s, uint32_t color)
+static av_always_inline int color_get(PaletteUseContext *s, struct cache_node *cache,
+                                      uint32_t color)
 {
     struct color_info clrinfo;
     const uint32_t hash = ff_lowbias32(color) & (CACHE_SIZE - 1);
-    struct cache_node *node = &s->cache[hash];
+    struct cache_node *node = &cache[hash];
     struct cached_color *e;
 
     // first, check for transparency
@@ -266,11 +270,11 @@ static av_always_inline int color_get(PaletteUseContext *s, uint32_t color)
     return e->pal_entry;
 }
 
-static av_always_inline int get_dst_color_err(PaletteUseContext *s,
+static av_always_inline int get_dst_color_err(PaletteUseContext *s, struct cache_node *cache,
                                               uint32_t c, int *er, int *eg, int *eb)
 {
     uint32_t dstc;
-    const int dstx = color_get(s, c);
+    const int dstx = color_get(s, cache, c);
     if (dstx < 0)
         return dstx;
     dstc = s->palette[dstx];
@@ -287,7 +291,8 @@ static av_always_inline int get_dst_color_err(PaletteUseContext *s,
     return dstx;
 }
 
-static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFrame *in,
+static av_always_inline int set_frame(PaletteUseContext *s, struct cache_node *cache,
+                                      AVFrame *out, AVFrame *in,
                                       int x_start, int y_start, int w, int h,
                                       enum dithering_mode dither)
 {
@@ -313,7 +318,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t g = av_clip_uint8(g8 + d);
                 const uint8_t b = av_clip_uint8(b8 + d);
                 const uint32_t color_new = (unsigned)(a8) << 24 | r << 16 | g << 8 | b;
-                const int color = color_get(s, color_new);
+                const int color = color_get(s, cache, color_new);
 
                 if (color < 0)
                     return color;
@@ -321,7 +326,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_HECKBERT) {
                 const int right = x < w - 1, down = y < h - 1;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb);
 
                 if (color < 0)
                     return color;
@@ -333,7 +338,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_FLOYD_STEINBERG) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb);
 
                 if (color < 0)
                     return color;
@@ -347,7 +352,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
             } else if (dither == DITHERING_SIERRA2) {
                 const int right  = x < w - 1, down  = y < h - 1, left  = x > x_start;
                 const int right2 = x < w - 2,                    left2 = x > x_start + 1;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb);
 
                 if (color < 0)
                     return color;
@@ -366,7 +371,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_SIERRA2_4A) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb);
 
                 if (color < 0)
                     return color;
@@ -379,7 +384,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
             } else if (dither == DITHERING_SIERRA3) {
                 const int right  = x < w - 1, down  = y < h - 1, left  = x > x_start;
                 const int right2 = x < w - 2, down2 = y < h - 2, left2 = x > x_start + 1;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb);
 
                 if (color < 0)
                     return color;
@@ -405,7 +410,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
             } else if (dither == DITHERING_BURKES) {
                 const int right  = x < w - 1, down  = y < h - 1, left  = x > x_start;
                 const int right2 = x < w - 2,                    left2 = x > x_start + 1;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb);
 
                 if (color < 0)
                     return color;
@@ -425,7 +430,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
             } else if (dither == DITHERING_ATKINSON) {
                 const int right  = x < w - 1, down  = y < h - 1, left = x > x_start;
                 const int right2 = x < w - 2, down2 = y < h - 2;
-                const int color = get_dst_color_err(s, src[x], &er, &eg, &eb);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb);
 
                 if (color < 0)
                     return color;
@@ -442,7 +447,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 }
 
             } else {
-                const int color = color_get(s, src[x]);
+                const int color = color_get(s, cache, src[x]);
 
                 if (color < 0)
                     return color;
@@ -765,6 +770,22 @@ static void set_processing_window(enum diff_mode diff_mode,
     *hp = height;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int x, y, w, h;
+} ThreadData;
+
+static int set_frame_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteUseContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    const int slice_start = td->y + (td->h *  jobnr     ) / nb_jobs;
+    const int slice_end   = td->y + (td->h * (jobnr + 1)) / nb_jobs;
+
+    return s->set_frame(s, s->caches + (size_t)jobnr * CACHE_SIZE, td->out, td->in,
+                        td->x, slice_start, td->w, slice_end - slice_start);
+}
+
 static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
 {
     int x, y, w, h, ret;
@@ -793,7 +814,20 @@ static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
     ff_dlog(ctx, "%dx%d rect: (%d;%d) -> (%d,%d) [area:%dx%d]\n",
             w, h, x, y, x+w, y+h, in->width, in->height);
 
-    ret = s->set_frame(s, out, in, x, y, w, h);
+    if (s->dither == DITHERING_NONE || s->dither == DITHERING_BAYER) {
+        /* no error diffusion: rows can be mapped independently, each
+         * thread using its own lookup cache */
+        ThreadData td = { .in = in, .out = out, .x = x, .y = y, .w = w, .h = h };
+        const int nb_jobs = FFMIN(h, s->nb_caches);
+
+        ret = 0;
+        if (nb_jobs > 0)
+            ff_filter_execute(ctx, set_frame_slice, &td, s->job_ret, nb_jobs);
+        for (int i = 0; i < nb_jobs; i++)
+            ret = FFMIN(ret, s->job_ret[i]);
+    } else {
+        ret = s->set_frame(s, s->caches, out, in, x, y, w, h);
+    }
     if (ret < 0) {
         av_frame_free(&out);
         *outf = NULL;
@@ -823,6 +857,21 @@ static int config_output(AVFilterLink *outlink)
     outlink->time_base = ctx->inputs[0]->time_base;
     if ((ret = ff_framesync_configure(&s->fs)) < 0)
         return ret;
+
+    if (!s->caches) {
+        int nb_caches = 1;
+
+        if (s->dither == DITHERING_NONE || s->dither == DITHERING_BAYER)
+            nb_caches = ff_filter_get_nb_threads(ctx);
+        s->caches  = av_calloc(nb_caches, CACHE_SIZE * sizeof(*s->caches));
+        s->job_ret = av_calloc(nb_caches, sizeof(*s->job_ret));
+        if (!s->caches || !s->job_ret) {
+            av_freep(&s->caches);
+            av_freep(&s->job_ret);
+            return AVERROR(ENOMEM);
+        }
+        s->nb_caches = nb_caches;
+    }
     return 0;
 }
 
@@ -852,9 +901,10 @@ static void load_palette(PaletteUseContext *s, const AVFrame *palette_frame)
     if (s->new) {
         memset(s->palette, 0, sizeof(s->palette));
         memset(s->map, 0, sizeof(s->map));
-        for (i = 0; i < CACHE_SIZE; i++)
-            av_freep(&s->cache[i].entries);
-        memset(s->cache, 0, sizeof(s->cache));
+        for (i = 0; i < s->nb_caches * CACHE_SIZE; i++) {
+            av_freep(&s->caches[i].entries);
+            s->caches[i].nb_entries = 0;
+        }
     }
 
     i = 0;
@@ -902,10 +952,11 @@ static int load_apply_palette(FFFrameSync *fs)
 }
 
 #define DEFINE_SET_FRAME(name, value)                                           \
-static int set_frame_##name(PaletteUseContext *s, AVFrame *out, AVFrame *in,    \
+static int set_frame_##name(PaletteUseContext *s, struct cache_node *cache,     \
+                            AVFrame *out, AVFrame *in,                          \
                             int x_start, int y_start, int w, int h)             \
 {                                                                               \
-    return set_frame(s, out, in, x_start, y_start, w, h, value);                \
+    return set_frame(s, cache, out, in, x_start, y_start, w, h, value);         \
 }
 
 DEFINE_SET_FRAME(none,            DITHERING_NONE)
@@ -970,8 +1021,10 @@ static av_cold void uninit(AVFilterContext *ctx)
     PaletteUseContext *s = ctx->priv;
 
     ff_framesync_uninit(&s->fs);
-    for (int i = 0; i < CACHE_SIZE; i++)
-        av_freep(&s->cache[i].entries);
+    for (int i = 0; i < s->nb_caches * CACHE_SIZE; i++)
+        av_freep(&s->caches[i].entries);
+    av_freep(&s->caches);
+    av_freep(&s->job_ret);
     av_frame_free(&s->last_in);
     av_frame_free(&s->last_out);
 }
@@ -1006,4 +1059,5 @@ const AVFilter ff_vf_paletteuse = {
     FILTER_OUTPUTS(paletteuse_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &paletteuse_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -177,16 +177,15 @@ static void blend_frame(AVFilterContext *ctx, AVFrame *target, AVFrame *source,
 
 static int get_badness(PhotosensitivityFrame *a, PhotosensitivityFrame *b)
 {
-    int badness, x, y, c;
-    badness = 0;
-    for (c = 0; c < NUM_CHANNELS; c++) {
-        for (y = 0; y < GRID_SIZE; y++) {
-            for (x = 0; x < GRID_SIZE; x++) {
-                badness += abs((int)a->grid[y][x][c] - (int)b->grid[y][x][c]);
-                //av_log(NULL, AV_LOG_VERBOSE, "%d - %d -> %d \n", a->grid[y][x], b->grid[y][x], badness);
-                //av_log(NULL, AV_LOG_VERBOSE, "%d -> %d \n", abs((int)a->grid[y][x] - (int)b->grid[y][x]), badness);
-            }
-        }
+    const uint8_t *pa = &a->grid[0][0][0];
+    const uint8_t *pb = &b->grid[0][0][0];
+    int badness = 0;
+
+    /* walk the grid in memory order; the padding channel is skipped */
+    for (int i = 0; i < NUM_CELLS * 4; i += 4) {
+        badness += abs(pa[i + 0] - pb[i + 0]);
+        badness += abs(pa[i + 1] - pb[i + 1]);
+        badness += abs(pa[i + 2] - pb[i + 2]);
     }
     return badness;
 }
@@ -316,4 +315,5 @@ const AVFilter ff_vf_photosensitivity = {
     FILTER_INPUTS(inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS(AV_PIX_FMT_RGB24, AV_PIX_FMT_BGR24),
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
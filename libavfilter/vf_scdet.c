@@ -41,6 +41,8 @@ typedef struct SCDetContext {
     ff_scene_sad_fn sad;
     double prev_mafd;
     double scene_score;
+    uint64_t frame_sad;         ///< SAD between the current and previous frame
+    int64_t sad_ref_pts;        ///< pts of the previous frame, AV_NOPTS_VALUE if no SAD
     AVFrame *prev_picref;
     double threshold;
     int sc_pass;
@@ -110,21 +112,22 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
     double ret = 0;
     SCDetContext *s = ctx->priv;
     AVFrame *prev_picref = s->prev_picref;
+    uint64_t sad;
+    int have_sad = ff_scene_sad_get_meta(frame, prev_picref, &sad);
 
+    s->sad_ref_pts = AV_NOPTS_VALUE;
     if (prev_picref && frame->height == prev_picref->height
                     && frame->width  == prev_picref->width) {
-        uint64_t sad = 0;
         double mafd, diff;
         uint64_t count = 0;
 
-        for (int plane = 0; plane < s->nb_planes; plane++) {
-            uint64_t plane_sad;
-            s->sad(prev_picref->data[plane], prev_picref->linesize[plane],
-                    frame->data[plane], frame->linesize[plane],
-                    s->width[plane], s->height[plane], &plane_sad);
-            sad += plane_sad;
+        if (!have_sad)
+            sad = ff_scene_sad_frame(ctx, s->sad, prev_picref, frame,
+                                     s->nb_planes, s->width, s->height);
+        s->frame_sad   = sad;
+        s->sad_ref_pts = prev_picref->pts;
+        for (int plane = 0; plane < s->nb_planes; plane++)
             count += s->width[plane] * s->height[plane];
-        }
 
         mafd = (double)sad * 100. / count / (1ULL << s->bitdepth);
         diff = fabs(mafd - s->prev_mafd);
@@ -169,6 +172,7 @@ static int activate(AVFilterContext *ctx)
             set_meta(s, frame, "lavfi.scd.time",
                     av_ts2timestr(frame->pts, &inlink->time_base));
         }
+        ff_scene_sad_set_meta(ctx, frame, s->sad_ref_pts, s->frame_sad);
         if (s->sc_pass) {
             if (s->scene_score >= s->threshold)
                 return ff_filter_frame(outlink, frame);
@@ -199,7 +203,7 @@ const AVFilter ff_vf_scdet = {
     .priv_size     = sizeof(SCDetContext),
     .priv_class    = &scdet_class,
     .uninit        = uninit,
-    .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_METADATA_ONLY | AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(scdet_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
@@ -48,6 +48,12 @@ typedef struct TileContext {
     uint8_t rgba_color[4];
 } TileContext;
 
+typedef struct ThreadData {
+    AVFrame *dst, *src;   /* src == NULL fills with the blank color */
+    unsigned dst_x, dst_y, src_x, src_y;
+    unsigned w, h;
+} ThreadData;
+
 #define OFFSET(x) offsetof(TileContext, x)
 #define FLAGS AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
 
@@ -145,6 +151,50 @@ static int config_props(AVFilterLink *outlink)
     return 0;
 }
 
+static int copy_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    TileContext *tile = ctx->priv;
+    ThreadData *td    = arg;
+    /* keep slice edges on chroma rows so subsampled planes split exactly */
+    const unsigned step   = 1 << tile->draw.vsub_max;
+    const unsigned units  = (td->h + step - 1) / step;
+    const unsigned start  = FFMIN(td->h, (units *  jobnr   ) / nb_jobs * step);
+    const unsigned end    = FFMIN(td->h, (units * (jobnr+1)) / nb_jobs * step);
+
+    if (start >= end)
+        return 0;
+
+    if (td->src)
+        ff_copy_rectangle2(&tile->draw,
+                           td->dst->data, td->dst->linesize,
+                           td->src->data, td->src->linesize,
+                           td->dst_x, td->dst_y + start,
+                           td->src_x, td->src_y + start,
+                           td->w, end - start);
+    else
+        ff_fill_rectangle(&tile->draw, &tile->blank,
+                          td->dst->data, td->dst->linesize,
+                          td->dst_x, td->dst_y + start,
+                          td->w, end - start);
+    return 0;
+}
+
+static void copy_rectangle(AVFilterContext *ctx, AVFrame *dst, AVFrame *src,
+                           unsigned dst_x, unsigned dst_y,
+                           unsigned src_x, unsigned src_y,
+                           unsigned w, unsigned h)
+{
+    ThreadData td = {
+        .dst   = dst,   .src   = src,
+        .dst_x = dst_x, .dst_y = dst_y,
+        .src_x = src_x, .src_y = src_y,
+        .w     = w,     .h     = h,
+    };
+
+    ff_filter_execute(ctx, copy_slice, &td, NULL,
+                      FFMIN(h, ff_filter_get_nb_threads(ctx)));
+}
+
 static void get_tile_pos(AVFilterContext *ctx, unsigned *x, unsigned *y, unsigned current)
 {
     TileContext *tile    = ctx->priv;
@@ -163,9 +213,7 @@ static void draw_blank_frame(AVFilterContext *ctx, AVFrame *out_buf)
     unsigned x0, y0;
 
     get_tile_pos(ctx, &x0, &y0, tile->current);
-    ff_fill_rectangle(&tile->draw, &tile->blank,
-                      out_buf->data, out_buf->linesize,
-                      x0, y0, inlink->w, inlink->h);
+    copy_rectangle(ctx, out_buf, NULL, x0, y0, 0, 0, inlink->w, inlink->h);
     tile->current++;
 }
 
@@ -211,10 +259,8 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
 
         /* fill surface once for margin/padding */
         if (tile->margin || tile->padding || tile->init_padding)
-            ff_fill_rectangle(&tile->draw, &tile->blank,
-                              tile->out_ref->data,
-                              tile->out_ref->linesize,
-                              0, 0, outlink->w, outlink->h);
+            copy_rectangle(ctx, tile->out_ref, NULL,
+                           0, 0, 0, 0, outlink->w, outlink->h);
         tile->init_padding = 0;
     }
 
@@ -224,19 +270,15 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
         for (i = tile->nb_frames - tile->overlap; i < tile->nb_frames; i++) {
             get_tile_pos(ctx, &x1, &y1, i);
             get_tile_pos(ctx, &x0, &y0, i - (tile->nb_frames - tile->overlap));
-            ff_copy_rectangle2(&tile->draw,
-                               tile->out_ref->data, tile->out_ref->linesize,
-                               tile->prev_out_ref->data, tile->prev_out_ref->linesize,
-                               x0, y0, x1, y1, inlink->w, inlink->h);
+            copy_rectangle(ctx, tile->out_ref, tile->prev_out_ref,
+                           x0, y0, x1, y1, inlink->w, inlink->h);
 
         }
     }
 
     get_tile_pos(ctx, &x0, &y0, tile->current);
-    ff_copy_rectangle2(&tile->draw,
-                       tile->out_ref->data, tile->out_ref->linesize,
-                       picref->data, picref->linesize,
-                       x0, y0, 0, 0, inlink->w, inlink->h);
+    copy_rectangle(ctx, tile->out_ref, picref,
+                   x0, y0, 0, 0, inlink->w, inlink->h);
 
     av_frame_free(&picref);
     if (++tile->current == tile->nb_frames)
@@ -293,4 +335,5 @@ const AVFilter ff_vf_tile = {
     FILTER_OUTPUTS(tile_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &tile_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -29,6 +29,8 @@
 #include "internal.h"
 #include "video.h"
 
+#define MAX_PARTIAL_SIZE (64 << 20)
+
 enum GraticuleType {
     GRAT_NONE,
     GRAT_GREEN,
@@ -74,10 +76,15 @@ typedef struct VectorscopeContext {
     int flags;
     int colorspace;
     int cs;
+    int step;
     uint8_t *peak_memory;
     uint8_t **peak;
 
-    void (*vectorscope)(struct VectorscopeContext *s,
+    int nb_partials;
+    int nb_acc_jobs;
+    uint16_t *partial;
+
+    void (*vectorscope)(AVFilterContext *ctx,
                         AVFrame *in, AVFrame *out, int pd);
     void (*graticulef)(struct VectorscopeContext *s, AVFrame *out,
                        int X, int Y, int D, int P);
@@ -135,6 +142,7 @@ static const AVOption vectorscope_options[] = {
     { "t0",    "set 1st tint", OFFSET(ftint[0]), AV_OPT_TYPE_FLOAT, {.dbl=0}, -1, 1, TFLAGS},
     { "tint1", "set 2nd tint", OFFSET(ftint[1]), AV_OPT_TYPE_FLOAT, {.dbl=0}, -1, 1, TFLAGS},
     { "t1",    "set 2nd tint", OFFSET(ftint[1]), AV_OPT_TYPE_FLOAT, {.dbl=0}, -1, 1, TFLAGS},
+    { "step", "set pixel and row sampling step", OFFSET(step), AV_OPT_TYPE_INT, {.i64=1}, 1, 64, FLAGS},
     { NULL }
 };
 
@@ -270,7 +278,9 @@ static int query_formats(AVFilterContext *ctx)
 
 static int config_output(AVFilterLink *outlink)
 {
-    VectorscopeContext *s = outlink->src->priv;
+    AVFilterContext *ctx = outlink->src;
+    VectorscopeContext *s = ctx->priv;
+    const size_t partial_size = (size_t)s->size * s->size * sizeof(*s->partial);
     int i;
 
     outlink->h = outlink->w = s->size;
@@ -287,6 +297,13 @@ static int config_output(AVFilterLink *outlink)
     for (i = 0; i < s->size; i++)
         s->peak[i] = s->peak_memory + s->size * i;
 
+    s->nb_partials = FFMIN(ff_filter_get_nb_threads(ctx),
+                           FFMAX(1, MAX_PARTIAL_SIZE / partial_size));
+    av_freep(&s->partial);
+    s->partial = av_calloc(s->nb_partials, partial_size);
+    if (!s->partial)
+        return AVERROR(ENOMEM);
+
     return 0;
 }
 
@@ -414,22 +431,177 @@ static void envelope(VectorscopeContext *s, AVFrame *out)
     }
 }
 
-static void vectorscope16(VectorscopeContext *s, AVFrame *in, AVFrame *out, int pd)
+/*
+ * Every plotting mode is order independent: it either saturates a hit
+ * count, keeps the maximum of the plotted component or only marks the
+ * position. So each job collects its rows into a private plane, which
+ * holds the hit count (or 1 + the maximum for color4), and the planes
+ * are merged into the output afterwards.
+ */
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int pd;
+} ThreadData;
+
+#define ACCUMULATE(name, type)                                                  \
+static int accumulate##name(AVFilterContext *ctx, void *arg,                   \
+                            int jobnr, int nb_jobs)                            \
+{                                                                              \
+    VectorscopeContext *s = ctx->priv;                                         \
+    ThreadData *td = arg;                                                      \
+    AVFrame *in = td->in;                                                      \
+    const int pd = td->pd;                                                     \
+    const int px = s->x, py = s->y;                                            \
+    const int slinesizex = in->linesize[px] / sizeof(type);                    \
+    const int slinesizey = in->linesize[py] / sizeof(type);                    \
+    const int slinesized = in->linesize[pd] / sizeof(type);                    \
+    const type *spx = (const type *)in->data[px];                              \
+    const type *spy = (const type *)in->data[py];                              \
+    const type *spd = (const type *)in->data[pd];                              \
+    const int color4 = s->mode == COLOR4;                                      \
+    const int h = color4 ? in->height : s->planeheight[py];                    \
+    const int w = color4 ? in->width  : s->planewidth[px];                     \
+    const int hsub = color4 ? s->hsub : 0;                                     \
+    const int vsub = color4 ? s->vsub : 0;                                     \
+    const int slice_start = (h *  jobnr   ) / nb_jobs;                         \
+    const int slice_end   = (h * (jobnr+1)) / nb_jobs;                         \
+    const int step = s->step;                                                  \
+    const int size = s->size;                                                  \
+    const int max = size - 1;                                                  \
+    const int tmin = s->tmin;                                                  \
+    const int tmax = s->tmax;                                                  \
+    uint16_t *acc = s->partial + (size_t)jobnr * size * size;                  \
+                                                                               \
+    memset(acc, 0, size * size * sizeof(*acc));                                \
+                                                                               \
+    for (int i = (slice_start + step - 1) / step * step; i < slice_end; i += step) { \
+        const type *sx = spx + (i >> vsub) * slinesizex;                       \
+        const type *sy = spy + (i >> vsub) * slinesizey;                       \
+        const type *sd = spd + i * slinesized;                                 \
+                                                                               \
+        if (color4) {                                                          \
+            for (int j = 0; j < w; j += step) {                                \
+                const int x = FFMIN(sx[j >> hsub], max);                       \
+                const int y = FFMIN(sy[j >> hsub], max);                       \
+                const int z = sd[j];                                           \
+                uint16_t *a = acc + y * size + x;                              \
+                                                                               \
+                if (z < tmin || z > tmax)                                      \
+                    continue;                                                  \
+                                                                               \
+                *a = FFMAX(*a, z + 1);                                         \
+            }                                                                  \
+        } else {                                                               \
+            for (int j = 0; j < w; j += step) {                                \
+                const int x = FFMIN(sx[j], max);                               \
+                const int y = FFMIN(sy[j], max);                               \
+                const int z = sd[j];                                           \
+                uint16_t *a = acc + y * size + x;                              \
+                                                                               \
+                if (z < tmin || z > tmax)                                      \
+                    continue;                                                  \
+                                                                               \
+                *a += *a < UINT16_MAX;                                         \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    return 0;                                                                  \
+}                                                                              \
+                                                                               \
+static int merge##name(AVFilterContext *ctx, void *arg,                        \
+                       int jobnr, int nb_jobs)                                 \
+{                                                                              \
+    VectorscopeContext *s = ctx->priv;                                         \
+    ThreadData *td = arg;                                                      \
+    AVFrame *out = td->out;                                                    \
+    const int pd = td->pd;                                                     \
+    const int size = s->size;                                                  \
+    const int max = size - 1;                                                  \
+    const int mid = size / 2;                                                  \
+    const int dlinesize = out->linesize[0] / sizeof(type);                     \
+    const int slice_start = (size *  jobnr   ) / nb_jobs;                      \
+    const int slice_end   = (size * (jobnr+1)) / nb_jobs;                      \
+    const int64_t intensity = s->intensity * (int64_t)(s->step * s->step);     \
+    const int nb_partials = s->nb_acc_jobs;                                    \
+    type *dpx = (type *)out->data[s->x];                                       \
+    type *dpy = (type *)out->data[s->y];                                       \
+    type *dpd = (type *)out->data[pd];                                         \
+                                                                               \
+    for (int i = slice_start; i < slice_end; i++) {                            \
+        for (int j = 0; j < size; j++) {                                       \
+            const int pos = i * dlinesize + j;                                 \
+            const size_t apos = (size_t)i * size + j;                          \
+            int64_t n = 0;                                                     \
+                                                                               \
+            if (s->mode == COLOR4) {                                           \
+                for (int k = 0; k < nb_partials; k++)                          \
+                    n = FFMAX(n, s->partial[k * (size_t)size * size + apos]);  \
+            } else {                                                           \
+                for (int k = 0; k < nb_partials; k++)                          \
+                    n += s->partial[k * (size_t)size * size + apos];           \
+            }                                                                  \
+            if (!n)                                                            \
+                continue;                                                      \
+                                                                               \
+            switch (s->mode) {                                                 \
+            case COLOR:                                                        \
+            case COLOR5:                                                       \
+            case TINT:                                                         \
+                dpd[pos] = FFMIN(dpd[pos] + n * intensity, max);               \
+                break;                                                         \
+            case COLOR2:                                                       \
+                if (!dpd[pos]) {                                               \
+                    if (s->is_yuv)                                             \
+                        dpd[pos] = FFABS(mid - j) + FFABS(mid - i);            \
+                    else                                                       \
+                        dpd[pos] = FFMIN(j + i, max);                          \
+                }                                                              \
+                dpx[pos] = j;                                                  \
+                dpy[pos] = i;                                                  \
+                break;                                                         \
+            case COLOR3:                                                       \
+                dpd[pos] = FFMIN(dpd[pos] + n * intensity, max);               \
+                dpx[pos] = j;                                                  \
+                dpy[pos] = i;                                                  \
+                break;                                                         \
+            case COLOR4:                                                       \
+                dpd[pos] = FFMAX(n - 1, dpd[pos]);                             \
+                dpx[pos] = j;                                                  \
+                dpy[pos] = i;                                                  \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    return 0;                                                                  \
+}
+
+ACCUMULATE(8,  uint8_t)
+ACCUMULATE(16, uint16_t)
+
+static void plot(AVFilterContext *ctx, AVFrame *in, AVFrame *out, int pd)
 {
-    const uint16_t * const *src = (const uint16_t * const *)in->data;
-    const int slinesizex = in->linesize[s->x] / 2;
-    const int slinesizey = in->linesize[s->y] / 2;
-    const int slinesized = in->linesize[pd] / 2;
+    VectorscopeContext *s = ctx->priv;
+    const int h = s->mode == COLOR4 ? in->height : s->planeheight[s->y];
+    ThreadData td;
+
+    td.in = in;
+    td.out = out;
+    td.pd = pd;
+
+    s->nb_acc_jobs = FFMIN(h, s->nb_partials);
+    ff_filter_execute(ctx, s->size == 256 ? accumulate8 : accumulate16, &td, NULL,
+                      s->nb_acc_jobs);
+    ff_filter_execute(ctx, s->size == 256 ? merge8 : merge16, &td, NULL,
+                      FFMIN(s->size, ff_filter_get_nb_threads(ctx)));
+}
+
+static void vectorscope16(AVFilterContext *ctx, AVFrame *in, AVFrame *out, int pd)
+{
+    VectorscopeContext *s = ctx->priv;
     const int dlinesize = out->linesize[0] / 2;
-    const int intensity = s->intensity;
     const int px = s->x, py = s->y;
-    const int h = s->planeheight[py];
-    const int w = s->planewidth[px];
-    const uint16_t *spx = src[px];
-    const uint16_t *spy = src[py];
-    const uint16_t *spd = src[pd];
-    const int hsub = s->hsub;
-    const int vsub = s->vsub;
     uint16_t **dst = (uint16_t **)out->data;
     uint16_t *dpx = dst[px];
     uint16_t *dpy = dst[py];
@@ -438,8 +610,6 @@ static void vectorscope16(VectorscopeContext *s, AVFrame *in, AVFrame *out, int
     uint16_t *dp2 = dst[2];
     const int max = s->size - 1;
     const int mid = s->size / 2;
-    const int tmin = s->tmin;
-    const int tmax = s->tmax;
     int i, j, k;
 
     for (k = 0; k < 4 && dst[k]; k++) {
@@ -449,113 +619,7 @@ static void vectorscope16(VectorscopeContext *s, AVFrame *in, AVFrame *out, int
                         (s->mode == COLOR || s->mode == COLOR5) && k == s->pd ? 0 : s->bg_color[k]);
     }
 
-    switch (s->mode) {
-    case COLOR:
-    case COLOR5:
-    case TINT:
-        for (i = 0; i < h; i++) {
-            const int iwx = i * slinesizex;
-            const int iwy = i * slinesizey;
-            const int iwd = i * slinesized;
-            for (j = 0; j < w; j++) {
-                const int x = FFMIN(spx[iwx + j], max);
-                const int y = FFMIN(spy[iwy + j], max);
-                const int z = spd[iwd + j];
-                const int pos = y * dlinesize + x;
-
-                if (z < tmin || z > tmax)
-                    continue;
-
-                dpd[pos] = FFMIN(dpd[pos] + intensity, max);
-            }
-        }
-        break;
-    case COLOR2:
-        if (s->is_yuv) {
-            for (i = 0; i < h; i++) {
-                const int iw1 = i * slinesizex;
-                const int iw2 = i * slinesizey;
-                const int iwd = i * slinesized;
-                for (j = 0; j < w; j++) {
-                    const int x = FFMIN(spx[iw1 + j], max);
-                    const int y = FFMIN(spy[iw2 + j], max);
-                    const int z = spd[iwd + j];
-                    const int pos = y * dlinesize + x;
-
-                    if (z < tmin || z > tmax)
-                        continue;
-
-                    if (!dpd[pos])
-                        dpd[pos] = FFABS(mid - x) + FFABS(mid - y);
-                    dpx[pos] = x;
-                    dpy[pos] = y;
-                }
-            }
-        } else {
-            for (i = 0; i < h; i++) {
-                const int iw1 = i * slinesizex;
-                const int iw2 = i * slinesizey;
-                const int iwd = i * slinesized;
-                for (j = 0; j < w; j++) {
-                    const int x = FFMIN(spx[iw1 + j], max);
-                    const int y = FFMIN(spy[iw2 + j], max);
-                    const int z = spd[iwd + j];
-                    const int pos = y * dlinesize + x;
-
-                    if (z < tmin || z > tmax)
-                        continue;
-
-                    if (!dpd[pos])
-                        dpd[pos] = FFMIN(x + y, max);
-                    dpx[pos] = x;
-                    dpy[pos] = y;
-                }
-            }
-        }
-        break;
-    case COLOR3:
-        for (i = 0; i < h; i++) {
-            const int iw1 = i * slinesizex;
-            const int iw2 = i * slinesizey;
-            const int iwd = i * slinesized;
-            for (j = 0; j < w; j++) {
-                const int x = FFMIN(spx[iw1 + j], max);
-                const int y = FFMIN(spy[iw2 + j], max);
-                const int z = spd[iwd + j];
-                const int pos = y * dlinesize + x;
-
-                if (z < tmin || z > tmax)
-                    continue;
-
-                dpd[pos] = FFMIN(max, dpd[pos] + intensity);
-                dpx[pos] = x;
-                dpy[pos] = y;
-            }
-        }
-        break;
-    case COLOR4:
-        for (i = 0; i < in->height; i++) {
-            const int iwx = (i >> vsub) * slinesizex;
-            const int iwy = (i >> vsub) * slinesizey;
-            const int iwd = i * slinesized;
-            for (j = 0; j < in->width; j++) {
-                const int x = FFMIN(spx[iwx + (j >> hsub)], max);
-                const int y = FFMIN(spy[iwy + (j >> hsub)], max);
-                const int z = spd[iwd + j];
-                const int pos = y * dlinesize + x;
-
-                if (z < tmin || z > tmax)
-                    continue;
-
-                dpd[pos] = FFMAX(z, dpd[pos]);
-                dpx[pos] = x;
-                dpy[pos] = y;
-            }
-        }
-        break;
-    default:
-        av_assert0(0);
-    }
+    plot(ctx, in, out, pd);
 
     envelope16(s, out);
 
@@ -614,30 +678,17 @@ static void vectorscope16(VectorscopeContext *s, AVFrame *in, AVFrame *out, int
     }
 }
 
-static void vectorscope8(VectorscopeContext *s, AVFrame *in, AVFrame *out, int pd)
+static void vectorscope8(AVFilterContext *ctx, AVFrame *in, AVFrame *out, int pd)
 {
-    const uint8_t * const *src = (const uint8_t * const *)in->data;
-    const int slinesizex = in->linesize[s->x];
-    const int slinesizey = in->linesize[s->y];
-    const int slinesized = in->linesize[pd];
+    VectorscopeContext *s = ctx->priv;
     const int dlinesize = out->linesize[0];
-    const int intensity = s->intensity;
     const int px = s->x, py = s->y;
-    const int h = s->planeheight[py];
-    const int w = s->planewidth[px];
-    const uint8_t *spx = src[px];
-    const uint8_t *spy = src[py];
-    const uint8_t *spd = src[pd];
-    const int hsub = s->hsub;
-    const int vsub = s->vsub;
     uint8_t **dst = out->data;
     uint8_t *dpx = dst[px];
     uint8_t *dpy = dst[py];
     uint8_t *dpd = dst[pd];
     uint8_t *dp1 = dst[1];
     uint8_t *dp2 = dst[2];
-    const int tmin = s->tmin;
-    const int tmax = s->tmax;
     int i, j, k;
 
     for (k = 0; k < 4 && dst[k]; k++)
@@ -645,113 +696,7 @@ static void vectorscope8(VectorscopeContext *s, AVFrame *in, AVFrame *out, int p
             memset(dst[k] + i * out->linesize[k],
                    (s->mode == COLOR || s->mode == COLOR5) && k == s->pd ? 0 : s->bg_color[k], out->width);
 
-    switch (s->mode) {
-    case COLOR5:
-    case COLOR:
-    case TINT:
-        for (i = 0; i < h; i++) {
-            const int iwx = i * slinesizex;
-            const int iwy = i * slinesizey;
-            const int iwd = i * slinesized;
-            for (j = 0; j < w; j++) {
-                const int x = spx[iwx + j];
-                const int y = spy[iwy + j];
-                const int z = spd[iwd + j];
-                const int pos = y * dlinesize + x;
-
-                if (z < tmin || z > tmax)
-                    continue;
-
-                dpd[pos] = FFMIN(dpd[pos] + intensity, 255);
-            }
-        }
-        break;
-    case COLOR2:
-        if (s->is_yuv) {
-            for (i = 0; i < h; i++) {
-                const int iw1 = i * slinesizex;
-                const int iw2 = i * slinesizey;
-                const int iwd = i * slinesized;
-                for (j = 0; j < w; j++) {
-                    const int x = spx[iw1 + j];
-                    const int y = spy[iw2 + j];
-                    const int z = spd[iwd + j];
-                    const int pos = y * dlinesize + x;
-
-                    if (z < tmin || z > tmax)
-                        continue;
-
-                    if (!dpd[pos])
-                        dpd[pos] = FFABS(128 - x) + FFABS(128 - y);
-                    dpx[pos] = x;
-                    dpy[pos] = y;
-                }
-            }
-        } else {
-            for (i = 0; i < h; i++) {
-                const int iw1 = i * slinesizex;
-                const int iw2 = i * slinesizey;
-                const int iwd = i * slinesized;
-                for (j = 0; j < w; j++) {
-                    const int x = spx[iw1 + j];
-                    const int y = spy[iw2 + j];
-                    const int z = spd[iwd + j];
-                    const int pos = y * dlinesize + x;
-
-                    if (z < tmin || z > tmax)
-                        continue;
-
-                    if (!dpd[pos])
-                        dpd[pos] = FFMIN(x + y, 255);
-                    dpx[pos] = x;
-                    dpy[pos] = y;
-                }
-            }
-        }
-        break;
-    case COLOR3:
-        for (i = 0; i < h; i++) {
-            const int iw1 = i * slinesizex;
-            const int iw2 = i * slinesizey;
-            const int iwd = i * slinesized;
-            for (j = 0; j < w; j++) {
-                const int x = spx[iw1 + j];
-                const int y = spy[iw2 + j];
-                const int z = spd[iwd + j];
-                const int pos = y * dlinesize + x;
-
-                if (z < tmin || z > tmax)
-                    continue;
-
-                dpd[pos] = FFMIN(255, dpd[pos] + intensity);
-                dpx[pos] = x;
-                dpy[pos] = y;
-            }
-        }
-        break;
-    case COLOR4:
-        for (i = 0; i < in->height; i++) {
-            const int iwx = (i >> vsub) * slinesizex;
-            const int iwy = (i >> vsub) * slinesizey;
-            const int iwd = i * slinesized;
-            for (j = 0; j < in->width; j++) {
-                const int x = spx[iwx + (j >> hsub)];
-                const int y = spy[iwy + (j >> hsub)];
-                const int z = spd[iwd + j];
-                const int pos = y * dlinesize + x;
-
-                if (z < tmin || z > tmax)
-                    continue;
-
-                dpd[pos] = FFMAX(z, dpd[pos]);
-                dpx[pos] = x;
-                dpy[pos] = y;
-            }
-        }
-        break;
-    default:
-        av_assert0(0);
-    }
+    plot(ctx, in, out, pd);
 
     envelope(s, out);
 
@@ -1470,7 +1415,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    s->vectorscope(s, in, out, s->pd);
+    s->vectorscope(ctx, in, out, s->pd);
     s->graticulef(s, out, s->x, s->y, s->pd, s->cs);
 
     for (plane = 0; plane < 4; plane++) {
@@ -1568,6 +1513,7 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_freep(&s->peak);
     av_freep(&s->peak_memory);
+    av_freep(&s->partial);
 }
 
 static const AVFilterPad inputs[] = {
@@ -1596,5 +1542,6 @@ const AVFilter ff_vf_vectorscope = {
     FILTER_INPUTS(inputs),
     FILTER_OUTPUTS(outputs),
     FILTER_QUERY_FUNC(query_formats),
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
     .process_command = ff_filter_process_command,
 };
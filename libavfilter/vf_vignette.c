@@ -67,6 +67,8 @@ typedef struct VignetteContext {
     double var_values[VAR_NB];
     float *fmap;
     int fmap_linesize;
+    int fmap_valid;
+    double fmap_angle, fmap_x0, fmap_y0; ///< parameters fmap was built for
     double dmax;
     float xscale, yscale;
     uint32_t dither;
@@ -75,6 +77,11 @@ typedef struct VignetteContext {
     AVRational scale;
 } VignetteContext;
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    uint32_t dither;
+} ThreadData;
+
 #define OFFSET(x) offsetof(VignetteContext, x)
 #define FLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_VIDEO_PARAM
 static const AVOption vignette_options[] = {
@@ -146,11 +153,30 @@ static double get_natural_factor(const VignetteContext *s, int x, int y)
     }
 }
 
+static int build_fmap(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VignetteContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+    const int slice_start = (inlink->h *  jobnr   ) / nb_jobs;
+    const int slice_end   = (inlink->h * (jobnr+1)) / nb_jobs;
+    float *dst = s->fmap + slice_start * s->fmap_linesize;
+
+    for (int y = slice_start; y < slice_end; y++) {
+        if (s->backward) {
+            for (int x = 0; x < inlink->w; x++)
+                dst[x] = 1. / get_natural_factor(s, x, y);
+        } else {
+            for (int x = 0; x < inlink->w; x++)
+                dst[x] = get_natural_factor(s, x, y);
+        }
+        dst += s->fmap_linesize;
+    }
+    return 0;
+}
+
 static void update_context(VignetteContext *s, AVFilterLink *inlink, AVFrame *frame)
 {
-    int x, y;
-    float *dst = s->fmap;
-    int dst_linesize = s->fmap_linesize;
+    AVFilterContext *ctx = inlink->dst;
 
     if (frame) {
         s->var_values[VAR_N]   = inlink->frame_count_out;
@@ -171,72 +197,98 @@ static void update_context(VignetteContext *s, AVFilterLink *inlink, AVFrame *fr
 
     s->angle = av_clipf(s->angle, 0, M_PI_2);
 
-    if (s->backward) {
-        for (y = 0; y < inlink->h; y++) {
-            for (x = 0; x < inlink->w; x++)
-                dst[x] = 1. / get_natural_factor(s, x, y);
-            dst += dst_linesize;
-        }
-    } else {
-        for (y = 0; y < inlink->h; y++) {
-            for (x = 0; x < inlink->w; x++)
-                dst[x] = get_natural_factor(s, x, y);
-            dst += dst_linesize;
-        }
-    }
+    /* per-frame expressions are often constant, keep the map if so */
+    if (s->fmap_valid && s->fmap_angle == s->angle &&
+        s->fmap_x0 == s->x0 && s->fmap_y0 == s->y0)
+        return;
+
+    ff_filter_execute(ctx, build_fmap, NULL, NULL,
+                      FFMIN(inlink->h, ff_filter_get_nb_threads(ctx)));
+    s->fmap_angle = s->angle;
+    s->fmap_x0    = s->x0;
+    s->fmap_y0    = s->y0;
+    s->fmap_valid = 1;
 }
 
-static inline double get_dither_value(VignetteContext *s)
+static inline double get_dither_value(const VignetteContext *s, uint32_t *dither)
 {
     double dv = 0;
     if (s->do_dither) {
-        dv = s->dither / (double)(1LL<<32);
-        s->dither = s->dither * 1664525 + 1013904223;
+        dv = *dither / (double)(1LL<<32);
+        *dither = *dither * 1664525 + 1013904223;
     }
     return dv;
 }
 
-static int filter_frame(AVFilterLink *inlink, AVFrame *in)
+/**
+ * Return the dither state after n more get_dither_value() calls, so that
+ * each slice can start where a single-threaded walk would have been.
+ */
+static uint32_t dither_skip(const VignetteContext *s, uint32_t state, uint64_t n)
 {
-    unsigned x, y, direct = 0;
-    AVFilterContext *ctx = inlink->dst;
-    VignetteContext *s = ctx->priv;
-    AVFilterLink *outlink = ctx->outputs[0];
-    AVFrame *out;
+    uint32_t mul = 1664525, add = 1013904223;
 
-    if (av_frame_is_writable(in)) {
-        direct = 1;
-        out = in;
-    } else {
-        out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
-        if (!out) {
-            av_frame_free(&in);
-            return AVERROR(ENOMEM);
-        }
-        av_frame_copy_props(out, in);
+    if (!s->do_dither)
+        return state;
+
+    while (n) {
+        if (n & 1)
+            state = state * mul + add;
+        add *= mul + 1;
+        mul *= mul;
+        n >>= 1;
+    }
+    return state;
+}
+
+/* number of dither values consumed by the planes before plane_end */
+static uint64_t nb_dither_values(const VignetteContext *s, const AVFrame *in, int plane_end)
+{
+    uint64_t n = 0;
+    int plane;
+
+    if (s->desc->flags & AV_PIX_FMT_FLAG_RGB)
+        return 3ULL * in->width * in->height;
+
+    for (plane = 0; plane < plane_end && in->data[plane] && in->linesize[plane]; plane++) {
+        const int chroma = plane == 1 || plane == 2;
+        const int hsub = chroma ? s->desc->log2_chroma_w : 0;
+        const int vsub = chroma ? s->desc->log2_chroma_h : 0;
+
+        n += (uint64_t)AV_CEIL_RSHIFT(in->width, hsub) * AV_CEIL_RSHIFT(in->height, vsub);
     }
+    return n;
+}
 
-    if (s->eval_mode == EVAL_MODE_FRAME)
-        update_context(s, inlink, in);
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VignetteContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in  = td->in;
+    AVFrame *out = td->out;
+    unsigned x, y;
 
     if (s->desc->flags & AV_PIX_FMT_FLAG_RGB) {
-        uint8_t       *dst = out->data[0];
-        const uint8_t *src = in ->data[0];
-        const float *fmap = s->fmap;
+        const int slice_start = (in->height *  jobnr   ) / nb_jobs;
+        const int slice_end   = (in->height * (jobnr+1)) / nb_jobs;
         const int dst_linesize = out->linesize[0];
         const int src_linesize = in ->linesize[0];
         const int fmap_linesize = s->fmap_linesize;
+        uint8_t       *dst = out->data[0] + slice_start * dst_linesize;
+        const uint8_t *src = in ->data[0] + slice_start * src_linesize;
+        const float *fmap = s->fmap + slice_start * fmap_linesize;
+        uint32_t dither = dither_skip(s, td->dither, 3ULL * in->width * slice_start);
 
-        for (y = 0; y < inlink->h; y++) {
+        for (y = slice_start; y < slice_end; y++) {
             uint8_t       *dstp = dst;
             const uint8_t *srcp = src;
 
-            for (x = 0; x < inlink->w; x++, dstp += 3, srcp += 3) {
+            for (x = 0; x < in->width; x++, dstp += 3, srcp += 3) {
                 const float f = fmap[x];
 
-                dstp[0] = av_clip_uint8(srcp[0] * f + get_dither_value(s));
-                dstp[1] = av_clip_uint8(srcp[1] * f + get_dither_value(s));
-                dstp[2] = av_clip_uint8(srcp[2] * f + get_dither_value(s));
+                dstp[0] = av_clip_uint8(srcp[0] * f + get_dither_value(s, &dither));
+                dstp[1] = av_clip_uint8(srcp[1] * f + get_dither_value(s, &dither));
+                dstp[2] = av_clip_uint8(srcp[2] * f + get_dither_value(s, &dither));
             }
             dst += dst_linesize;
             src += src_linesize;
@@ -246,24 +298,29 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         int plane;
 
         for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
-            uint8_t       *dst = out->data[plane];
-            const uint8_t *src = in ->data[plane];
-            const float *fmap = s->fmap;
             const int dst_linesize = out->linesize[plane];
             const int src_linesize = in ->linesize[plane];
             const int fmap_linesize = s->fmap_linesize;
             const int chroma = plane == 1 || plane == 2;
             const int hsub = chroma ? s->desc->log2_chroma_w : 0;
             const int vsub = chroma ? s->desc->log2_chroma_h : 0;
-            const int w = AV_CEIL_RSHIFT(inlink->w, hsub);
-            const int h = AV_CEIL_RSHIFT(inlink->h, vsub);
-
-            for (y = 0; y < h; y++) {
+            const int w = AV_CEIL_RSHIFT(in->width,  hsub);
+            const int h = AV_CEIL_RSHIFT(in->height, vsub);
+            const int slice_start = (h *  jobnr   ) / nb_jobs;
+            const int slice_end   = (h * (jobnr+1)) / nb_jobs;
+            uint8_t       *dst = out->data[plane] + slice_start * dst_linesize;
+            const uint8_t *src = in ->data[plane] + slice_start * src_linesize;
+            const float *fmap = s->fmap + (slice_start << vsub) * fmap_linesize;
+            uint32_t dither = dither_skip(s, td->dither,
+                                          nb_dither_values(s, in, plane) +
+                                          (uint64_t)w * slice_start);
+
+            for (y = slice_start; y < slice_end; y++) {
                 uint8_t *dstp = dst;
                 const uint8_t *srcp = src;
 
                 for (x = 0; x < w; x++) {
-                    const double dv = get_dither_value(s);
+                    const double dv = get_dither_value(s, &dither);
                     if (chroma) *dstp++ = av_clip_uint8(fmap[x << hsub] * (*srcp++ - 127) + 127 + dv);
                     else        *dstp++ = av_clip_uint8(fmap[x        ] *  *srcp++              + dv);
                 }
@@ -274,6 +331,40 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         }
     }
 
+    return 0;
+}
+
+static int filter_frame(AVFilterLink *inlink, AVFrame *in)
+{
+    unsigned direct = 0;
+    AVFilterContext *ctx = inlink->dst;
+    VignetteContext *s = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
+    ThreadData td;
+    AVFrame *out;
+
+    if (av_frame_is_writable(in)) {
+        direct = 1;
+        out = in;
+    } else {
+        out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!out) {
+            av_frame_free(&in);
+            return AVERROR(ENOMEM);
+        }
+        av_frame_copy_props(out, in);
+    }
+
+    if (s->eval_mode == EVAL_MODE_FRAME)
+        update_context(s, inlink, in);
+
+    td.in     = in;
+    td.out    = out;
+    td.dither = s->dither;
+    ff_filter_execute(ctx, filter_slice, &td, NULL,
+                      FFMIN(inlink->h, ff_filter_get_nb_threads(ctx)));
+    s->dither = dither_skip(s, s->dither, nb_dither_values(s, in, 4));
+
     if (!direct)
         av_frame_free(&in);
     return ff_filter_frame(outlink, out);
@@ -304,6 +395,7 @@ static int config_props(AVFilterLink *inlink)
     av_log(s, AV_LOG_DEBUG, "xscale=%f yscale=%f dmax=%f\n",
            s->xscale, s->yscale, s->dmax);
 
+    s->fmap_valid = 0;
     s->fmap_linesize = FFALIGN(inlink->w, 32);
     s->fmap = av_malloc_array(s->fmap_linesize, inlink->h * sizeof(*s->fmap));
     if (!s->fmap)
@@ -334,5 +426,5 @@ const AVFilter ff_vf_vignette = {
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
     .priv_class    = &vignette_class,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -174,6 +174,7 @@ struct AVExpr {
     } a;
     struct AVExpr *param[3];
     double *var;
+    struct ExprProgram *prog;
 };
 
 static double etime(double v)
@@ -332,6 +333,7 @@ static double eval_expr(Parser *p, AVExpr *e)
 }
 
 static int parse_expr(AVExpr **e, Parser *p);
+static void free_program(struct ExprProgram *prog);
 
 void av_expr_free(AVExpr *e)
 {
@@ -340,6 +342,7 @@ void av_expr_free(AVExpr *e)
     av_expr_free(e->param[1]);
     av_expr_free(e->param[2]);
     av_freep(&e->var);
+    free_program(e->prog);
     av_freep(&e);
 }
 
@@ -773,6 +776,305 @@ double av_expr_eval(AVExpr *e, const double *const_values, void *opaque)
     return eval_expr(&p, e);
 }
 
+/* Number of elements every instruction of a compiled expression handles at once */
+#define BATCH_SIZE 64
+
+enum {
+    EXPR_VARYING  = 1, ///< depends on a value passed as an array
+    EXPR_STATEFUL = 2, ///< reads or writes the variables, or is not deterministic
+};
+
+enum {
+    INSN_UNIFORM, ///< broadcast a value computed once per call
+    INSN_LOAD,    ///< load an identifier passed as an array
+    INSN_OP,      ///< apply the operation of the node to its operand registers
+};
+
+typedef struct ExprInsn {
+    const AVExpr *e;
+    int kind;
+    int index;
+    int dst;
+    int src[3];
+} ExprInsn;
+
+typedef struct ExprProgram {
+    int max_const;              ///< highest identifier index used by the expression
+    int stateful;
+    uint64_t varying;           ///< identifiers the instructions were compiled for
+    ExprInsn *insns;
+    int nb_insns;
+    AVExpr **uniforms;
+    double *uniform_values;
+    int nb_uniforms;
+    double *regs;
+    double **reg_ptrs;
+    int nb_regs;
+    double *values;             ///< const_values copy for element by element evaluation
+} ExprProgram;
+
+static void free_program(ExprProgram *prog)
+{
+    if (!prog)
+        return;
+    av_freep(&prog->insns);
+    av_freep(&prog->uniforms);
+    av_freep(&prog->uniform_values);
+    av_freep(&prog->regs);
+    av_freep(&prog->reg_ptrs);
+    av_freep(&prog->values);
+    av_free(prog);
+}
+
+static void analyze_expr(const AVExpr *e, int *nb_nodes, int *max_const, int *stateful)
+{
+    int i;
+
+    (*nb_nodes)++;
+    switch (e->type) {
+    case e_const:
+        *max_const = FFMAX(*max_const, e->const_index);
+        break;
+    case e_func0:
+        if (e->a.func0 == etime)
+            *stateful = 1;
+        break;
+    case e_ld: case e_st: case e_random: case e_while:
+    case e_taylor: case e_root: case e_print:
+        *stateful = 1;
+        break;
+    }
+    for (i = 0; i < 3 && e->param[i]; i++)
+        analyze_expr(e->param[i], nb_nodes, max_const, stateful);
+}
+
+static int is_varying(const AVExpr *e, uint64_t varying)
+{
+    int i;
+
+    if (e->type == e_const)
+        return varying >> e->const_index & 1;
+    for (i = 0; i < 3 && e->param[i]; i++)
+        if (is_varying(e->param[i], varying))
+            return 1;
+    return 0;
+}
+
+/**
+ * Flatten the tree into a list of instructions computing e into register reg.
+ * Operands of a node go to consecutive registers starting at reg, so a
+ * register is only live while the subtrees after it are computed.
+ */
+static void compile_expr(ExprProgram *prog, AVExpr *e, int reg)
+{
+    ExprInsn *insn;
+    int i, src[3] = { -1, -1, -1 };
+
+    prog->nb_regs = FFMAX(prog->nb_regs, reg + 1);
+
+    if (!is_varying(e, prog->varying)) {
+        insn = &prog->insns[prog->nb_insns++];
+        insn->kind  = INSN_UNIFORM;
+        insn->index = prog->nb_uniforms;
+        prog->uniforms[prog->nb_uniforms++] = e;
+    } else if (e->type == e_const) {
+        insn = &prog->insns[prog->nb_insns++];
+        insn->kind  = INSN_LOAD;
+        insn->index = e->const_index;
+    } else {
+        for (i = 0; i < 3 && e->param[i]; i++) {
+            compile_expr(prog, e->param[i], reg + i);
+            src[i] = reg + i;
+        }
+        insn = &prog->insns[prog->nb_insns++];
+        insn->kind = INSN_OP;
+    }
+    insn->e   = e;
+    insn->dst = reg;
+    memcpy(insn->src, src, sizeof(src));
+}
+
+static int init_program(AVExpr *e)
+{
+    ExprProgram *prog = av_mallocz(sizeof(*prog));
+    int nb_nodes = 0;
+
+    if (!prog)
+        return AVERROR(ENOMEM);
+
+    prog->max_const = -1;
+    analyze_expr(e, &nb_nodes, &prog->max_const, &prog->stateful);
+
+    prog->insns          = av_malloc_array(nb_nodes, sizeof(*prog->insns));
+    prog->uniforms       = av_malloc_array(nb_nodes, sizeof(*prog->uniforms));
+    prog->uniform_values = av_malloc_array(nb_nodes, sizeof(*prog->uniform_values));
+    prog->reg_ptrs       = av_malloc_array(nb_nodes, sizeof(*prog->reg_ptrs));
+    prog->values         = av_malloc_array(prog->max_const + 1, sizeof(*prog->values));
+    if (!prog->insns || !prog->uniforms || !prog->uniform_values ||
+        !prog->reg_ptrs || !prog->values) {
+        free_program(prog);
+        return AVERROR(ENOMEM);
+    }
+    /* too many identifiers for the mask, or the order of evaluation matters */
+    if (prog->max_const >= 64)
+        prog->stateful = 1;
+
+    e->prog = prog;
+    return 0;
+}
+
+static int compile_program(ExprProgram *prog, AVExpr *e, uint64_t varying)
+{
+    int i;
+
+    prog->varying     = varying;
+    prog->nb_insns    = 0;
+    prog->nb_uniforms = 0;
+    prog->nb_regs     = 0;
+    compile_expr(prog, e, 0);
+
+    av_freep(&prog->regs);
+    /* register 0 is the output array */
+    if (prog->nb_regs > 1) {
+        prog->regs = av_malloc_array(prog->nb_regs - 1, BATCH_SIZE * sizeof(*prog->regs));
+        if (!prog->regs) {
+            prog->varying = 0;
+            prog->nb_insns = 0;
+            return AVERROR(ENOMEM);
+        }
+    }
+    for (i = 1; i < prog->nb_regs; i++)
+        prog->reg_ptrs[i] = prog->regs + (i - 1) * BATCH_SIZE;
+
+    return 0;
+}
+
+#define LOOP(expr)                  \
+    for (k = 0; k < n; k++)         \
+        d[k] = expr
+
+static void run_insn(Parser *p, const ExprProgram *prog, const ExprInsn *insn,
+                     const double * const *const_arrays, int off, int n)
+{
+    const AVExpr *e = insn->e;
+    const double v = e->value;
+    double *d = prog->reg_ptrs[insn->dst];
+    const double *a = insn->src[0] >= 0 ? prog->reg_ptrs[insn->src[0]] : NULL;
+    const double *b = insn->src[1] >= 0 ? prog->reg_ptrs[insn->src[1]] : NULL;
+    const double *c = insn->src[2] >= 0 ? prog->reg_ptrs[insn->src[2]] : NULL;
+    int k;
+
+    if (insn->kind == INSN_UNIFORM) {
+        const double u = prog->uniform_values[insn->index];
+        LOOP(u);
+        return;
+    } else if (insn->kind == INSN_LOAD) {
+        const double *s = const_arrays[insn->index] + off;
+        LOOP(v * s[k]);
+        return;
+    }
+
+    switch (e->type) {
+    case e_func0:  LOOP(v * e->a.func0(a[k]));                           break;
+    case e_func1:  LOOP(v * e->a.func1(p->opaque, a[k]));                break;
+    case e_func2:  LOOP(v * e->a.func2(p->opaque, a[k], b[k]));          break;
+    case e_squish: LOOP(1/(1+exp(4*a[k])));                              break;
+    case e_gauss:  LOOP(exp(-a[k]*a[k]/2)/sqrt(2*M_PI));                 break;
+    case e_isnan:  LOOP(v * !!isnan(a[k]));                              break;
+    case e_isinf:  LOOP(v * !!isinf(a[k]));                              break;
+    case e_floor:  LOOP(v * floor(a[k]));                                break;
+    case e_ceil :  LOOP(v * ceil (a[k]));                                break;
+    case e_trunc:  LOOP(v * trunc(a[k]));                                break;
+    case e_round:  LOOP(v * round(a[k]));                                break;
+    case e_sgn:    LOOP(v * FFDIFFSIGN(a[k], 0));                        break;
+    case e_sqrt:   LOOP(v * sqrt (a[k]));                                break;
+    case e_not:    LOOP(v * (a[k] == 0));                                break;
+    case e_if:     LOOP(v * (a[k]  ? b[k] : c ? c[k] : 0));              break;
+    case e_ifnot:  LOOP(v * (!a[k] ? b[k] : c ? c[k] : 0));              break;
+    case e_clip:
+        LOOP(isnan(b[k]) || isnan(c[k]) || isnan(a[k]) || b[k] > c[k] ?
+             NAN : v * av_clipd(a[k], b[k], c[k]));
+        break;
+    case e_between:LOOP(v * (a[k] >= b[k] && a[k] <= c[k]));             break;
+    case e_lerp:   LOOP(a[k] + (b[k] - a[k]) * c[k]);                    break;
+    case e_mod:    LOOP(v * (a[k] - floor(b[k] ? a[k] / b[k] : a[k] * INFINITY) * b[k])); break;
+    case e_gcd:    LOOP(v * av_gcd(a[k], b[k]));                         break;
+    case e_max:    LOOP(v * (a[k] >  b[k] ? a[k] : b[k]));               break;
+    case e_min:    LOOP(v * (a[k] <  b[k] ? a[k] : b[k]));               break;
+    case e_eq:     LOOP(v * (a[k] == b[k] ? 1.0 : 0.0));                 break;
+    case e_gt:     LOOP(v * (a[k] >  b[k] ? 1.0 : 0.0));                 break;
+    case e_gte:    LOOP(v * (a[k] >= b[k] ? 1.0 : 0.0));                 break;
+    case e_lt:     LOOP(v * (a[k] <  b[k] ? 1.0 : 0.0));                 break;
+    case e_lte:    LOOP(v * (a[k] <= b[k] ? 1.0 : 0.0));                 break;
+    case e_pow:    LOOP(v * pow(a[k], b[k]));                            break;
+    case e_mul:    LOOP(v * (a[k] * b[k]));                              break;
+    case e_div:    LOOP(v * (b[k] ? (a[k] / b[k]) : a[k] * INFINITY));   break;
+    case e_add:    LOOP(v * (a[k] + b[k]));                              break;
+    case e_last:   LOOP(v * b[k]);                                       break;
+    case e_hypot:  LOOP(v * hypot(a[k], b[k]));                          break;
+    case e_atan2:  LOOP(v * atan2(a[k], b[k]));                          break;
+    case e_bitand:
+        LOOP(isnan(a[k]) || isnan(b[k]) ? NAN : v * ((long int)a[k] & (long int)b[k]));
+        break;
+    case e_bitor:
+        LOOP(isnan(a[k]) || isnan(b[k]) ? NAN : v * ((long int)a[k] | (long int)b[k]));
+        break;
+    default:       LOOP(NAN);                                            break;
+    }
+}
+
+int av_expr_eval_batch(AVExpr *e, double *res, int nb,
+                       const double *const_values, const double * const *const_arrays,
+                       void *opaque)
+{
+    Parser p = { 0 };
+    ExprProgram *prog;
+    uint64_t varying = 0;
+    int i, k, off, ret;
+
+    if (!e->prog && (ret = init_program(e)) < 0)
+        return ret;
+    prog = e->prog;
+
+    p.var          = e->var;
+    p.const_values = const_values;
+    p.opaque       = opaque;
+
+    if (prog->stateful) {
+        for (i = 0; i <= prog->max_const; i++)
+            if (!const_arrays || !const_arrays[i])
+                prog->values[i] = const_values[i];
+        p.const_values = prog->values;
+        for (k = 0; k < nb; k++) {
+            for (i = 0; i <= prog->max_const; i++)
+                if (const_arrays && const_arrays[i])
+                    prog->values[i] = const_arrays[i][k];
+            res[k] = eval_expr(&p, e);
+        }
+        return 0;
+    }
+
+    for (i = 0; i <= prog->max_const; i++)
+        if (const_arrays && const_arrays[i])
+            varying |= UINT64_C(1) << i;
+    if ((!prog->nb_insns || varying != prog->varying) &&
+        (ret = compile_program(prog, e, varying)) < 0)
+        return ret;
+
+    for (i = 0; i < prog->nb_uniforms; i++)
+        prog->uniform_values[i] = eval_expr(&p, prog->uniforms[i]);
+
+    for (off = 0; off < nb; off += BATCH_SIZE) {
+        const int n = FFMIN(BATCH_SIZE, nb - off);
+
+        prog->reg_ptrs[0] = res + off;
+        for (i = 0; i < prog->nb_insns; i++)
+            run_insn(&p, prog, &prog->insns[i], const_arrays, off, n);
+    }
+
+    return 0;
+}
+
 int av_expr_parse_and_eval(double *d, const char *s,
                            const char * const *const_names, const double *const_values,
                            const char * const *func1_names, double (* const *funcs1)(void *, double),
@@ -87,6 +87,34 @@ int av_expr_parse(AVExpr **expr, const char *s,
  */
 double av_expr_eval(AVExpr *e, const double *const_values, void *opaque);
 
+/**
+ * Evaluate a previously parsed expression for a batch of identifier values.
+ *
+ * This is equivalent to calling av_expr_eval() nb times, where in the k-th
+ * evaluation every identifier i with a non-NULL const_arrays[i] takes the
+ * value const_arrays[i][k] instead of const_values[i]. Subexpressions that
+ * do not depend on any of the arrays are evaluated once per call, the rest
+ * is evaluated one operation at a time over the whole batch. The functions
+ * passed to av_expr_parse() must thus give the same result regardless of
+ * the order they are called in.
+ *
+ * Expressions using ld(), st(), random() or the other stateful functions
+ * are evaluated element by element in order.
+ *
+ * @param e the AVExpr to evaluate, must not be evaluated concurrently
+ * @param res array where the nb results are stored
+ * @param nb number of evaluations
+ * @param const_values array of values for the identifiers from av_expr_parse() const_names
+ * @param const_arrays array with one entry per identifier from const_names, each
+ *                     either NULL or pointing to nb values for that identifier;
+ *                     may be NULL if no identifier varies
+ * @param opaque a pointer which will be passed to all functions from funcs1 and funcs2
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int av_expr_eval_batch(AVExpr *e, double *res, int nb,
+                       const double *const_values, const double * const *const_arrays,
+                       void *opaque);
+
 /**
  * Track the presence of variables and their number of occurrences in a parsed expression
  *
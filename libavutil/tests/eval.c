@@ -37,6 +37,38 @@ static const char *const const_names[] = {
     0
 };
 
+static const char *const batch_names[] = {
+    "X",
+    "Y",
+    0
+};
+
+static int check_batch(const char *s)
+{
+    AVExpr *e = NULL, *e_ref = NULL;
+    double xs[100], res[100], values[2] = { 0, 7 };
+    const double *arrays[2] = { xs, NULL };
+    int i, ret;
+
+    if ((ret = av_expr_parse(&e,     s, batch_names, NULL, NULL, NULL, NULL, 0, NULL)) < 0 ||
+        (ret = av_expr_parse(&e_ref, s, batch_names, NULL, NULL, NULL, NULL, 0, NULL)) < 0)
+        goto end;
+    for (i = 0; i < 100; i++)
+        xs[i] = (i - 50) * 0.75;
+    ret = av_expr_eval_batch(e, res, 100, values, arrays, NULL);
+    for (i = 0; ret >= 0 && i < 100; i++) {
+        double d;
+        values[0] = xs[i];
+        d = av_expr_eval(e_ref, values, NULL);
+        if (!(d == res[i] || isnan(d) && isnan(res[i])))
+            ret = -1;
+    }
+end:
+    av_expr_free(e);
+    av_expr_free(e_ref);
+    return ret;
+}
+
 int main(int argc, char **argv)
 {
     int i;
@@ -155,6 +187,26 @@ int main(int argc, char **argv)
             printf("av_expr_parse_and_eval failed\n");
     }
 
+    {
+        static const char *const batch_exprs[] = {
+            "X",
+            "-X*Y+1",
+            "Y*Y-3",
+            "if(gt(X,0), X/Y, -X)",
+            "ifnot(X, 1)+between(X, -2, 2)",
+            "clip(X, -Y, Y)*mod(X, 3)",
+            "hypot(X, Y)+atan2(X, Y)+pow(abs(X), 0.5)",
+            "lerp(X, Y, 0.25)+squish(X)+gauss(X)",
+            "st(0, ld(0)+X); ld(0)",
+            NULL
+        };
+
+        for (expr = batch_exprs; *expr; expr++)
+            printf("Batch evaluating '%s' -> %s\n", *expr,
+                   check_batch(*expr) < 0 ? "mismatch" : "ok");
+        printf("\n");
+    }
+
     ret = av_expr_parse_and_eval(&d, "1+(5-2)^(3-1)+1/2+sin(PI)-max(-2.2,-3.1)",
                            const_names, const_values,
                            NULL, NULL, NULL, NULL, NULL, 0, NULL);
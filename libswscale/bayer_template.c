@@ -185,10 +185,13 @@
 #endif
 
 /**
- * invoke ff_rgb24toyv12 for 2x2 pixels
+ * invoke ff_rgb24toyv12 for a 2 lines high block of rgb24 pixels
  */
-#define rgb24toyv12_2x2(src, dstY, dstU, dstV, luma_stride, src_stride, rgb2yuv) \
-    ff_rgb24toyv12(src, dstY, dstV, dstU, 2, 2, luma_stride, 0, src_stride, rgb2yuv)
+#define rgb24toyv12_2xN(src, dstY, dstU, dstV, width, luma_stride, src_stride, rgb2yuv) \
+    ff_rgb24toyv12(src, dstY, dstV, dstU, width, 2, luma_stride, 0, src_stride, rgb2yuv)
+
+/* number of pixels demosaiced at once before the conversion to yv12 */
+#define BAYER_YV12_BLOCK 64
 
 static void BAYER_RENAME(rgb24_copy)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width)
 {
@@ -255,46 +258,92 @@ static void BAYER_RENAME(rgb48_interpolate)(const uint8_t *src, int src_stride,
 
 static void BAYER_RENAME(yv12_copy)(const uint8_t *src, int src_stride, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, int luma_stride, int width, int32_t *rgb2yuv)
 {
-    uint8_t dst[12];
-    const int dst_stride = 6;
-    int i;
+    uint8_t buf[2 * 3 * BAYER_YV12_BLOCK];
+    const int dst_stride = 3 * BAYER_YV12_BLOCK;
+    uint8_t *dst = buf;
+    int i, start = 0;
+
     for (i = 0 ; i < width; i+= 2) {
         BAYER_TO_RGB24_COPY
-        rgb24toyv12_2x2(dst, dstY, dstU, dstV, luma_stride, dst_stride, rgb2yuv);
-        src  += 2 * BAYER_SIZEOF;
-        dstY += 2;
-        dstU++;
-        dstV++;
+        src += 2 * BAYER_SIZEOF;
+        dst += 6;
+        if (i + 2 - start == BAYER_YV12_BLOCK || i + 2 >= width) {
+            rgb24toyv12_2xN(buf, dstY + start, dstU + start / 2, dstV + start / 2,
+                            i + 2 - start, luma_stride, dst_stride, rgb2yuv);
+            dst   = buf;
+            start = i + 2;
+        }
     }
 }
 
 static void BAYER_RENAME(yv12_interpolate)(const uint8_t *src, int src_stride, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, int luma_stride, int width, int32_t *rgb2yuv)
 {
-    uint8_t dst[12];
-    const int dst_stride = 6;
-    int i;
+    uint8_t buf[2 * 3 * BAYER_YV12_BLOCK];
+    const int dst_stride = 3 * BAYER_YV12_BLOCK;
+    uint8_t *dst = buf;
+    int i, start = 0;
 
-    BAYER_TO_RGB24_COPY
-    rgb24toyv12_2x2(dst, dstY, dstU, dstV, luma_stride, dst_stride, rgb2yuv);
-    src  += 2 * BAYER_SIZEOF;
-    dstY += 2;
-    dstU++;
-    dstV++;
+    for (i = 0 ; i < width; i+= 2) {
+        if (i == 0 || i + 2 >= width) {
+            BAYER_TO_RGB24_COPY
+        } else {
+            BAYER_TO_RGB24_INTERPOLATE
+        }
+        src += 2 * BAYER_SIZEOF;
+        dst += 6;
+        if (i + 2 - start == BAYER_YV12_BLOCK || i + 2 >= width) {
+            rgb24toyv12_2xN(buf, dstY + start, dstU + start / 2, dstV + start / 2,
+                            i + 2 - start, luma_stride, dst_stride, rgb2yuv);
+            dst   = buf;
+            start = i + 2;
+        }
+    }
+}
 
-    for (i = 2 ; i < width - 2; i+= 2) {
-        BAYER_TO_RGB24_INTERPOLATE
-        rgb24toyv12_2x2(dst, dstY, dstU, dstV, luma_stride, dst_stride, rgb2yuv);
+/* R() and B() follow the BGGR layout, with BAYER_R/BAYER_B swapping them */
+#undef R
+#undef G
+#undef B
+#if BAYER_R == 0
+#define R(y, x) dstR[(y)*stride_r + (x)]
+#define B(y, x) dstB[(y)*stride_b + (x)]
+#else
+#define R(y, x) dstB[(y)*stride_b + (x)]
+#define B(y, x) dstR[(y)*stride_r + (x)]
+#endif
+#define G(y, x) dstG[(y)*stride_g + (x)]
+
+static void BAYER_RENAME(gbrp_copy)(const uint8_t *src, int src_stride, uint8_t *dst[3], const int dst_stride[3], int width)
+{
+    uint8_t *dstG = dst[0], *dstB = dst[1], *dstR = dst[2];
+    const int stride_g = dst_stride[0], stride_b = dst_stride[1], stride_r = dst_stride[2];
+    int i;
+
+    for (i = 0 ; i < width; i+= 2) {
+        BAYER_TO_RGB24_COPY
         src  += 2 * BAYER_SIZEOF;
-        dstY += 2;
-        dstU++;
-        dstV++;
+        dstG += 2;
+        dstB += 2;
+        dstR += 2;
     }
+}
 
-    if (width > 2) {
-        BAYER_TO_RGB24_COPY
-        rgb24toyv12_2x2(dst, dstY, dstU, dstV, luma_stride, dst_stride, rgb2yuv);
+#if BAYER_SIZEOF == 2
+static void BAYER_RENAME(gbrp16_copy)(const uint8_t *src, int src_stride, uint8_t *dst[3], const int dst_stride[3], int width)
+{
+    uint16_t *dstG = (uint16_t *)dst[0], *dstB = (uint16_t *)dst[1], *dstR = (uint16_t *)dst[2];
+    const int stride_g = dst_stride[0] / 2, stride_b = dst_stride[1] / 2, stride_r = dst_stride[2] / 2;
+    int i;
+
+    for (i = 0 ; i < width; i+= 2) {
+        BAYER_TO_RGB48_COPY
+        src  += 2 * BAYER_SIZEOF;
+        dstG += 2;
+        dstB += 2;
+        dstR += 2;
     }
 }
+#endif
 
 #undef S
 #undef T
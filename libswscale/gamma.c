@@ -25,13 +25,14 @@ typedef struct GammaContext
     uint16_t *table;
 } GammaContext;
 
-// gamma_convert expects 16 bit rgb format
+// gamma_convert expects 16 bit packed rgb format, with or without alpha
 // it writes directly in src slice thus it must be modifiable (done through cascade context)
 static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
     GammaContext *instance = desc->instance;
     uint16_t *table = instance->table;
     int srcW = desc->src->width;
+    int step = isALPHA(desc->src->fmt) ? 4 : 3;
 
     int i;
     for (i = 0; i < sliceH; ++i) {
@@ -41,13 +42,13 @@ static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, i
         uint16_t *src1 = (uint16_t*)*(src+src_pos);
         int j;
         for (j = 0; j < srcW; ++j) {
-            uint16_t r = AV_RL16(src1 + j*4 + 0);
-            uint16_t g = AV_RL16(src1 + j*4 + 1);
-            uint16_t b = AV_RL16(src1 + j*4 + 2);
+            uint16_t r = AV_RL16(src1 + j*step + 0);
+            uint16_t g = AV_RL16(src1 + j*step + 1);
+            uint16_t b = AV_RL16(src1 + j*step + 2);
 
-            AV_WL16(src1 + j*4 + 0, table[r]);
-            AV_WL16(src1 + j*4 + 1, table[g]);
-            AV_WL16(src1 + j*4 + 2, table[b]);
+            AV_WL16(src1 + j*step + 0, table[r]);
+            AV_WL16(src1 + j*step + 1, table[g]);
+            AV_WL16(src1 + j*step + 2, table[b]);
         }
 
     }
@@ -0,0 +1,262 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Float linear light scaling, used for gamma correct scaling.
+ *
+ * The input is planar RGB, each line is converted to linear light while it
+ * is loaded for the horizontal filter, and the output of the vertical filter
+ * is converted back before it is stored as planar RGB of the depth of the
+ * output, or float. The conversion from and to other formats is done by
+ * separate contexts, see swscale.c.
+ */
+
+#include <math.h>
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/intfloat.h"
+#include "libavutil/mem.h"
+
+#include "config.h"
+#include "swscale_internal.h"
+
+static void linearize_8_c(float *dst, const uint8_t *src, const float *lut,
+                          int width)
+{
+    for (int i = 0; i < width; i++)
+        dst[i] = lut[src[i]];
+}
+
+static void linearize_16_c(float *dst, const uint8_t *src, const float *lut,
+                           int width)
+{
+    const uint16_t *src16 = (const uint16_t *)src;
+
+    for (int i = 0; i < width; i++)
+        dst[i] = lut[src16[i]];
+}
+
+/* The filters sum up the taps of each output in order, like the SIMD versions,
+ * and work on 4 outputs at once to not wait for each sum. */
+static void hscale_c(float *dst, const float *src, const float *filter,
+                     const int32_t *filterPos, int filterSize, int width)
+{
+    for (int i = 0; i < width; i += 4) {
+        const float *s0 = src + filterPos[i + 0];
+        const float *s1 = src + filterPos[i + 1];
+        const float *s2 = src + filterPos[i + 2];
+        const float *s3 = src + filterPos[i + 3];
+        const float *f  = filter + i;
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+
+        for (int j = 0; j < filterSize; j++, f += width) {
+            sum0 += f[0] * s0[j];
+            sum1 += f[1] * s1[j];
+            sum2 += f[2] * s2[j];
+            sum3 += f[3] * s3[j];
+        }
+        dst[i + 0] = sum0;
+        dst[i + 1] = sum1;
+        dst[i + 2] = sum2;
+        dst[i + 3] = sum3;
+    }
+}
+
+static void vscale_c(float *dst, const float *const *src, const float *filter,
+                     int filterSize, int width)
+{
+    int i;
+
+    for (i = 0; i + 3 < width; i += 4) {
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+
+        for (int j = 0; j < filterSize; j++) {
+            const float *s = src[j] + i;
+            sum0 += filter[j] * s[0];
+            sum1 += filter[j] * s[1];
+            sum2 += filter[j] * s[2];
+            sum3 += filter[j] * s[3];
+        }
+        dst[i + 0] = sum0;
+        dst[i + 1] = sum1;
+        dst[i + 2] = sum2;
+        dst[i + 3] = sum3;
+    }
+    for (; i < width; i++) {
+        float sum = 0.0f;
+
+        for (int j = 0; j < filterSize; j++)
+            sum += filter[j] * src[j][i];
+        dst[i] = sum;
+    }
+}
+
+static av_always_inline float delinearize(float v, const float *lut)
+{
+    const int bits = av_float2int(av_clipf(v, 0.0f, 1.0f));
+    const int idx  = (bits >> LINEAR_DELIN_LUT_SHIFT) - LINEAR_DELIN_LUT_BASE;
+    float frac;
+
+    /* below 2^-32, nothing visible is lost by flushing to 0 */
+    if (idx < 0)
+        return 0.0f;
+
+    frac = (bits & ((1 << LINEAR_DELIN_LUT_SHIFT) - 1)) *
+           (1.0f / (1 << LINEAR_DELIN_LUT_SHIFT));
+    return lut[idx] + frac * (lut[idx + 1] - lut[idx]);
+}
+
+static void vscale_delin_c(float *dst, const float *const *src,
+                           const float *filter, int filterSize,
+                           const float *lut, int width)
+{
+    vscale_c(dst, src, filter, filterSize, width);
+
+    for (int i = 0; i < width; i++)
+        dst[i] = delinearize(dst[i], lut);
+}
+
+static void store_8_c(uint8_t *dst, const float *src, int width)
+{
+    for (int i = 0; i < width; i++)
+        dst[i] = lrintf(av_clipf(src[i], 0.0f, 1.0f) * 255.0f);
+}
+
+static void store_16_c(uint8_t *dst, const float *src, int width)
+{
+    uint16_t *dst16 = (uint16_t *)dst;
+
+    for (int i = 0; i < width; i++)
+        dst16[i] = lrintf(av_clipf(src[i], 0.0f, 1.0f) * 65535.0f);
+}
+
+av_cold void ff_sws_init_linear_funcs(SwsLinearContext *lin)
+{
+    lin->linearize    = lin->is16 ? linearize_16_c : linearize_8_c;
+    lin->hscale       = hscale_c;
+    lin->vscale       = vscale_c;
+    lin->vscale_delin = vscale_delin_c;
+    lin->store        = lin->out_depth > 8 ? store_16_c : store_8_c;
+
+#if ARCH_X86
+    ff_sws_init_linear_funcs_x86(lin);
+#endif
+}
+
+av_cold int ff_sws_init_linear(SwsLinearContext *lin, double gamma,
+                               int srcW, int dstW)
+{
+    const int max = lin->is16 ? 0xFFFF : 0xFF;
+    int i;
+
+    lin->lut       = av_malloc_array(max + 1, sizeof(*lin->lut));
+    lin->delin_lut = av_malloc_array(LINEAR_DELIN_LUT_SIZE, sizeof(*lin->delin_lut));
+    lin->src_line  = av_malloc_array(FFALIGN(srcW, 16), sizeof(*lin->src_line));
+    lin->dst_line  = av_malloc_array(lin->dstStride, sizeof(*lin->dst_line));
+    lin->ring[0]   = av_malloc_array(lin->planes * lin->vFilterSize,
+                                     lin->dstStride * sizeof(*lin->ring[0]));
+    lin->lines     = av_malloc_array(lin->vFilterSize, sizeof(*lin->lines));
+    if (!lin->lut || !lin->delin_lut || !lin->src_line || !lin->dst_line ||
+        !lin->ring[0] || !lin->lines)
+        return AVERROR(ENOMEM);
+
+    for (i = 1; i < lin->planes; i++)
+        lin->ring[i] = lin->ring[i - 1] + lin->vFilterSize * lin->dstStride;
+
+    for (i = 0; i <= max; i++)
+        lin->lut[i] = pow(i / (double)max, gamma);
+
+    if (lin->planes > 3) {
+        lin->alpha_lut = av_malloc_array(max + 1, sizeof(*lin->alpha_lut));
+        if (!lin->alpha_lut)
+            return AVERROR(ENOMEM);
+        for (i = 0; i <= max; i++)
+            lin->alpha_lut[i] = i / (double)max;
+    }
+
+    for (i = 0; i < LINEAR_DELIN_LUT_SIZE - 1; i++) {
+        const float v = av_int2float((i + LINEAR_DELIN_LUT_BASE) << LINEAR_DELIN_LUT_SHIFT);
+        lin->delin_lut[i] = pow(v, 1.0 / gamma);
+    }
+    /* only read with a zero weight, for 1.0 */
+    lin->delin_lut[i] = lin->delin_lut[i - 1];
+
+    ff_sws_init_linear_funcs(lin);
+
+    return 0;
+}
+
+av_cold void ff_sws_uninit_linear(SwsLinearContext *lin)
+{
+    av_freep(&lin->lut);
+    av_freep(&lin->alpha_lut);
+    av_freep(&lin->delin_lut);
+    av_freep(&lin->hFilter);
+    av_freep(&lin->hFilterPos);
+    av_freep(&lin->vFilter);
+    av_freep(&lin->vFilterPos);
+    av_freep(&lin->src_line);
+    av_freep(&lin->dst_line);
+    av_freep(&lin->ring[0]);
+    av_freep(&lin->lines);
+    memset(lin->ring, 0, sizeof(lin->ring));
+}
+
+void ff_sws_linear_scale(SwsLinearContext *lin, int srcW, int dstW,
+                         const uint8_t *const src[4], const int srcStride[4],
+                         uint8_t *const dst[4], const int dstStride[4],
+                         int first, int last)
+{
+    const int size = lin->vFilterSize;
+    int next = lin->vFilterPos[first];
+
+    for (int y = first; y <= last; y++) {
+        const int pos = lin->vFilterPos[y];
+        const float *filter = lin->vFilter + y * size;
+
+        /* the positions only grow, so the ring keeps all lines still needed */
+        for (next = FFMAX(next, pos); next < pos + size; next++) {
+            for (int p = 0; p < lin->planes; p++) {
+                lin->linearize(lin->src_line, src[p] + next * (ptrdiff_t)srcStride[p],
+                               p == 3 ? lin->alpha_lut : lin->lut, srcW);
+                lin->hscale(lin->ring[p] + (next % size) * lin->dstStride,
+                            lin->src_line, lin->hFilter, lin->hFilterPos,
+                            lin->hFilterSize, lin->dstStride);
+            }
+        }
+
+        for (int p = 0; p < lin->planes; p++) {
+            uint8_t *line = dst[p] + (y - first) * (ptrdiff_t)dstStride[p];
+            float *out = lin->out_depth == 32 ? (float *)line : lin->dst_line;
+
+            for (int j = 0; j < size; j++)
+                lin->lines[j] = lin->ring[p] + (pos + j) % size * lin->dstStride;
+
+            if (p == 3)
+                lin->vscale(out, lin->lines, filter, size, dstW);
+            else
+                lin->vscale_delin(out, lin->lines, filter, size,
+                                  lin->delin_lut, dstW);
+
+            if (lin->out_depth != 32)
+                lin->store(line, out, dstW);
+        }
+    }
+}
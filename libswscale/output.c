@@ -344,7 +344,27 @@ yuv2planeX_10_c_template(const int16_t *filter, int filterSize,
     int i;
     int shift = 11 + 16 - output_bits;
 
-    for (i = 0; i < dstW; i++) {
+    /* 4 pixels at a time, see yuv2planeX_8_c() below */
+    for (i = 0; i < (dstW & ~3); i += 4) {
+        int val0 = 1 << (shift - 1);
+        int val1 = val0, val2 = val0, val3 = val0;
+        int j;
+
+        for (j = 0; j < filterSize; j++) {
+            const int16_t *s = src[j] + i;
+            const int f = filter[j];
+            val0 += s[0] * f;
+            val1 += s[1] * f;
+            val2 += s[2] * f;
+            val3 += s[3] * f;
+        }
+
+        output_pixel(&dest[i + 0], val0);
+        output_pixel(&dest[i + 1], val1);
+        output_pixel(&dest[i + 2], val2);
+        output_pixel(&dest[i + 3], val3);
+    }
+    for (; i < dstW; i++) {
         int val = 1 << (shift - 1);
         int j;
 
@@ -407,7 +427,30 @@ static void yuv2planeX_8_c(const int16_t *filter, int filterSize,
                            const uint8_t *dither, int offset)
 {
     int i;
-    for (i=0; i<dstW; i++) {
+
+    /* 4 pixels at a time, so that every source line pointer and coefficient
+     * is loaded once per block instead of once per pixel */
+    for (i = 0; i < (dstW & ~3); i += 4) {
+        int val0 = dither[(i + 0 + offset) & 7] << 12;
+        int val1 = dither[(i + 1 + offset) & 7] << 12;
+        int val2 = dither[(i + 2 + offset) & 7] << 12;
+        int val3 = dither[(i + 3 + offset) & 7] << 12;
+        int j;
+        for (j = 0; j < filterSize; j++) {
+            const int16_t *s = src[j] + i;
+            const int f = filter[j];
+            val0 += s[0] * f;
+            val1 += s[1] * f;
+            val2 += s[2] * f;
+            val3 += s[3] * f;
+        }
+
+        dest[i + 0] = av_clip_uint8(val0 >> 19);
+        dest[i + 1] = av_clip_uint8(val1 >> 19);
+        dest[i + 2] = av_clip_uint8(val2 >> 19);
+        dest[i + 3] = av_clip_uint8(val3 >> 19);
+    }
+    for (; i<dstW; i++) {
         int val = dither[(i + offset) & 7] << 12;
         int j;
         for (j=0; j<filterSize; j++)
@@ -325,7 +325,7 @@ int ff_init_filters(SwsContext * c)
     dstIdx = 1;
 
     if (need_gamma) {
-        res = ff_init_gamma_convert(c->desc + index, c->slice + srcIdx, c->inv_gamma);
+        res = ff_init_gamma_convert(c->desc + index, c->slice + srcIdx, c->gamma);
         if (res < 0) goto cleanup;
         ++index;
     }
@@ -374,7 +374,7 @@ int ff_init_filters(SwsContext * c)
 
     ++index;
     if (need_gamma) {
-        res = ff_init_gamma_convert(c->desc + index, c->slice + dstIdx, c->gamma);
+        res = ff_init_gamma_convert(c->desc + index, c->slice + dstIdx, c->inv_gamma);
         if (res < 0) goto cleanup;
     }
 
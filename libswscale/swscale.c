@@ -61,98 +61,147 @@ static av_always_inline void fillPlane(uint8_t *plane, int stride, int width,
     }
 }
 
-static void hScale16To19_c(SwsContext *c, int16_t *_dst, int dstW,
-                           const uint8_t *_src, const int16_t *filter,
-                           const int32_t *filterPos, int filterSize)
+static av_always_inline void
+hscale16_c_template(int16_t *_dst, int dstW, const uint8_t *_src,
+                    const int16_t *filter, const int32_t *filterPos,
+                    int filterSize, int fixed_size, int sh, int to19)
 {
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
-    int i;
-    int32_t *dst        = (int32_t *) _dst;
+    int32_t *dst19      = (int32_t *) _dst;
     const uint16_t *src = (const uint16_t *) _src;
-    int bits            = desc->comp[0].depth - 1;
-    int sh              = bits - 4;
+    int i;
 
-    if ((isAnyRGB(c->srcFormat) || c->srcFormat==AV_PIX_FMT_PAL8) && desc->comp[0].depth<16) {
-        sh = 9;
-    } else if (desc->flags & AV_PIX_FMT_FLAG_FLOAT) { /* float input are process like uint 16bpc */
-        sh = 16 - 1 - 4;
-    }
+    if (fixed_size)
+        filterSize = fixed_size;
 
     for (i = 0; i < dstW; i++) {
+        const uint16_t *s = src + filterPos[i];
+        const int16_t  *f = filter + filterSize * i;
         int j;
-        int srcPos = filterPos[i];
-        int val    = 0;
+        int val = 0;
 
-        for (j = 0; j < filterSize; j++) {
-            val += src[srcPos + j] * filter[filterSize * i + j];
+        if (fixed_size || !(filterSize & 3)) {
+            int val1 = 0;
+            for (j = 0; j < filterSize; j += 4) {
+                val  += s[j + 0] * f[j + 0] + s[j + 2] * f[j + 2];
+                val1 += s[j + 1] * f[j + 1] + s[j + 3] * f[j + 3];
+            }
+            val += val1;
+        } else {
+            for (j = 0; j < filterSize; j++)
+                val += s[j] * f[j];
         }
-        // filter=14 bit, input=16 bit, output=30 bit, >> 11 makes 19 bit
-        dst[i] = FFMIN(val >> sh, (1 << 19) - 1);
+        if (to19)
+            // filter=14 bit, input=16 bit, output=30 bit, >> 11 makes 19 bit
+            dst19[i] = FFMIN(val >> sh, (1 << 19) - 1);
+        else
+            // filter=14 bit, input=16 bit, output=30 bit, >> 15 makes 15 bit
+            _dst[i]  = FFMIN(val >> sh, (1 << 15) - 1);
     }
 }
 
-static void hScale16To15_c(SwsContext *c, int16_t *dst, int dstW,
-                           const uint8_t *_src, const int16_t *filter,
-                           const int32_t *filterPos, int filterSize)
+static int hscale16to19_shift(SwsContext *c)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
-    int i;
-    const uint16_t *src = (const uint16_t *) _src;
-    int sh              = desc->comp[0].depth - 1;
+    int bits = desc->comp[0].depth - 1;
+    int sh   = bits - 4;
 
-    if (sh<15) {
-        sh = isAnyRGB(c->srcFormat) || c->srcFormat==AV_PIX_FMT_PAL8 ? 13 : (desc->comp[0].depth - 1);
+    if ((isAnyRGB(c->srcFormat) || c->srcFormat==AV_PIX_FMT_PAL8) && desc->comp[0].depth<16) {
+        sh = 9;
     } else if (desc->flags & AV_PIX_FMT_FLAG_FLOAT) { /* float input are process like uint 16bpc */
-        sh = 16 - 1;
+        sh = 16 - 1 - 4;
     }
+    return sh;
+}
 
-    for (i = 0; i < dstW; i++) {
-        int j;
-        int srcPos = filterPos[i];
-        int val    = 0;
+static int hscale16to15_shift(SwsContext *c)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    int sh = desc->comp[0].depth - 1;
 
-        for (j = 0; j < filterSize; j++) {
-            val += src[srcPos + j] * filter[filterSize * i + j];
-        }
-        // filter=14 bit, input=16 bit, output=30 bit, >> 15 makes 15 bit
-        dst[i] = FFMIN(val >> sh, (1 << 15) - 1);
+    if (sh<15) {
+        sh = isAnyRGB(c->srcFormat) || c->srcFormat==AV_PIX_FMT_PAL8 ? 13 : (desc->comp[0].depth - 1);
+    } else if (desc->flags & AV_PIX_FMT_FLAG_FLOAT) { /* float input are process like uint 16bpc */
+        sh = 16 - 1;
     }
+    return sh;
 }
 
 // bilinear / bicubic scaling
-static void hScale8To15_c(SwsContext *c, int16_t *dst, int dstW,
-                          const uint8_t *src, const int16_t *filter,
-                          const int32_t *filterPos, int filterSize)
+static av_always_inline void
+hscale8_c_template(int16_t *_dst, int dstW, const uint8_t *src,
+                   const int16_t *filter, const int32_t *filterPos,
+                   int filterSize, int fixed_size, int to19)
 {
+    int32_t *dst19 = (int32_t *) _dst;
     int i;
+
+    if (fixed_size)
+        filterSize = fixed_size;
+
     for (i = 0; i < dstW; i++) {
+        const uint8_t *s = src + filterPos[i];
+        const int16_t *f = filter + filterSize * i;
         int j;
-        int srcPos = filterPos[i];
-        int val    = 0;
-        for (j = 0; j < filterSize; j++) {
-            val += ((int)src[srcPos + j]) * filter[filterSize * i + j];
+        int val = 0;
+
+        if (fixed_size || !(filterSize & 3)) {
+            int val1 = 0;
+            for (j = 0; j < filterSize; j += 4) {
+                val  += s[j + 0] * f[j + 0] + s[j + 2] * f[j + 2];
+                val1 += s[j + 1] * f[j + 1] + s[j + 3] * f[j + 3];
+            }
+            val += val1;
+        } else {
+            for (j = 0; j < filterSize; j++)
+                val += s[j] * f[j];
         }
-        dst[i] = FFMIN(val >> 7, (1 << 15) - 1); // the cubic equation does overflow ...
+        // the cubic equation does overflow ...
+        if (to19)
+            dst19[i] = FFMIN(val >> 3, (1 << 19) - 1);
+        else
+            _dst[i]  = FFMIN(val >> 7, (1 << 15) - 1);
     }
 }
 
-static void hScale8To19_c(SwsContext *c, int16_t *_dst, int dstW,
-                          const uint8_t *src, const int16_t *filter,
-                          const int32_t *filterPos, int filterSize)
-{
-    int i;
-    int32_t *dst = (int32_t *) _dst;
-    for (i = 0; i < dstW; i++) {
-        int j;
-        int srcPos = filterPos[i];
-        int val    = 0;
-        for (j = 0; j < filterSize; j++) {
-            val += ((int)src[srcPos + j]) * filter[filterSize * i + j];
-        }
-        dst[i] = FFMIN(val >> 3, (1 << 19) - 1); // the cubic equation does overflow ...
-    }
+/* The _4 and _8 variants are the generic filter with the inner loop fully
+ * unrolled for the filter sizes most commonly produced by initFilter(). */
+#define HSCALE_FUNCS(size, fixed_size)                                        \
+static void hScale8To15_ ## size(SwsContext *c, int16_t *dst, int dstW,       \
+                                 const uint8_t *src, const int16_t *filter,   \
+                                 const int32_t *filterPos, int filterSize)    \
+{                                                                             \
+    hscale8_c_template(dst, dstW, src, filter, filterPos, filterSize,         \
+                       fixed_size, 0);                                        \
+}                                                                             \
+                                                                              \
+static void hScale8To19_ ## size(SwsContext *c, int16_t *dst, int dstW,       \
+                                 const uint8_t *src, const int16_t *filter,   \
+                                 const int32_t *filterPos, int filterSize)    \
+{                                                                             \
+    hscale8_c_template(dst, dstW, src, filter, filterPos, filterSize,         \
+                       fixed_size, 1);                                        \
+}                                                                             \
+                                                                              \
+static void hScale16To15_ ## size(SwsContext *c, int16_t *dst, int dstW,      \
+                                  const uint8_t *src, const int16_t *filter,  \
+                                  const int32_t *filterPos, int filterSize)   \
+{                                                                             \
+    hscale16_c_template(dst, dstW, src, filter, filterPos, filterSize,        \
+                        fixed_size, hscale16to15_shift(c), 0);                \
+}                                                                             \
+                                                                              \
+static void hScale16To19_ ## size(SwsContext *c, int16_t *dst, int dstW,      \
+                                  const uint8_t *src, const int16_t *filter,  \
+                                  const int32_t *filterPos, int filterSize)   \
+{                                                                             \
+    hscale16_c_template(dst, dstW, src, filter, filterPos, filterSize,        \
+                        fixed_size, hscale16to19_shift(c), 1);                \
 }
 
+HSCALE_FUNCS(c,    0)
+HSCALE_FUNCS(4_c,  4)
+HSCALE_FUNCS(8_c,  8)
+
 // FIXME all pal and rgb srcFormats could do this conversion as well
 // FIXME all scalers more complex than bilinear could do half of this transform
 static void chrRangeToJpeg_c(int16_t *dstU, int16_t *dstV, int width)
@@ -494,6 +543,11 @@ static int swscale(SwsContext *c, const uint8_t *src[],
                            yuv2packed1, yuv2packed2, yuv2packedX, yuv2anyX, use_mmx_vfilter);
         }
 
+        if (c->dither == SWS_DITHER_ED && c->ed_bands &&
+            (!(dstY % SWS_ED_BAND_HEIGHT) || (scale_dst && dstY == dstSliceY)))
+            for (i = 0; i < 4; i++)
+                memset(c->dither_error[i], 0, sizeof(c->dither_error[0][0]) * (dstW + 3));
+
         for (i = vStart; i < vEnd; ++i)
             desc[i].process(c, &desc[i], dstY, 1);
     }
@@ -565,21 +619,33 @@ static av_cold void sws_init_swscale(SwsContext *c)
 
     ff_sws_init_input_funcs(c);
 
+#define ASSIGN_HSCALE_FUNC(hscalefn, filtersize, in, out)            \
+    hscalefn = filtersize == 4 ? hScale ## in ## To ## out ## _4_c : \
+               filtersize == 8 ? hScale ## in ## To ## out ## _8_c : \
+                                 hScale ## in ## To ## out ## _c
+
     if (c->srcBpc == 8) {
         if (c->dstBpc <= 14) {
-            c->hyScale = c->hcScale = hScale8To15_c;
+            ASSIGN_HSCALE_FUNC(c->hyScale, c->hLumFilterSize, 8, 15);
+            ASSIGN_HSCALE_FUNC(c->hcScale, c->hChrFilterSize, 8, 15);
             if (c->flags & SWS_FAST_BILINEAR) {
                 c->hyscale_fast = ff_hyscale_fast_c;
                 c->hcscale_fast = ff_hcscale_fast_c;
             }
         } else {
-            c->hyScale = c->hcScale = hScale8To19_c;
+            ASSIGN_HSCALE_FUNC(c->hyScale, c->hLumFilterSize, 8, 19);
+            ASSIGN_HSCALE_FUNC(c->hcScale, c->hChrFilterSize, 8, 19);
         }
+    } else if (c->dstBpc > 14) {
+        ASSIGN_HSCALE_FUNC(c->hyScale, c->hLumFilterSize, 16, 19);
+        ASSIGN_HSCALE_FUNC(c->hcScale, c->hChrFilterSize, 16, 19);
     } else {
-        c->hyScale = c->hcScale = c->dstBpc > 14 ? hScale16To19_c
-                                                 : hScale16To15_c;
+        ASSIGN_HSCALE_FUNC(c->hyScale, c->hLumFilterSize, 16, 15);
+        ASSIGN_HSCALE_FUNC(c->hcScale, c->hChrFilterSize, 16, 15);
     }
 
+#undef ASSIGN_HSCALE_FUNC
+
     ff_sws_init_range_convert(c);
 
     if (!(isGray(srcFormat) || isGray(c->dstFormat) ||
@@ -633,17 +699,19 @@ static int check_image_pointers(const uint8_t * const data[4], enum AVPixelForma
     return 1;
 }
 
-static void xyz12Torgb48(struct SwsContext *c, uint16_t *dst,
-                         const uint16_t *src, int stride, int h)
+static av_always_inline void xyz12Torgb48_c(const SwsContext *c, uint16_t *dst,
+                                            const uint16_t *src, int stride,
+                                            int w, int h, int big_endian)
 {
-    int xp,yp;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    const int16_t *xyzgamma = c->xyzgamma;
+    const int16_t *rgbgamma = c->rgbgamma;
+    int xp, yp;
 
-    for (yp=0; yp<h; yp++) {
-        for (xp=0; xp+2<stride; xp+=3) {
+    for (yp = 0; yp < h; yp++) {
+        for (xp = 0; xp < 3 * w; xp += 3) {
             int x, y, z, r, g, b;
 
-            if (desc->flags & AV_PIX_FMT_FLAG_BE) {
+            if (big_endian) {
                 x = AV_RB16(src + xp + 0);
                 y = AV_RB16(src + xp + 1);
                 z = AV_RB16(src + xp + 2);
@@ -653,9 +721,9 @@ static void xyz12Torgb48(struct SwsContext *c, uint16_t *dst,
                 z = AV_RL16(src + xp + 2);
             }
 
-            x = c->xyzgamma[x>>4];
-            y = c->xyzgamma[y>>4];
-            z = c->xyzgamma[z>>4];
+            x = xyzgamma[x >> 4];
+            y = xyzgamma[y >> 4];
+            z = xyzgamma[z >> 4];
 
             // convert from XYZlinear to sRGBlinear
             r = c->xyz2rgb_matrix[0][0] * x +
@@ -674,14 +742,14 @@ static void xyz12Torgb48(struct SwsContext *c, uint16_t *dst,
             b = av_clip_uintp2(b, 12);
 
             // convert from sRGBlinear to RGB and scale from 12bit to 16bit
-            if (desc->flags & AV_PIX_FMT_FLAG_BE) {
-                AV_WB16(dst + xp + 0, c->rgbgamma[r] << 4);
-                AV_WB16(dst + xp + 1, c->rgbgamma[g] << 4);
-                AV_WB16(dst + xp + 2, c->rgbgamma[b] << 4);
+            if (big_endian) {
+                AV_WB16(dst + xp + 0, rgbgamma[r] << 4);
+                AV_WB16(dst + xp + 1, rgbgamma[g] << 4);
+                AV_WB16(dst + xp + 2, rgbgamma[b] << 4);
             } else {
-                AV_WL16(dst + xp + 0, c->rgbgamma[r] << 4);
-                AV_WL16(dst + xp + 1, c->rgbgamma[g] << 4);
-                AV_WL16(dst + xp + 2, c->rgbgamma[b] << 4);
+                AV_WL16(dst + xp + 0, rgbgamma[r] << 4);
+                AV_WL16(dst + xp + 1, rgbgamma[g] << 4);
+                AV_WL16(dst + xp + 2, rgbgamma[b] << 4);
             }
         }
         src += stride;
@@ -689,17 +757,28 @@ static void xyz12Torgb48(struct SwsContext *c, uint16_t *dst,
     }
 }
 
-static void rgb48Toxyz12(struct SwsContext *c, uint16_t *dst,
+static void xyz12Torgb48(const SwsContext *c, uint16_t *dst,
                          const uint16_t *src, int stride, int h)
 {
-    int xp,yp;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->dstFormat);
+    if (isBE(c->srcFormat))
+        xyz12Torgb48_c(c, dst, src, stride, c->srcW, h, 1);
+    else
+        xyz12Torgb48_c(c, dst, src, stride, c->srcW, h, 0);
+}
+
+static av_always_inline void rgb48Toxyz12_c(const SwsContext *c, uint16_t *dst,
+                                            const uint16_t *src, int stride,
+                                            int w, int h, int big_endian)
+{
+    const int16_t *rgbgammainv = c->rgbgammainv;
+    const int16_t *xyzgammainv = c->xyzgammainv;
+    int xp, yp;
 
-    for (yp=0; yp<h; yp++) {
-        for (xp=0; xp+2<stride; xp+=3) {
+    for (yp = 0; yp < h; yp++) {
+        for (xp = 0; xp < 3 * w; xp += 3) {
             int x, y, z, r, g, b;
 
-            if (desc->flags & AV_PIX_FMT_FLAG_BE) {
+            if (big_endian) {
                 r = AV_RB16(src + xp + 0);
                 g = AV_RB16(src + xp + 1);
                 b = AV_RB16(src + xp + 2);
@@ -709,9 +788,9 @@ static void rgb48Toxyz12(struct SwsContext *c, uint16_t *dst,
                 b = AV_RL16(src + xp + 2);
             }
 
-            r = c->rgbgammainv[r>>4];
-            g = c->rgbgammainv[g>>4];
-            b = c->rgbgammainv[b>>4];
+            r = rgbgammainv[r >> 4];
+            g = rgbgammainv[g >> 4];
+            b = rgbgammainv[b >> 4];
 
             // convert from sRGBlinear to XYZlinear
             x = c->rgb2xyz_matrix[0][0] * r +
@@ -730,14 +809,14 @@ static void rgb48Toxyz12(struct SwsContext *c, uint16_t *dst,
             z = av_clip_uintp2(z, 12);
 
             // convert from XYZlinear to X'Y'Z' and scale from 12bit to 16bit
-            if (desc->flags & AV_PIX_FMT_FLAG_BE) {
-                AV_WB16(dst + xp + 0, c->xyzgammainv[x] << 4);
-                AV_WB16(dst + xp + 1, c->xyzgammainv[y] << 4);
-                AV_WB16(dst + xp + 2, c->xyzgammainv[z] << 4);
+            if (big_endian) {
+                AV_WB16(dst + xp + 0, xyzgammainv[x] << 4);
+                AV_WB16(dst + xp + 1, xyzgammainv[y] << 4);
+                AV_WB16(dst + xp + 2, xyzgammainv[z] << 4);
             } else {
-                AV_WL16(dst + xp + 0, c->xyzgammainv[x] << 4);
-                AV_WL16(dst + xp + 1, c->xyzgammainv[y] << 4);
-                AV_WL16(dst + xp + 2, c->xyzgammainv[z] << 4);
+                AV_WL16(dst + xp + 0, xyzgammainv[x] << 4);
+                AV_WL16(dst + xp + 1, xyzgammainv[y] << 4);
+                AV_WL16(dst + xp + 2, xyzgammainv[z] << 4);
             }
         }
         src += stride;
@@ -745,6 +824,47 @@ static void rgb48Toxyz12(struct SwsContext *c, uint16_t *dst,
     }
 }
 
+static void rgb48Toxyz12(const SwsContext *c, uint16_t *dst,
+                         const uint16_t *src, int stride, int h)
+{
+    if (isBE(c->dstFormat))
+        rgb48Toxyz12_c(c, dst, src, stride, c->dstW, h, 1);
+    else
+        rgb48Toxyz12_c(c, dst, src, stride, c->dstW, h, 0);
+}
+
+/**
+ * Find the source lines [*first, *last] read when producing the destination
+ * lines dstSliceY .. dstSliceY + dstSliceH - 1.
+ */
+static void get_src_slice_range(const SwsContext *c, int dstSliceY, int dstSliceH,
+                                int *first, int *last)
+{
+    const int chr_mask  = (1 << c->chrDstVSubSample) - 1;
+    const int chr_shift = c->chrSrcVSubSample;
+    int y0 = c->srcH, y1 = 0;
+
+    if (c->convert_unscaled) {
+        *first = dstSliceY;
+        *last  = dstSliceY + dstSliceH - 1;
+        return;
+    }
+
+    /* mirror the line accounting of swscale() */
+    for (int y = dstSliceY; y < dstSliceY + dstSliceH; y++) {
+        const int lum_y2 = FFMIN(y | chr_mask, c->dstH - 1);
+        const int chr_y  = y >> c->chrDstVSubSample;
+
+        y0 = FFMIN(y0, c->vLumFilterPos[y]);
+        y0 = FFMIN(y0, c->vChrFilterPos[chr_y] << chr_shift);
+        y1 = FFMAX(y1, c->vLumFilterPos[lum_y2] + c->vLumFilterSize);
+        y1 = FFMAX(y1, (c->vChrFilterPos[chr_y] + c->vChrFilterSize) << chr_shift);
+    }
+
+    *first = av_clip(y0,     0, c->srcH - 1);
+    *last  = av_clip(y1 - 1, 0, c->srcH - 1);
+}
+
 static void update_palette(SwsContext *c, const uint32_t *pal)
 {
     for (int i = 0; i < 256; i++) {
@@ -860,6 +980,68 @@ static int scale_gamma(SwsContext *c,
     return ret;
 }
 
+static int scale_linear(SwsContext *c,
+                        const uint8_t * const srcSlice[], const int srcStride[],
+                        int srcSliceY, int srcSliceH,
+                        uint8_t * const dstSlice[], const int dstStride[],
+                        int dstSliceY, int dstSliceH)
+{
+    SwsContext *in  = c->cascaded_context[0];
+    SwsContext *out = c->cascaded_context[2];
+    const uint8_t *const *src = srcSlice;
+    const int *src_stride     = srcStride;
+    uint8_t *dst[4];
+    int first = dstSliceY, last = dstSliceY + dstSliceH - 1, ret;
+
+    if (srcSliceY != 0 || srcSliceH != c->srcH) {
+        av_log(c, AV_LOG_ERROR, "Float gamma correct scaling needs the whole input frame\n");
+        return AVERROR(EINVAL);
+    }
+
+    /* the float lines the output conversion reads */
+    if (out)
+        get_src_slice_range(out, dstSliceY, dstSliceH, &first, &last);
+
+    if (in) {
+        const int align = in->dst_slice_align;
+        int in_first = c->lin.vFilterPos[first];
+        int in_last  = c->lin.vFilterPos[last] + c->lin.vFilterSize - 1;
+        uint8_t *tmp[4] = { NULL };
+
+        in_first = in_first & ~(align - 1);
+        in_last  = FFMIN(FFALIGN(in_last + 1, align), c->srcH) - 1;
+        for (int i = 0; i < 4 && c->cascaded_tmp[i]; i++)
+            tmp[i] = c->cascaded_tmp[i] + in_first * (ptrdiff_t)c->cascaded_tmpStride[i];
+
+        ret = scale_internal(in, srcSlice, srcStride, 0, c->srcH,
+                             tmp, c->cascaded_tmpStride,
+                             in_first, in_last + 1 - in_first);
+        if (ret < 0)
+            return ret;
+
+        src        = (const uint8_t * const *)c->cascaded_tmp;
+        src_stride = c->cascaded_tmpStride;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        if (out)
+            dst[i] = c->cascaded1_tmp[i] ?
+                     c->cascaded1_tmp[i] + first * (ptrdiff_t)c->cascaded1_tmpStride[i] : NULL;
+        else
+            dst[i] = dstSlice[i];
+    }
+
+    ff_sws_linear_scale(&c->lin, c->srcW, c->dstW, src, src_stride, dst,
+                        out ? c->cascaded1_tmpStride : dstStride, first, last);
+
+    if (!out)
+        return dstSliceH;
+
+    return scale_internal(out, (const uint8_t * const *)c->cascaded1_tmp,
+                          c->cascaded1_tmpStride, 0, c->dstH,
+                          dstSlice, dstStride, dstSliceY, dstSliceH);
+}
+
 static int scale_cascaded(SwsContext *c,
                           const uint8_t * const srcSlice[], const int srcStride[],
                           int srcSliceY, int srcSliceH,
@@ -930,6 +1112,10 @@ static int scale_internal(SwsContext *c,
     if (srcSliceH == 0)
         return 0;
 
+    if (c->lin.vFilter)
+        return scale_linear(c, srcSlice, srcStride, srcSliceY, srcSliceH,
+                            dstSlice, dstStride, dstSliceY, dstSliceH);
+
     if (c->gamma_flag && c->cascaded_context[0])
         return scale_gamma(c, srcSlice, srcStride, srcSliceY, srcSliceH,
                            dstSlice, dstStride, dstSliceY, dstSliceH);
@@ -982,16 +1168,33 @@ static int scale_internal(SwsContext *c,
 
     if (c->srcXYZ && !(c->dstXYZ && c->srcW==c->dstW && c->srcH==c->dstH)) {
         uint8_t *base;
+        int first = srcSliceY, last = srcSliceY + srcSliceH - 1, h;
+
+        /* When a destination slice is requested, e.g. by a slice thread, only
+         * convert the source lines it depends on, rather than the whole
+         * frame in every slice. */
+        if (scale_dst) {
+            get_src_slice_range(c, dstSliceY, dstSliceH, &first, &last);
+            first = FFMAX(first, srcSliceY);
+            last  = FFMIN(last,  srcSliceY + srcSliceH - 1);
+            if (!c->convert_unscaled)
+                srcSliceH = last + 1 - srcSliceY;
+        }
+        /* The scratch starts at srcSliceY like the source, so that the lines
+         * before the first one converted are still inside of it. */
+        h = last + 1 - srcSliceY;
 
         av_fast_malloc(&c->xyz_scratch, &c->xyz_scratch_allocated,
-                       FFABS(srcStride[0]) * srcSliceH + 32);
+                       FFABS(srcStride[0]) * h + 32);
         if (!c->xyz_scratch)
             return AVERROR(ENOMEM);
 
-        base = srcStride[0] < 0 ? c->xyz_scratch - srcStride[0] * (srcSliceH-1) :
+        base = srcStride[0] < 0 ? c->xyz_scratch - srcStride[0] * (h-1) :
                                   c->xyz_scratch;
 
-        xyz12Torgb48(c, (uint16_t*)base, (const uint16_t*)src2[0], srcStride[0]/2, srcSliceH);
+        xyz12Torgb48(c, (uint16_t*)(base + (first - srcSliceY) * srcStride[0]),
+                     (const uint16_t*)(src2[0] + (first - srcSliceY) * srcStride[0]),
+                     srcStride[0]/2, last + 1 - first);
         src2[0] = base;
     }
 
@@ -1039,6 +1242,7 @@ static int scale_internal(SwsContext *c,
             slice_h = dstSliceH;
         }
 
+        c->src_frame_available = scale_dst;
         ret = c->convert_unscaled(c, src2, srcStride2, offset, slice_h,
                                   dst2, dstStride2);
         if (scale_dst)
@@ -1151,7 +1355,8 @@ int sws_receive_slice(struct SwsContext *c, unsigned int slice_start,
     }
 
     if (c->slicethread) {
-        int nb_jobs = c->slice_ctx[0]->dither == SWS_DITHER_ED ? 1 : c->nb_slice_ctx;
+        int nb_jobs = c->slice_ctx[0]->dither == SWS_DITHER_ED &&
+                      !c->ed_bands ? 1 : c->nb_slice_ctx;
         int ret = 0;
 
         c->dst_slice_start  = slice_start;
@@ -1221,8 +1426,11 @@ void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
     SwsContext *parent = priv;
     SwsContext      *c = parent->slice_ctx[threadnr];
 
+    /* keep error diffusion bands within a single job */
+    const int align        = c->dither == SWS_DITHER_ED && c->ed_bands ?
+                             SWS_ED_BAND_HEIGHT : c->dst_slice_align;
     const int slice_height = FFALIGN(FFMAX((parent->dst_slice_height + nb_jobs - 1) / nb_jobs, 1),
-                                     c->dst_slice_align);
+                                     align);
     const int slice_start  = jobnr * slice_height;
     const int slice_end    = FFMIN((jobnr + 1) * slice_height, parent->dst_slice_height);
     int err = 0;
@@ -169,6 +169,27 @@ int sws_init_context(struct SwsContext *sws_context, SwsFilter *srcFilter, SwsFi
  */
 void sws_freeContext(struct SwsContext *swsContext);
 
+/**
+ * Get the statistics of the process-wide cache of scaler filters, which is
+ * used by all contexts initialized without a user supplied SwsFilter.
+ *
+ * @param[out] hits       if not NULL, set to the number of filters taken
+ *                        from the cache
+ * @param[out] misses     if not NULL, set to the number of filters that
+ *                        had to be built
+ * @param[out] time_saved if not NULL, set to the time the filters taken from
+ *                        the cache took to build, in microseconds
+ */
+void sws_get_filter_cache_stats(uint64_t *hits, uint64_t *misses,
+                                int64_t *time_saved);
+
+/**
+ * Free all filters held by the process-wide filter cache and reset its
+ * statistics. Existing contexts are not affected, they keep their own copies
+ * of the filters.
+ */
+void sws_free_filter_cache(void);
+
 /**
  * Allocate and return an SwsContext. You need it to perform
  * scaling/conversion operations using sws_scale().
@@ -64,6 +64,10 @@
 
 #define RETCODE_USE_CASCADE -12345
 
+/* with ed_bands, error diffusion restarts every SWS_ED_BAND_HEIGHT output
+ * lines, so that slice threads can dither the bands independently */
+#define SWS_ED_BAND_HEIGHT 32
+
 struct SwsContext;
 
 typedef enum SwsDither {
@@ -292,6 +296,161 @@ typedef void (*yuv2anyX_fn)(struct SwsContext *c, const int16_t *lumFilter,
                             const int16_t **alpSrc, uint8_t **dest,
                             int dstW, int y);
 
+/**
+ * Weight two chroma lines of the unscaled planar YUV to RGB path 3:1.
+ *
+ * @param dst    16-bit output line
+ * @param src0   nearest input line, 8 or 16 bits per sample
+ * @param src1   second nearest input line, the same as src0 without
+ *               vertical subsampling
+ * @param width  number of samples
+ */
+typedef void (*yuv2rgb_chroma_row_fn)(uint16_t *dst, const uint8_t *src0,
+                                      const uint8_t *src1, int width);
+
+/**
+ * Convert a line of the unscaled planar YUV to RGB path.
+ *
+ * @param dst     output planes, only dst[0] for packed RGB
+ * @param srcY    luma input line, 8 or 16 bits per sample
+ * @param srcU    chroma line written by yuv2rgb_chroma_row_fn, padded by one
+ *                sample on each side
+ * @param srcV    same as srcU for V
+ * @param coeffs  YUV2RGB_* coefficient table
+ * @param width   number of pixels
+ */
+typedef void (*yuv2rgb_line_fn)(uint8_t *dst[3], const uint8_t *srcY,
+                                const uint16_t *srcU, const uint16_t *srcV,
+                                const int32_t *coeffs, int width);
+
+/**
+ * Convert a line to luma in the unscaled RGB to planar YUV path.
+ *
+ * @param dst     luma output line, 8 or 16 bits per sample
+ * @param src     input planes, only src[0] for packed RGB
+ * @param coeffs  RGB2YUV_* coefficient table
+ * @param width   number of pixels
+ */
+typedef void (*rgb2yuv_luma_fn)(uint8_t *dst, const uint8_t *src[3],
+                                const int32_t *coeffs, int width);
+
+/**
+ * Convert one or two lines to chroma in the unscaled RGB to planar YUV path,
+ * averaging each subsampled block.
+ *
+ * @param dstU    U output line, 8 or 16 bits per sample
+ * @param dstV    V output line
+ * @param src0    input planes of the first line, only src0[0] for packed RGB
+ * @param src1    input planes of the second line, unused without vertical
+ *                subsampling
+ * @param coeffs  RGB2YUV_* coefficient table
+ * @param width   number of input pixels
+ */
+typedef void (*rgb2yuv_chroma_fn)(uint8_t *dstU, uint8_t *dstV,
+                                  const uint8_t *src0[3], const uint8_t *src1[3],
+                                  const int32_t *coeffs, int width);
+
+/**
+ * Demosaic a line of the interior of a Bayer frame to planar RGB with the
+ * bilinear interpolation of bayer_template.c.
+ *
+ * @param dst_c       output for the colour sampled on the line, at the even
+ *                    pixels
+ * @param dst_g       output for green, sampled at the odd pixels
+ * @param dst_o       output for the colour sampled on the lines above and
+ *                    below
+ * @param src         input line, the pixels next to it are read too
+ * @param src_stride  distance between input lines in bytes
+ * @param width       number of pixels, even
+ */
+typedef void (*bayer_interp_line_fn)(uint8_t *dst_c, uint8_t *dst_g,
+                                     uint8_t *dst_o, const uint8_t *src,
+                                     ptrdiff_t src_stride, int width);
+
+/**
+ * Convert a line of 8-bit packed RGB to planar RGB, 8-bit or float.
+ *
+ * @param dst    output planes in the order of the packed components, then
+ *               alpha, NULL without alpha
+ * @param src    input line
+ * @param width  number of pixels
+ */
+typedef void (*rgb2gbrp_line_fn)(uint8_t *dst[4], const uint8_t *src,
+                                 int width);
+
+/**
+ * Convert a line of planar RGB, 8-bit or float, to 8-bit packed RGB.
+ *
+ * @param dst    output line
+ * @param src    input planes in the order of the packed components, then
+ *               alpha, NULL without alpha
+ * @param width  number of pixels
+ */
+typedef void (*gbrp2rgb_line_fn)(uint8_t *dst, const uint8_t *src[4],
+                                 int width);
+
+#define LINEAR_DELIN_LUT_SHIFT 16
+/* float bits >> LINEAR_DELIN_LUT_SHIFT of 2^-32, the first table entry */
+#define LINEAR_DELIN_LUT_BASE  ((127 - 32) << (23 - LINEAR_DELIN_LUT_SHIFT))
+#define LINEAR_DELIN_LUT_SIZE  ((32 << (23 - LINEAR_DELIN_LUT_SHIFT)) + 2)
+
+/**
+ * Float linear light pipeline for gamma correct scaling, see linear.c.
+ */
+typedef struct SwsLinearContext {
+    int is16;                     ///< 16-bit planar RGB input, 8-bit otherwise
+    int out_depth;                ///< 8 or 16-bit planar RGB output, or 32 for float
+    int planes;                   ///< 3, or 4 if alpha is scaled too
+
+    float *lut;                   ///< input sample -> linear light
+    float *alpha_lut;             ///< input alpha sample -> float
+    /**
+     * linear light -> gamma encoded, indexed by the float bits of the
+     * linear value, interpolated by the bits below LINEAR_DELIN_LUT_SHIFT
+     */
+    float *delin_lut;
+
+    float   *hFilter;             ///< tap k of output x at hFilter[k * dstStride + x]
+    int32_t *hFilterPos;
+    int      hFilterSize;
+    float   *vFilter;
+    int32_t *vFilterPos;
+    int      vFilterSize;
+    int      dstStride;           ///< dstW padded for SIMD, in floats
+
+    float  *src_line;             ///< linearized input line
+    float  *dst_line;             ///< output line, before store() for integer output
+    float  *ring[4];              ///< vFilterSize horizontally scaled lines per plane
+    const float **lines;          ///< vertical filter input lines
+
+    /**
+     * Convert a line of planar RGB samples to linear light.
+     */
+    void (*linearize)(float *dst, const uint8_t *src, const float *lut,
+                      int width);
+    /**
+     * Horizontally scale a line, width must be a multiple of 16 and the
+     * filter has the layout of SwsLinearContext.hFilter.
+     */
+    void (*hscale)(float *dst, const float *src, const float *filter,
+                   const int32_t *filterPos, int filterSize, int width);
+    /**
+     * Vertically scale a line.
+     */
+    void (*vscale)(float *dst, const float *const *src, const float *filter,
+                   int filterSize, int width);
+    /**
+     * Vertically scale a line and convert it from linear light.
+     */
+    void (*vscale_delin)(float *dst, const float *const *src,
+                         const float *filter, int filterSize,
+                         const float *lut, int width);
+    /**
+     * Round a line of float samples in [0, 1] to out_depth bits.
+     */
+    void (*store)(uint8_t *dst, const float *src, int width);
+} SwsLinearContext;
+
 struct SwsSlice;
 struct SwsFilterDescriptor;
 
@@ -677,11 +836,58 @@ typedef struct SwsContext {
     uint8_t     *xyz_scratch;
     unsigned int xyz_scratch_allocated;
 
+    // scratch rows for the unscaled planar YUV to RGB conversion
+    // filled with the vertically interpolated chroma of one line
+    uint16_t    *chroma_rows;
+    unsigned int chroma_rows_allocated;
+
+    /**
+     * Line converters of the unscaled planar YUV <-> RGB paths, see
+     * swscale_unscaled.c. They convert a multiple of 32 pixels, the
+     * remainder of a line is converted by the C versions.
+     */
+    yuv2rgb_chroma_row_fn yuv2rgb_chroma_row;
+    yuv2rgb_line_fn       yuv2rgb_line;
+    rgb2yuv_luma_fn       rgb2yuv_luma;
+    rgb2yuv_chroma_fn     rgb2yuv_chroma;
+    // Bayer to planar RGB line interpolation, same convention as above
+    bayer_interp_line_fn  bayer_interp_line;
+    // packed RGB <-> planar RGB, same convention with 64 pixels
+    rgb2gbrp_line_fn      rgb2gbrp_line;
+    gbrp2rgb_line_fn      gbrp2rgb_line;
+// coefficient table of yuv2rgb_line()
+#define YUV2RGB_Y_OFFSET    0
+#define YUV2RGB_Y_COEFF     1
+#define YUV2RGB_V2R         2
+#define YUV2RGB_V2G         3
+#define YUV2RGB_U2G         4
+#define YUV2RGB_U2B         5
+#define YUV2RGB_Y_SHIFT     6
+#define YUV2RGB_C_SHIFT     7
+#define YUV2RGB_NB_COEFFS   8
+// coefficient table of rgb2yuv_luma() and rgb2yuv_chroma(), starting with
+// the matrix in the order of input_rgb2yuv_table
+#define RGB2YUV_Y_ADD       9
+#define RGB2YUV_C_ADD      10
+#define RGB2YUV_Y_SHIFT    11
+#define RGB2YUV_C_SHIFT    12
+#define RGB2YUV_MAX        13
+#define RGB2YUV_NB_COEFFS  14
+
     unsigned int dst_slice_align;
+    /**
+     * Set while an unscaled converter runs on a slice of the destination,
+     * the lines of the source frame outside of the slice are then valid.
+     */
+    int src_frame_available;
     atomic_int   stride_unaligned_warned;
     atomic_int   data_unaligned_warned;
 
     Half2FloatTables *h2f_tables;
+
+    int gamma_float;              ///< use the float pipeline for gamma correct scaling
+    int ed_bands;                 ///< error diffusion in bands of SWS_ED_BAND_HEIGHT lines
+    SwsLinearContext lin;
 } SwsContext;
 //FIXME check init (where 0)
 
@@ -967,9 +1173,31 @@ void ff_get_unscaled_swscale(SwsContext *c);
 void ff_get_unscaled_swscale_ppc(SwsContext *c);
 void ff_get_unscaled_swscale_arm(SwsContext *c);
 void ff_get_unscaled_swscale_aarch64(SwsContext *c);
+void ff_get_unscaled_swscale_x86(SwsContext *c);
 
 void ff_sws_init_scale(SwsContext *c);
 
+void ff_sws_init_linear_funcs(SwsLinearContext *lin);
+void ff_sws_init_linear_funcs_x86(SwsLinearContext *lin);
+
+/**
+ * Allocate the transfer function tables and the line buffers of the float
+ * linear light pipeline, the filters must be set up already.
+ */
+int ff_sws_init_linear(SwsLinearContext *lin, double gamma, int srcW, int dstW);
+void ff_sws_uninit_linear(SwsLinearContext *lin);
+
+/**
+ * Scale output lines first .. last in linear light.
+ *
+ * @param src  planar RGB input planes, pointing to the first line of the frame
+ * @param dst  planar RGB output planes, pointing to output line first
+ */
+void ff_sws_linear_scale(SwsLinearContext *lin, int srcW, int dstW,
+                         const uint8_t *const src[4], const int srcStride[4],
+                         uint8_t *const dst[4], const int dstStride[4],
+                         int first, int last);
+
 void ff_sws_init_input_funcs(SwsContext *c);
 void ff_sws_init_output_funcs(SwsContext *c,
                               yuv2planar1_fn *yuv2plane1,
@@ -938,280 +938,236 @@ static int planarRgb16ToRgb16Wrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
-static void gbr24ptopacked24(const uint8_t *src[], int srcStride[],
-                             uint8_t *dst, int dstStride, int srcSliceH,
-                             int width)
+static int planarRgbToplanarRgbWrapper(SwsContext *c,
+                                       const uint8_t *src[], int srcStride[],
+                                       int srcSliceY, int srcSliceH,
+                                       uint8_t *dst[], int dstStride[])
 {
-    int x, h, i;
-    for (h = 0; h < srcSliceH; h++) {
-        uint8_t *dest = dst + dstStride * h;
-        for (x = 0; x < width; x++) {
-            *dest++ = src[0][x];
-            *dest++ = src[1][x];
-            *dest++ = src[2][x];
-        }
+    copyPlane(src[0], srcStride[0], srcSliceY, srcSliceH, c->srcW,
+              dst[0], dstStride[0]);
+    copyPlane(src[1], srcStride[1], srcSliceY, srcSliceH, c->srcW,
+              dst[1], dstStride[1]);
+    copyPlane(src[2], srcStride[2], srcSliceY, srcSliceH, c->srcW,
+              dst[2], dstStride[2]);
+    if (dst[3])
+        fillPlane(dst[3], dstStride[3], c->srcW, srcSliceH, srcSliceY, 255);
 
-        for (i = 0; i < 3; i++)
-            src[i] += srcStride[i];
-    }
+    return srcSliceH;
 }
 
-static void gbr24ptopacked32(const uint8_t *src[], int srcStride[],
-                             uint8_t *dst, int dstStride, int srcSliceH,
-                             int alpha_first, int width)
+/* Packed 8-bit RGB <-> planar RGB. The line functions take the planes in the
+ * order of the packed components, so that RGB and BGR share them, and are
+ * instantiated per layout so that the offsets are constant. Float planes are
+ * normalized so that 255 maps to 1.0 exactly and back. */
+
+#define U8_TO_F1(i)  (i) / 255.0f
+#define U8_TO_F4(i)  U8_TO_F1(i),  U8_TO_F1(i + 1),   U8_TO_F1(i + 2),   U8_TO_F1(i + 3)
+#define U8_TO_F16(i) U8_TO_F4(i),  U8_TO_F4(i + 4),   U8_TO_F4(i + 8),   U8_TO_F4(i + 12)
+#define U8_TO_F64(i) U8_TO_F16(i), U8_TO_F16(i + 16), U8_TO_F16(i + 32), U8_TO_F16(i + 48)
+
+static const float u8_to_float[256] = {
+    U8_TO_F64(0), U8_TO_F64(64), U8_TO_F64(128), U8_TO_F64(192)
+};
+
+static av_always_inline int float_to_u8(uint32_t v)
 {
-    int x, h, i;
-    for (h = 0; h < srcSliceH; h++) {
-        uint8_t *dest = dst + dstStride * h;
-
-        if (alpha_first) {
-            for (x = 0; x < width; x++) {
-                *dest++ = 0xff;
-                *dest++ = src[0][x];
-                *dest++ = src[1][x];
-                *dest++ = src[2][x];
-            }
-        } else {
-            for (x = 0; x < width; x++) {
-                *dest++ = src[0][x];
-                *dest++ = src[1][x];
-                *dest++ = src[2][x];
-                *dest++ = 0xff;
-            }
-        }
+    const float f = av_int2float(v);
 
-        for (i = 0; i < 3; i++)
-            src[i] += srcStride[i];
-    }
+    /* also maps NaN to 0 */
+    return f > 0.0f ? f < 1.0f ? lrintf(f * 255.0f) : 255 : 0;
 }
 
-static void gbraptopacked32(const uint8_t *src[], int srcStride[],
-                            uint8_t *dst, int dstStride, int srcSliceH,
-                            int alpha_first, int width)
-{
-    int x, h, i;
-    for (h = 0; h < srcSliceH; h++) {
-        uint8_t *dest = dst + dstStride * h;
-
-        if (alpha_first) {
-            for (x = 0; x < width; x++) {
-                *dest++ = src[3][x];
-                *dest++ = src[0][x];
-                *dest++ = src[1][x];
-                *dest++ = src[2][x];
-            }
-        } else {
-            for (x = 0; x < width; x++) {
-                *dest++ = src[0][x];
-                *dest++ = src[1][x];
-                *dest++ = src[2][x];
-                *dest++ = src[3][x];
-            }
-        }
+#define WR_U8(p, v)    (*(p) = (v))
+#define WR_F32LE(p, v) AV_WL32(p, av_float2int(u8_to_float[v]))
+#define WR_F32BE(p, v) AV_WB32(p, av_float2int(u8_to_float[v]))
+#define RD_U8(p)       (*(p))
+#define RD_F32LE(p)    float_to_u8(AV_RL32(p))
+#define RD_F32BE(p)    float_to_u8(AV_RB32(p))
+
+#define RGB2GBRP_LINE(name, alpha_first, inc_size, alpha, bps, write)          \
+static void name ## _c(uint8_t *dst[4], const uint8_t *src, int width)         \
+{                                                                              \
+    for (int x = 0; x < width; x++) {                                          \
+        const uint8_t *s = src + x * (inc_size);                               \
+                                                                               \
+        write(dst[0] + x * (bps), s[(alpha_first) + 0]);                       \
+        write(dst[1] + x * (bps), s[(alpha_first) + 1]);                       \
+        write(dst[2] + x * (bps), s[(alpha_first) + 2]);                       \
+        if (alpha)                                                             \
+            write(dst[3] + x * (bps),                                          \
+                  (inc_size) == 4 ? s[(alpha_first) ? 0 : 3] : 255);           \
+    }                                                                          \
+}
 
-        for (i = 0; i < 4; i++)
-            src[i] += srcStride[i];
-    }
+#define GBRP2RGB_LINE(name, alpha_first, inc_size, alpha, bps, read)           \
+static void name ## _c(uint8_t *dst, const uint8_t *src[4], int width)         \
+{                                                                              \
+    for (int x = 0; x < width; x++) {                                          \
+        uint8_t *d = dst + x * (inc_size);                                     \
+                                                                               \
+        d[(alpha_first) + 0] = read(src[0] + x * (bps));                       \
+        d[(alpha_first) + 1] = read(src[1] + x * (bps));                       \
+        d[(alpha_first) + 2] = read(src[2] + x * (bps));                       \
+        if ((inc_size) == 4)                                                   \
+            d[(alpha_first) ? 0 : 3] = (alpha) ? read(src[3] + x * (bps)) : 255; \
+    }                                                                          \
 }
 
-static int planarRgbaToRgbWrapper(SwsContext *c, const uint8_t *src[],
-                                  int srcStride[], int srcSliceY, int srcSliceH,
-                                  uint8_t *dst[], int dstStride[])
+#define RGB_GBRP_LINES(layout, alpha_first, inc_size)                          \
+RGB2GBRP_LINE(layout ## togbrp,       alpha_first, inc_size, 0, 1, WR_U8)      \
+RGB2GBRP_LINE(layout ## togbrap,      alpha_first, inc_size, 1, 1, WR_U8)      \
+RGB2GBRP_LINE(layout ## togbrpf32le,  alpha_first, inc_size, 0, 4, WR_F32LE)   \
+RGB2GBRP_LINE(layout ## togbrapf32le, alpha_first, inc_size, 1, 4, WR_F32LE)   \
+RGB2GBRP_LINE(layout ## togbrpf32be,  alpha_first, inc_size, 0, 4, WR_F32BE)   \
+RGB2GBRP_LINE(layout ## togbrapf32be, alpha_first, inc_size, 1, 4, WR_F32BE)   \
+GBRP2RGB_LINE(gbrpto       ## layout, alpha_first, inc_size, 0, 1, RD_U8)      \
+GBRP2RGB_LINE(gbrapto      ## layout, alpha_first, inc_size, 1, 1, RD_U8)      \
+GBRP2RGB_LINE(gbrpf32leto  ## layout, alpha_first, inc_size, 0, 4, RD_F32LE)   \
+GBRP2RGB_LINE(gbrapf32leto ## layout, alpha_first, inc_size, 1, 4, RD_F32LE)   \
+GBRP2RGB_LINE(gbrpf32beto  ## layout, alpha_first, inc_size, 0, 4, RD_F32BE)   \
+GBRP2RGB_LINE(gbrapf32beto ## layout, alpha_first, inc_size, 1, 4, RD_F32BE)
+
+RGB_GBRP_LINES(rgb24,   0, 3)
+RGB_GBRP_LINES(rgb32,   0, 4)
+RGB_GBRP_LINES(rgb32_1, 1, 4)
+
+/* indexed by the packed layout and planar_rgb_index() */
+#define RGB2GBRP_LINES(layout)                                                 \
+    { layout ## togbrp_c,       layout ## togbrap_c,                           \
+      layout ## togbrpf32le_c,  layout ## togbrapf32le_c,                      \
+      layout ## togbrpf32be_c,  layout ## togbrapf32be_c }
+#define GBRP2RGB_LINES(layout)                                                 \
+    { gbrpto       ## layout ## _c, gbrapto      ## layout ## _c,              \
+      gbrpf32leto  ## layout ## _c, gbrapf32leto ## layout ## _c,              \
+      gbrpf32beto  ## layout ## _c, gbrapf32beto ## layout ## _c }
+
+static const rgb2gbrp_line_fn rgb2gbrp_lines_c[3][6] = {
+    RGB2GBRP_LINES(rgb24), RGB2GBRP_LINES(rgb32), RGB2GBRP_LINES(rgb32_1),
+};
+
+static const gbrp2rgb_line_fn gbrp2rgb_lines_c[3][6] = {
+    GBRP2RGB_LINES(rgb24), GBRP2RGB_LINES(rgb32), GBRP2RGB_LINES(rgb32_1),
+};
+
+/* Layout of the 8-bit packed RGB formats: 0 for 24 bits, 1 for alpha last,
+ * 2 for alpha first, -1 if unsupported. order maps the packed components to
+ * the planes. */
+static int packed_rgb_layout(enum AVPixelFormat fmt, const int **order)
 {
-    int alpha_first = 0;
-    const uint8_t *src102[] = { src[1], src[0], src[2], src[3] };
-    const uint8_t *src201[] = { src[2], src[0], src[1], src[3] };
-    int stride102[] = { srcStride[1], srcStride[0], srcStride[2], srcStride[3] };
-    int stride201[] = { srcStride[2], srcStride[0], srcStride[1], srcStride[3] };
-
-    if (c->srcFormat != AV_PIX_FMT_GBRAP) {
-        av_log(c, AV_LOG_ERROR, "unsupported planar RGB conversion %s -> %s\n",
-               av_get_pix_fmt_name(c->srcFormat),
-               av_get_pix_fmt_name(c->dstFormat));
-        return srcSliceH;
+    static const int order201[4] = { 2, 0, 1, 3 };
+    static const int order102[4] = { 1, 0, 2, 3 };
+
+    switch (fmt) {
+    case AV_PIX_FMT_RGB24: *order = order201; return 0;
+    case AV_PIX_FMT_BGR24: *order = order102; return 0;
+    case AV_PIX_FMT_RGBA:  *order = order201; return 1;
+    case AV_PIX_FMT_BGRA:  *order = order102; return 1;
+    case AV_PIX_FMT_ARGB:  *order = order201; return 2;
+    case AV_PIX_FMT_ABGR:  *order = order102; return 2;
+    default:               return -1;
     }
+}
 
-    switch (c->dstFormat) {
-    case AV_PIX_FMT_BGR24:
-        gbr24ptopacked24(src102, stride102,
-                         dst[0] + srcSliceY * dstStride[0], dstStride[0],
-                         srcSliceH, c->srcW);
-        break;
-
-    case AV_PIX_FMT_RGB24:
-        gbr24ptopacked24(src201, stride201,
-                         dst[0] + srcSliceY * dstStride[0], dstStride[0],
-                         srcSliceH, c->srcW);
-        break;
+static int planar_rgb_index(enum AVPixelFormat fmt)
+{
+    return (isFloat(fmt) ? isBE(fmt) ? 4 : 2 : 0) + !!isALPHA(fmt);
+}
 
-    case AV_PIX_FMT_ARGB:
-        alpha_first = 1;
-    case AV_PIX_FMT_RGBA:
-        gbraptopacked32(src201, stride201,
-                        dst[0] + srcSliceY * dstStride[0], dstStride[0],
-                        srcSliceH, alpha_first, c->srcW);
-        break;
+static rgb2gbrp_line_fn get_rgb2gbrp_line_c(enum AVPixelFormat src_fmt,
+                                            enum AVPixelFormat dst_fmt)
+{
+    const int *order;
+    const int layout = packed_rgb_layout(src_fmt, &order);
 
-    case AV_PIX_FMT_ABGR:
-        alpha_first = 1;
-    case AV_PIX_FMT_BGRA:
-        gbraptopacked32(src102, stride102,
-                        dst[0] + srcSliceY * dstStride[0], dstStride[0],
-                        srcSliceH, alpha_first, c->srcW);
-        break;
+    return layout < 0 ? NULL : rgb2gbrp_lines_c[layout][planar_rgb_index(dst_fmt)];
+}
 
-    default:
-        av_log(c, AV_LOG_ERROR,
-               "unsupported planar RGB conversion %s -> %s\n",
-               av_get_pix_fmt_name(c->srcFormat),
-               av_get_pix_fmt_name(c->dstFormat));
-    }
+static gbrp2rgb_line_fn get_gbrp2rgb_line_c(enum AVPixelFormat src_fmt,
+                                            enum AVPixelFormat dst_fmt)
+{
+    const int *order;
+    const int layout = packed_rgb_layout(dst_fmt, &order);
 
-    return srcSliceH;
+    return layout < 0 ? NULL : gbrp2rgb_lines_c[layout][planar_rgb_index(src_fmt)];
 }
 
-static int planarRgbToRgbWrapper(SwsContext *c, const uint8_t *src[],
+static int rgbToPlanarRgbWrapper(SwsContext *c, const uint8_t *src[],
                                  int srcStride[], int srcSliceY, int srcSliceH,
                                  uint8_t *dst[], int dstStride[])
 {
-    int alpha_first = 0;
-    const uint8_t *src102[] = { src[1], src[0], src[2] };
-    const uint8_t *src201[] = { src[2], src[0], src[1] };
-    int stride102[] = { srcStride[1], srcStride[0], srcStride[2] };
-    int stride201[] = { srcStride[2], srcStride[0], srcStride[1] };
-
-    if (c->srcFormat != AV_PIX_FMT_GBRP) {
-        av_log(c, AV_LOG_ERROR, "unsupported planar RGB conversion %s -> %s\n",
-               av_get_pix_fmt_name(c->srcFormat),
-               av_get_pix_fmt_name(c->dstFormat));
-        return srcSliceH;
-    }
-
-    switch (c->dstFormat) {
-    case AV_PIX_FMT_BGR24:
-        gbr24ptopacked24(src102, stride102,
-                         dst[0] + srcSliceY * dstStride[0], dstStride[0],
-                         srcSliceH, c->srcW);
-        break;
-
-    case AV_PIX_FMT_RGB24:
-        gbr24ptopacked24(src201, stride201,
-                         dst[0] + srcSliceY * dstStride[0], dstStride[0],
-                         srcSliceH, c->srcW);
-        break;
-
-    case AV_PIX_FMT_ARGB:
-        alpha_first = 1;
-    case AV_PIX_FMT_RGBA:
-        gbr24ptopacked32(src201, stride201,
-                         dst[0] + srcSliceY * dstStride[0], dstStride[0],
-                         srcSliceH, alpha_first, c->srcW);
-        break;
-
-    case AV_PIX_FMT_ABGR:
-        alpha_first = 1;
-    case AV_PIX_FMT_BGRA:
-        gbr24ptopacked32(src102, stride102,
-                         dst[0] + srcSliceY * dstStride[0], dstStride[0],
-                         srcSliceH, alpha_first, c->srcW);
-        break;
-
-    default:
+    const rgb2gbrp_line_fn line_c = get_rgb2gbrp_line_c(c->srcFormat,
+                                                        c->dstFormat);
+    const int *order;
+    const int layout  = packed_rgb_layout(c->srcFormat, &order);
+    const int planes  = 3 + !!isALPHA(c->dstFormat);
+    const int in_bpp  = layout ? 4 : 3;
+    const int out_bps = isFloat(c->dstFormat) ? 4 : 1;
+    /* the context function converts a multiple of 64 pixels, the C one the
+     * rest of the line */
+    const int main_w  = c->srcW & ~63;
+
+    if (layout < 0) {
         av_log(c, AV_LOG_ERROR,
                "unsupported planar RGB conversion %s -> %s\n",
                av_get_pix_fmt_name(c->srcFormat),
                av_get_pix_fmt_name(c->dstFormat));
+        return srcSliceH;
     }
 
-    return srcSliceH;
-}
+    for (int y = 0; y < srcSliceH; y++) {
+        const uint8_t *s = src[0] + y * srcStride[0];
+        uint8_t *d[4] = { NULL };
 
-static int planarRgbToplanarRgbWrapper(SwsContext *c,
-                                       const uint8_t *src[], int srcStride[],
-                                       int srcSliceY, int srcSliceH,
-                                       uint8_t *dst[], int dstStride[])
-{
-    copyPlane(src[0], srcStride[0], srcSliceY, srcSliceH, c->srcW,
-              dst[0], dstStride[0]);
-    copyPlane(src[1], srcStride[1], srcSliceY, srcSliceH, c->srcW,
-              dst[1], dstStride[1]);
-    copyPlane(src[2], srcStride[2], srcSliceY, srcSliceH, c->srcW,
-              dst[2], dstStride[2]);
-    if (dst[3])
-        fillPlane(dst[3], dstStride[3], c->srcW, srcSliceH, srcSliceY, 255);
-
-    return srcSliceH;
-}
-
-static void packedtogbr24p(const uint8_t *src, int srcStride,
-                           uint8_t *dst[], int dstStride[], int srcSliceH,
-                           int alpha_first, int inc_size, int width)
-{
-    uint8_t *dest[3];
-    int x, h;
-
-    dest[0] = dst[0];
-    dest[1] = dst[1];
-    dest[2] = dst[2];
-
-    if (alpha_first)
-        src++;
-
-    for (h = 0; h < srcSliceH; h++) {
-        for (x = 0; x < width; x++) {
-            dest[0][x] = src[0];
-            dest[1][x] = src[1];
-            dest[2][x] = src[2];
+        for (int i = 0; i < planes; i++)
+            d[i] = dst[order[i]] + (srcSliceY + y) * dstStride[order[i]];
 
-            src += inc_size;
+        if (main_w)
+            c->rgb2gbrp_line(d, s, main_w);
+        if (main_w < c->srcW) {
+            for (int i = 0; i < planes; i++)
+                d[i] += main_w * out_bps;
+            line_c(d, s + main_w * in_bpp, c->srcW - main_w);
         }
-        src     += srcStride - width * inc_size;
-        dest[0] += dstStride[0];
-        dest[1] += dstStride[1];
-        dest[2] += dstStride[2];
     }
+
+    return srcSliceH;
 }
 
-static int rgbToPlanarRgbWrapper(SwsContext *c, const uint8_t *src[],
+static int planarRgbToRgbWrapper(SwsContext *c, const uint8_t *src[],
                                  int srcStride[], int srcSliceY, int srcSliceH,
                                  uint8_t *dst[], int dstStride[])
 {
-    int alpha_first = 0;
-    int stride102[] = { dstStride[1], dstStride[0], dstStride[2] };
-    int stride201[] = { dstStride[2], dstStride[0], dstStride[1] };
-    uint8_t *dst102[] = { dst[1] + srcSliceY * dstStride[1],
-                          dst[0] + srcSliceY * dstStride[0],
-                          dst[2] + srcSliceY * dstStride[2] };
-    uint8_t *dst201[] = { dst[2] + srcSliceY * dstStride[2],
-                          dst[0] + srcSliceY * dstStride[0],
-                          dst[1] + srcSliceY * dstStride[1] };
-
-    switch (c->srcFormat) {
-    case AV_PIX_FMT_RGB24:
-        packedtogbr24p((const uint8_t *) src[0], srcStride[0], dst201,
-                       stride201, srcSliceH, alpha_first, 3, c->srcW);
-        break;
-    case AV_PIX_FMT_BGR24:
-        packedtogbr24p((const uint8_t *) src[0], srcStride[0], dst102,
-                       stride102, srcSliceH, alpha_first, 3, c->srcW);
-        break;
-    case AV_PIX_FMT_ARGB:
-        alpha_first = 1;
-    case AV_PIX_FMT_RGBA:
-        packedtogbr24p((const uint8_t *) src[0], srcStride[0], dst201,
-                       stride201, srcSliceH, alpha_first, 4, c->srcW);
-        break;
-    case AV_PIX_FMT_ABGR:
-        alpha_first = 1;
-    case AV_PIX_FMT_BGRA:
-        packedtogbr24p((const uint8_t *) src[0], srcStride[0], dst102,
-                       stride102, srcSliceH, alpha_first, 4, c->srcW);
-        break;
-    default:
+    const gbrp2rgb_line_fn line_c = get_gbrp2rgb_line_c(c->srcFormat,
+                                                        c->dstFormat);
+    const int *order;
+    const int layout  = packed_rgb_layout(c->dstFormat, &order);
+    const int planes  = 3 + !!isALPHA(c->srcFormat);
+    const int in_bps  = isFloat(c->srcFormat) ? 4 : 1;
+    const int out_bpp = layout ? 4 : 3;
+    const int main_w  = c->srcW & ~63;
+
+    if (layout < 0) {
         av_log(c, AV_LOG_ERROR,
                "unsupported planar RGB conversion %s -> %s\n",
                av_get_pix_fmt_name(c->srcFormat),
                av_get_pix_fmt_name(c->dstFormat));
+        return srcSliceH;
+    }
+
+    for (int y = 0; y < srcSliceH; y++) {
+        const uint8_t *s[4] = { NULL };
+        uint8_t *d = dst[0] + (srcSliceY + y) * dstStride[0];
+
+        for (int i = 0; i < planes; i++)
+            s[i] = src[order[i]] + y * srcStride[order[i]];
+
+        if (main_w)
+            c->gbrp2rgb_line(d, s, main_w);
+        if (main_w < c->srcW) {
+            for (int i = 0; i < planes; i++)
+                s[i] += main_w * in_bps;
+            line_c(d + main_w * out_bpp, s, c->srcW - main_w);
+        }
     }
 
     return srcSliceH;
@@ -1277,6 +1233,121 @@ static int rgbToPlanarRgbWrapper(SwsContext *c, const uint8_t *src[],
 #define BAYER_RENAME(x) bayer_rggb16be_to_##x
 #include "bayer_template.c"
 
+#define BAYER_INTERP_LINE(name, out_type, read, bps, shift)                    \
+static void bayer_interp_line_ ## name ## _c(uint8_t *dst_c8, uint8_t *dst_g8, \
+                                             uint8_t *dst_o8, const uint8_t *src, \
+                                             ptrdiff_t src_stride, int width)  \
+{                                                                              \
+    out_type *dst_c = (out_type *)dst_c8;                                      \
+    out_type *dst_g = (out_type *)dst_g8;                                      \
+    out_type *dst_o = (out_type *)dst_o8;                                      \
+    const uint8_t *a = src - src_stride, *b = src + src_stride;                \
+                                                                               \
+    for (int x = 0; x < width; x += 2) {                                       \
+        const int i = x * bps;                                                 \
+        dst_c[x]     =  read(src + i) >> (shift);                              \
+        dst_g[x]     = (read(a + i) + read(b + i) +                            \
+                        read(src + i - bps) + read(src + i + bps)) >> (2 + (shift)); \
+        dst_o[x]     = (read(a + i - bps) + read(a + i + bps) +                \
+                        read(b + i - bps) + read(b + i + bps)) >> (2 + (shift)); \
+        dst_c[x + 1] = (read(src + i) + read(src + i + 2 * bps)) >> (1 + (shift)); \
+        dst_g[x + 1] =  read(src + i + bps) >> (shift);                        \
+        dst_o[x + 1] = (read(a + i + bps) + read(b + i + bps)) >> (1 + (shift)); \
+    }                                                                          \
+}
+
+#define READ_8(p) (*(p))
+
+BAYER_INTERP_LINE(8,         uint8_t,  READ_8,  1, 0)
+BAYER_INTERP_LINE(16le,      uint16_t, AV_RL16, 2, 0)
+BAYER_INTERP_LINE(16be,      uint16_t, AV_RB16, 2, 0)
+BAYER_INTERP_LINE(16le_to_8, uint8_t,  AV_RL16, 2, 8)
+BAYER_INTERP_LINE(16be_to_8, uint8_t,  AV_RB16, 2, 8)
+
+static bayer_interp_line_fn get_bayer_interp_line_c(enum AVPixelFormat src_fmt,
+                                                    enum AVPixelFormat dst_fmt)
+{
+    const int out16 = dst_fmt == AV_PIX_FMT_GBRP16;
+
+    if (!isBayer16BPS(src_fmt))
+        return bayer_interp_line_8_c;
+    if (isBE(src_fmt))
+        return out16 ? bayer_interp_line_16be_c : bayer_interp_line_16be_to_8_c;
+    return out16 ? bayer_interp_line_16le_c : bayer_interp_line_16le_to_8_c;
+}
+
+typedef void (*bayer_gbrp_copy_fn)(const uint8_t *src, int src_stride,
+                                   uint8_t *dst[3], const int dst_stride[3],
+                                   int width);
+
+/* Demosaic a line pair of the interior of the frame to GBRP/GBRP16. The line
+ * functions take the colour sampled on their line at the even pixels, on the
+ * lines where it is at the odd ones they start one pixel earlier. The two
+ * pixels at each end are copied, like in the template. */
+static void bayer_to_gbrp_interpolate(SwsContext *c, bayer_gbrp_copy_fn copy,
+                                      const uint8_t *src, int src_stride,
+                                      uint8_t *dst[3], const int dst_stride[3])
+{
+    const bayer_interp_line_fn line_c = get_bayer_interp_line_c(c->srcFormat,
+                                                                c->dstFormat);
+    const enum AVPixelFormat fmt = c->srcFormat;
+    const int in_bps  = 1 + isBayer16BPS(fmt);
+    const int out_bps = 1 + (c->dstFormat == AV_PIX_FMT_GBRP16);
+    const int width   = c->srcW;
+    uint8_t *dst_end[3];
+    int plane0, odd0;
+
+    /* plane of the colour sampled on the first line and its parity, the
+     * other colour is on the second line, at the other parity */
+    switch (fmt) {
+    case AV_PIX_FMT_BAYER_BGGR8:
+    case AV_PIX_FMT_BAYER_BGGR16LE:
+    case AV_PIX_FMT_BAYER_BGGR16BE: plane0 = 1; odd0 = 0; break;
+    case AV_PIX_FMT_BAYER_RGGB8:
+    case AV_PIX_FMT_BAYER_RGGB16LE:
+    case AV_PIX_FMT_BAYER_RGGB16BE: plane0 = 2; odd0 = 0; break;
+    case AV_PIX_FMT_BAYER_GBRG8:
+    case AV_PIX_FMT_BAYER_GBRG16LE:
+    case AV_PIX_FMT_BAYER_GBRG16BE: plane0 = 1; odd0 = 1; break;
+    default:                        plane0 = 2; odd0 = 1; break;
+    }
+
+    for (int l = 0; l < 2 && width >= 4; l++) {
+        const int odd = odd0 ^ l;
+        const int pc  = l ? 3 - plane0 : plane0;
+        const int po  = 3 - pc;
+        const int x   = 2 - odd;
+        const int w   = width - 4 + 2 * odd;
+        /* the context function converts a multiple of 32 pixels, the C one
+         * the rest of the line */
+        const int main_w = w & ~31;
+        const uint8_t *s = src + l * src_stride + x * in_bps;
+        uint8_t *dc = dst[pc] + l * dst_stride[pc] + x * out_bps;
+        uint8_t *dg = dst[0]  + l * dst_stride[0]  + x * out_bps;
+        uint8_t *dp = dst[po] + l * dst_stride[po] + x * out_bps;
+
+        if (main_w)
+            c->bayer_interp_line(dc, dg, dp, s, src_stride, main_w);
+        line_c(dc + main_w * out_bps, dg + main_w * out_bps,
+               dp + main_w * out_bps, s + main_w * in_bps, src_stride,
+               w - main_w);
+    }
+
+    copy(src, src_stride, dst, dst_stride, 2);
+    for (int p = 0; p < 3; p++)
+        dst_end[p] = dst[p] + (width - 2) * out_bps;
+    copy(src + (width - 2) * in_bps, src_stride, dst_end, dst_stride, 2);
+}
+
+/* Lines are demosaiced in pairs, the outer pairs of the frame are copied and
+ * all others interpolated from their neighbours. For a destination slice the
+ * whole source frame is available and the slice borders are interpolated
+ * across, so the output does not depend on the slicing. */
+#define BAYER_SLICE_BOUNDS                                                     \
+    const int frame_y = c->src_frame_available ? srcSliceY : 0;                \
+    const int frame_h = c->src_frame_available ? c->srcH   : srcSliceH;        \
+    av_assert0(frame_h > 1);
+
 static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcStride[], int srcSliceY,
                                   int srcSliceH, uint8_t* dst[], int dstStride[])
 {
@@ -1285,6 +1356,7 @@ static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
     int i;
     void (*copy)       (const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
     void (*interpolate)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
+    BAYER_SLICE_BOUNDS
 
     switch(c->srcFormat) {
 #define CASE(pixfmt, prefix) \
@@ -1307,22 +1379,18 @@ static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
     default: return 0;
     }
 
-    av_assert0(srcSliceH > 1);
-
-    copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
-    srcPtr += 2 * srcStride[0];
-    dstPtr += 2 * dstStride[0];
+    for (i = 0; i < srcSliceH; i += 2) {
+        const int y = frame_y + i;
 
-    for (i = 2; i < srcSliceH - 2; i += 2) {
-        interpolate(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+        if (y >= 2 && y + 2 < frame_h)
+            interpolate(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+        else if (y + 1 == frame_h)
+            copy(srcPtr, -srcStride[0], dstPtr, -dstStride[0], c->srcW);
+        else
+            copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
         srcPtr += 2 * srcStride[0];
         dstPtr += 2 * dstStride[0];
     }
-
-    if (i + 1 == srcSliceH) {
-        copy(srcPtr, -srcStride[0], dstPtr, -dstStride[0], c->srcW);
-    } else if (i < srcSliceH)
-        copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
     return srcSliceH;
 }
 
@@ -1334,6 +1402,7 @@ static int bayer_to_rgb48_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
     int i;
     void (*copy)       (const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
     void (*interpolate)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
+    BAYER_SLICE_BOUNDS
 
     switch(c->srcFormat) {
 #define CASE(pixfmt, prefix) \
@@ -1356,22 +1425,18 @@ static int bayer_to_rgb48_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
     default: return 0;
     }
 
-    av_assert0(srcSliceH > 1);
-
-    copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
-    srcPtr += 2 * srcStride[0];
-    dstPtr += 2 * dstStride[0];
+    for (i = 0; i < srcSliceH; i += 2) {
+        const int y = frame_y + i;
 
-    for (i = 2; i < srcSliceH - 2; i += 2) {
-        interpolate(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+        if (y >= 2 && y + 2 < frame_h)
+            interpolate(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+        else if (y + 1 == frame_h)
+            copy(srcPtr, -srcStride[0], dstPtr, -dstStride[0], c->srcW);
+        else
+            copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
         srcPtr += 2 * srcStride[0];
         dstPtr += 2 * dstStride[0];
     }
-
-    if (i + 1 == srcSliceH) {
-        copy(srcPtr, -srcStride[0], dstPtr, -dstStride[0], c->srcW);
-    } else if (i < srcSliceH)
-        copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
     return srcSliceH;
 }
 
@@ -1385,6 +1450,7 @@ static int bayer_to_yv12_wrapper(SwsContext *c, const uint8_t* src[], int srcStr
     int i;
     void (*copy)       (const uint8_t *src, int src_stride, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, int luma_stride, int width, int32_t *rgb2yuv);
     void (*interpolate)(const uint8_t *src, int src_stride, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, int luma_stride, int width, int32_t *rgb2yuv);
+    BAYER_SLICE_BOUNDS
 
     switch(c->srcFormat) {
 #define CASE(pixfmt, prefix) \
@@ -1407,26 +1473,114 @@ static int bayer_to_yv12_wrapper(SwsContext *c, const uint8_t* src[], int srcStr
     default: return 0;
     }
 
-    av_assert0(srcSliceH > 1);
+    for (i = 0; i < srcSliceH; i += 2) {
+        const int y = frame_y + i;
 
-    copy(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
-    srcPtr += 2 * srcStride[0];
-    dstY   += 2 * dstStride[0];
-    dstU   +=     dstStride[1];
-    dstV   +=     dstStride[1];
-
-    for (i = 2; i < srcSliceH - 2; i += 2) {
-        interpolate(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
+        if (y >= 2 && y + 2 < frame_h)
+            interpolate(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
+        else if (y + 1 == frame_h)
+            copy(srcPtr, -srcStride[0], dstY, dstU, dstV, -dstStride[0], c->srcW, c->input_rgb2yuv_table);
+        else
+            copy(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
         srcPtr += 2 * srcStride[0];
         dstY   += 2 * dstStride[0];
         dstU   +=     dstStride[1];
-        dstV   +=     dstStride[1];
+        dstV   +=     dstStride[2];
+    }
+    return srcSliceH;
+}
+
+static int bayer_to_gbrp_wrapper(SwsContext *c, const uint8_t* src[], int srcStride[], int srcSliceY,
+                                  int srcSliceH, uint8_t* dst[], int dstStride[])
+{
+    const int negStride[3] = { -dstStride[0], -dstStride[1], -dstStride[2] };
+    uint8_t *dstPtr[3];
+    const uint8_t *srcPtr= src[0];
+    int i, p;
+    bayer_gbrp_copy_fn copy;
+    BAYER_SLICE_BOUNDS
+
+    switch(c->srcFormat) {
+#define CASE(pixfmt, prefix) \
+    case pixfmt: copy = bayer_##prefix##_to_gbrp_copy; \
+                 break;
+    CASE(AV_PIX_FMT_BAYER_BGGR8,    bggr8)
+    CASE(AV_PIX_FMT_BAYER_BGGR16LE, bggr16le)
+    CASE(AV_PIX_FMT_BAYER_BGGR16BE, bggr16be)
+    CASE(AV_PIX_FMT_BAYER_RGGB8,    rggb8)
+    CASE(AV_PIX_FMT_BAYER_RGGB16LE, rggb16le)
+    CASE(AV_PIX_FMT_BAYER_RGGB16BE, rggb16be)
+    CASE(AV_PIX_FMT_BAYER_GBRG8,    gbrg8)
+    CASE(AV_PIX_FMT_BAYER_GBRG16LE, gbrg16le)
+    CASE(AV_PIX_FMT_BAYER_GBRG16BE, gbrg16be)
+    CASE(AV_PIX_FMT_BAYER_GRBG8,    grbg8)
+    CASE(AV_PIX_FMT_BAYER_GRBG16LE, grbg16le)
+    CASE(AV_PIX_FMT_BAYER_GRBG16BE, grbg16be)
+#undef CASE
+    default: return 0;
     }
 
-    if (i + 1 == srcSliceH) {
-        copy(srcPtr, -srcStride[0], dstY, dstU, dstV, -dstStride[0], c->srcW, c->input_rgb2yuv_table);
-    } else if (i < srcSliceH)
-        copy(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
+    for (p = 0; p < 3; p++)
+        dstPtr[p] = dst[p] + srcSliceY * dstStride[p];
+
+    for (i = 0; i < srcSliceH; i += 2) {
+        const int y = frame_y + i;
+
+        if (y >= 2 && y + 2 < frame_h)
+            bayer_to_gbrp_interpolate(c, copy, srcPtr, srcStride[0], dstPtr, dstStride);
+        else if (y + 1 == frame_h)
+            copy(srcPtr, -srcStride[0], dstPtr, negStride, c->srcW);
+        else
+            copy(srcPtr, srcStride[0], dstPtr, dstStride, c->srcW);
+        srcPtr += 2 * srcStride[0];
+        for (p = 0; p < 3; p++)
+            dstPtr[p] += 2 * dstStride[p];
+    }
+    return srcSliceH;
+}
+
+static int bayer_to_gbrp16_wrapper(SwsContext *c, const uint8_t* src[], int srcStride[], int srcSliceY,
+                                  int srcSliceH, uint8_t* dst[], int dstStride[])
+{
+    const int negStride[3] = { -dstStride[0], -dstStride[1], -dstStride[2] };
+    uint8_t *dstPtr[3];
+    const uint8_t *srcPtr= src[0];
+    int i, p;
+    bayer_gbrp_copy_fn copy;
+    BAYER_SLICE_BOUNDS
+
+    switch(c->srcFormat) {
+#define CASE(pixfmt, prefix) \
+    case pixfmt: copy = bayer_##prefix##_to_gbrp16_copy; \
+                 break;
+    CASE(AV_PIX_FMT_BAYER_BGGR16LE, bggr16le)
+    CASE(AV_PIX_FMT_BAYER_BGGR16BE, bggr16be)
+    CASE(AV_PIX_FMT_BAYER_RGGB16LE, rggb16le)
+    CASE(AV_PIX_FMT_BAYER_RGGB16BE, rggb16be)
+    CASE(AV_PIX_FMT_BAYER_GBRG16LE, gbrg16le)
+    CASE(AV_PIX_FMT_BAYER_GBRG16BE, gbrg16be)
+    CASE(AV_PIX_FMT_BAYER_GRBG16LE, grbg16le)
+    CASE(AV_PIX_FMT_BAYER_GRBG16BE, grbg16be)
+#undef CASE
+    default: return 0;
+    }
+
+    for (p = 0; p < 3; p++)
+        dstPtr[p] = dst[p] + srcSliceY * dstStride[p];
+
+    for (i = 0; i < srcSliceH; i += 2) {
+        const int y = frame_y + i;
+
+        if (y >= 2 && y + 2 < frame_h)
+            bayer_to_gbrp_interpolate(c, copy, srcPtr, srcStride[0], dstPtr, dstStride);
+        else if (y + 1 == frame_h)
+            copy(srcPtr, -srcStride[0], dstPtr, negStride, c->srcW);
+        else
+            copy(srcPtr, srcStride[0], dstPtr, dstStride, c->srcW);
+        srcPtr += 2 * srcStride[0];
+        for (p = 0; p < 3; p++)
+            dstPtr[p] += 2 * dstStride[p];
+    }
     return srcSliceH;
 }
 
@@ -1670,6 +1824,455 @@ static int yvu9ToYv12Wrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
+/* planar YUV -> RGB24/GBRP/GBRPF32 using the same fixed point coefficients
+ * as the full chroma output functions, BGR24 is RGB24 with U and V and their
+ * coefficients swapped; chroma is interpolated with centered siting,
+ * vertically by yuv2rgb_chroma_row() and horizontally here */
+static av_always_inline void
+planar_yuv_to_rgb_line(uint8_t *dst[3], const uint8_t *srcY8,
+                       const uint16_t *srcU, const uint16_t *srcV,
+                       const int32_t *k, int width, int hsub, int is16,
+                       enum AVPixelFormat target)
+{
+    const uint16_t *srcY16 = (const uint16_t *)srcY8;
+    const int sh      = target == AV_PIX_FMT_GBRPF32 ? 14 : 22;
+    const int y_sh    = k[YUV2RGB_Y_SHIFT];
+    const int c_sh    = k[YUV2RGB_C_SHIFT];
+    const int uv_off  = 128 << 9;
+    const int y_off   = k[YUV2RGB_Y_OFFSET];
+    const int y_coeff = k[YUV2RGB_Y_COEFF];
+    const int v2r = k[YUV2RGB_V2R], v2g = k[YUV2RGB_V2G];
+    const int u2g = k[YUV2RGB_U2G], u2b = k[YUV2RGB_U2B];
+    static const float float_mult = 1.0f / 65535.0f;
+    int i;
+
+    for (i = 0; i < width; i++) {
+        const int c0 = i >> hsub;
+        int Y, U, V, R, G, B;
+
+        Y = (is16 ? srcY16[i] : srcY8[i]) << y_sh;
+        if (hsub) {
+            /* the chroma rows are padded, no clipping needed */
+            const int c1 = i & 1 ? c0 + 1 : c0 - 1;
+            U = (3 * srcU[c0] + srcU[c1]) << c_sh;
+            V = (3 * srcV[c0] + srcV[c1]) << c_sh;
+        } else {
+            U = srcU[c0] << c_sh;
+            V = srcV[c0] << c_sh;
+        }
+        U -= uv_off;
+        V -= uv_off;
+
+        Y  = (Y - y_off) * y_coeff + (1 << (sh - 1));
+        R  = Y + V * v2r;
+        G  = Y + V * v2g + U * u2g;
+        B  = Y +           U * u2b;
+
+        if ((R | G | B) & 0xC0000000) {
+            R = av_clip_uintp2(R, 30);
+            G = av_clip_uintp2(G, 30);
+            B = av_clip_uintp2(B, 30);
+        }
+
+        switch (target) {
+        case AV_PIX_FMT_RGB24:
+            dst[0][3 * i + 0] = R >> 22;
+            dst[0][3 * i + 1] = G >> 22;
+            dst[0][3 * i + 2] = B >> 22;
+            break;
+        case AV_PIX_FMT_GBRP:
+            dst[0][i] = G >> 22;
+            dst[1][i] = B >> 22;
+            dst[2][i] = R >> 22;
+            break;
+        case AV_PIX_FMT_GBRPF32:
+            ((float *)dst[0])[i] = float_mult * (G >> 14);
+            ((float *)dst[1])[i] = float_mult * (B >> 14);
+            ((float *)dst[2])[i] = float_mult * (R >> 14);
+            break;
+        }
+    }
+}
+
+#define YUV2RGB_LINE_FUNC(name, hsub, is16, target)                           \
+static void name(uint8_t *dst[3], const uint8_t *srcY,                        \
+                 const uint16_t *srcU, const uint16_t *srcV,                  \
+                 const int32_t *coeffs, int width)                            \
+{                                                                             \
+    planar_yuv_to_rgb_line(dst, srcY, srcU, srcV, coeffs, width, hsub, is16,  \
+                           target);                                           \
+}
+
+#define YUV2RGB_LINE_FUNCS(name, target)                                      \
+YUV2RGB_LINE_FUNC(name ## _444_8_line,  0, 0, target)                         \
+YUV2RGB_LINE_FUNC(name ## _444_16_line, 0, 1, target)                         \
+YUV2RGB_LINE_FUNC(name ## _422_8_line,  1, 0, target)                         \
+YUV2RGB_LINE_FUNC(name ## _422_16_line, 1, 1, target)
+
+YUV2RGB_LINE_FUNCS(yuv2rgb24,   AV_PIX_FMT_RGB24)
+YUV2RGB_LINE_FUNCS(yuv2gbrp,    AV_PIX_FMT_GBRP)
+YUV2RGB_LINE_FUNCS(yuv2gbrpf32, AV_PIX_FMT_GBRPF32)
+
+/* Weight the nearest chroma row 3:1 with the next nearest one, which is the
+ * same row without vertical subsampling, so every row has a total weight of
+ * 4. 4:2:0 is 4:2:2 afterwards. */
+static av_always_inline void
+yuv2rgb_chroma_row(uint16_t *dst, const uint8_t *src0, const uint8_t *src1,
+                   int width, int is16)
+{
+    const uint16_t *src0_16 = (const uint16_t *)src0;
+    const uint16_t *src1_16 = (const uint16_t *)src1;
+    int i;
+
+    for (i = 0; i < width; i++)
+        dst[i] = is16 ? 3 * src0_16[i] + src1_16[i] : 3 * src0[i] + src1[i];
+}
+
+static void yuv2rgb_chroma_row_8(uint16_t *dst, const uint8_t *src0,
+                                 const uint8_t *src1, int width)
+{
+    yuv2rgb_chroma_row(dst, src0, src1, width, 0);
+}
+
+static void yuv2rgb_chroma_row_16(uint16_t *dst, const uint8_t *src0,
+                                  const uint8_t *src1, int width)
+{
+    yuv2rgb_chroma_row(dst, src0, src1, width, 1);
+}
+
+static yuv2rgb_line_fn get_yuv2rgb_line_c(enum AVPixelFormat dstFormat,
+                                          int hsub, int is16)
+{
+#define SELECT(name) hsub ? is16 ? name ## _422_16_line : name ## _422_8_line  \
+                          : is16 ? name ## _444_16_line : name ## _444_8_line
+    switch (dstFormat) {
+    case AV_PIX_FMT_RGB24:
+    case AV_PIX_FMT_BGR24:   return SELECT(yuv2rgb24);
+    case AV_PIX_FMT_GBRP:    return SELECT(yuv2gbrp);
+    case AV_PIX_FMT_GBRPF32: return SELECT(yuv2gbrpf32);
+    }
+#undef SELECT
+    return NULL;
+}
+
+static int planarYuvToRgbWrapper(SwsContext *c, const uint8_t *src[],
+                                 int srcStride[], int srcSliceY, int srcSliceH,
+                                 uint8_t *dst[], int dstStride[])
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    const int depth = desc->comp[0].depth;
+    const int hsub  = desc->log2_chroma_w;
+    const int vsub  = desc->log2_chroma_h;
+    const int chr_w = AV_CEIL_RSHIFT(c->srcW, hsub);
+    const int chr_y = srcSliceY >> vsub;
+    const int nb_planes = isPlanar(c->dstFormat) ? 3 : 1;
+    const int swap_uv   = c->dstFormat == AV_PIX_FMT_BGR24;
+    /* chroma rows that may be read, relative to src[1] and src[2] */
+    const int chr_min = c->src_frame_available ? -chr_y : 0;
+    const int chr_max = (c->src_frame_available ? AV_CEIL_RSHIFT(c->srcH, vsub)
+                                                : AV_CEIL_RSHIFT(srcSliceY + srcSliceH, vsub))
+                        - chr_y - 1;
+    const int row_size = FFALIGN(chr_w + 2, 16);
+    /* the context functions convert a multiple of 32 pixels, the C ones the
+     * rest of the line */
+    const int main_w     = c->srcW & ~31;
+    const int main_chr_w = main_w >> hsub;
+    const int dst_bpp    = c->dstFormat == AV_PIX_FMT_GBRPF32 ? 4 : nb_planes == 1 ? 3 : 1;
+    const yuv2rgb_chroma_row_fn chroma_row_c = depth > 8 ? yuv2rgb_chroma_row_16
+                                                         : yuv2rgb_chroma_row_8;
+    const yuv2rgb_line_fn line_c = get_yuv2rgb_line_c(c->dstFormat, hsub, depth > 8);
+    int32_t k[YUV2RGB_NB_COEFFS] = {
+        c->yuv2rgb_y_offset,  c->yuv2rgb_y_coeff,
+        c->yuv2rgb_v2r_coeff, c->yuv2rgb_v2g_coeff,
+        c->yuv2rgb_u2g_coeff, c->yuv2rgb_u2b_coeff,
+        17 - depth, 15 - depth - 2 * hsub,
+    };
+    uint8_t *dstp[3] = { NULL }, *dst_rest[3] = { NULL };
+    uint16_t *rows[2];
+    int y, p;
+
+    av_fast_malloc(&c->chroma_rows, &c->chroma_rows_allocated,
+                   2 * row_size * sizeof(*c->chroma_rows));
+    if (!c->chroma_rows)
+        return AVERROR(ENOMEM);
+    rows[0] = c->chroma_rows + 1;
+    rows[1] = c->chroma_rows + 1 + row_size;
+
+    if (swap_uv) {
+        FFSWAP(int32_t, k[YUV2RGB_V2R], k[YUV2RGB_U2B]);
+        FFSWAP(int32_t, k[YUV2RGB_V2G], k[YUV2RGB_U2G]);
+    }
+
+    for (p = 0; p < nb_planes; p++)
+        dstp[p] = dst[p] + srcSliceY * dstStride[p];
+
+    for (y = 0; y < srcSliceH; y++) {
+        /* slices may start on an odd line when only the output is sliced */
+        const int line_y = srcSliceY + y;
+        const int cy0 = (line_y >> vsub) - chr_y;
+        const int cy1 = !vsub ? cy0 : av_clip(line_y & 1 ? cy0 + 1 : cy0 - 1,
+                                              chr_min, chr_max);
+        const uint8_t *srcY = src[0] + y * srcStride[0];
+
+        for (p = 0; p < 2; p++) {
+            const uint8_t *src0 = src[1 + p] + cy0 * srcStride[1 + p];
+            const uint8_t *src1 = src[1 + p] + cy1 * srcStride[1 + p];
+            uint16_t *row = rows[p ^ swap_uv];
+            const int off = main_chr_w << (depth > 8);
+
+            if (main_w)
+                c->yuv2rgb_chroma_row(row, src0, src1, main_chr_w);
+            chroma_row_c(row + main_chr_w, src0 + off, src1 + off,
+                         chr_w - main_chr_w);
+            /* pad for the horizontal interpolation */
+            row[-1]    = row[0];
+            row[chr_w] = row[chr_w - 1];
+        }
+
+        if (main_w)
+            c->yuv2rgb_line(dstp, srcY, rows[0], rows[1], k, main_w);
+        if (c->srcW > main_w) {
+            for (p = 0; p < nb_planes; p++)
+                dst_rest[p] = dstp[p] + main_w * dst_bpp;
+            line_c(dst_rest, srcY + (main_w << (depth > 8)),
+                   rows[0] + main_chr_w, rows[1] + main_chr_w, k,
+                   c->srcW - main_w);
+        }
+
+        for (p = 0; p < nb_planes; p++)
+            dstp[p] += dstStride[p];
+    }
+
+    return srcSliceH;
+}
+
+/* RGB24/GBRP/RGB48 -> planar YUV, BGR24 is RGB24 with the red and blue
+ * coefficients swapped; chroma is the box average of the subsampled block,
+ * the last row/column are repeated for odd sizes; RGB48 is read with 12 bits
+ * of precision to keep the sums in 32 bits */
+static av_always_inline void
+rgb_load(const uint8_t *src[3], int i, int *r, int *g, int *b,
+         enum AVPixelFormat origin)
+{
+    switch (origin) {
+    case AV_PIX_FMT_RGB24:
+        *r = src[0][3 * i + 0];
+        *g = src[0][3 * i + 1];
+        *b = src[0][3 * i + 2];
+        break;
+    case AV_PIX_FMT_GBRP:
+        *g = src[0][i];
+        *b = src[1][i];
+        *r = src[2][i];
+        break;
+    case AV_PIX_FMT_RGB48:
+        *r = ((const uint16_t *)src[0])[3 * i + 0] >> 4;
+        *g = ((const uint16_t *)src[0])[3 * i + 1] >> 4;
+        *b = ((const uint16_t *)src[0])[3 * i + 2] >> 4;
+        break;
+    }
+}
+
+#define STORE(dst, i, v, max)                                    \
+    do {                                                         \
+        const int val = av_clip(v, 0, max);                      \
+        if (is16) ((uint16_t *)(dst))[i] = val;                  \
+        else      (dst)[i] = val;                                \
+    } while (0)
+
+static av_always_inline void
+rgb_to_planar_yuv_luma(uint8_t *dst, const uint8_t *src[3], const int32_t *k,
+                       int width, int is16, enum AVPixelFormat origin)
+{
+    const int sh  = k[RGB2YUV_Y_SHIFT];
+    const int add = k[RGB2YUV_Y_ADD];
+    const int max = k[RGB2YUV_MAX];
+    int i;
+
+    for (i = 0; i < width; i++) {
+        int r, g, b;
+
+        rgb_load(src, i, &r, &g, &b, origin);
+        STORE(dst, i, (k[0] * r + k[1] * g + k[2] * b + add) >> sh, max);
+    }
+}
+
+static av_always_inline void
+rgb_to_planar_yuv_chroma(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0[3],
+                         const uint8_t *src1[3], const int32_t *k, int width,
+                         int hsub, int vsub, int is16, enum AVPixelFormat origin)
+{
+    const int sh  = k[RGB2YUV_C_SHIFT];
+    const int add = k[RGB2YUV_C_ADD];
+    const int max = k[RGB2YUV_MAX];
+    int i;
+
+    for (i = 0; i < width; i += 1 << hsub) {
+        const int j = FFMIN(i + 1, width - 1);
+        int r, g, b, rs, gs, bs;
+
+        rgb_load(src0, i, &rs, &gs, &bs, origin);
+        if (hsub) {
+            rgb_load(src0, j, &r, &g, &b, origin);
+            rs += r; gs += g; bs += b;
+        }
+        if (vsub) {
+            rgb_load(src1, i, &r, &g, &b, origin);
+            rs += r; gs += g; bs += b;
+            if (hsub) {
+                rgb_load(src1, j, &r, &g, &b, origin);
+                rs += r; gs += g; bs += b;
+            }
+        }
+        STORE(dstU, i >> hsub, (k[3] * rs + k[4] * gs + k[5] * bs + add) >> sh, max);
+        STORE(dstV, i >> hsub, (k[6] * rs + k[7] * gs + k[8] * bs + add) >> sh, max);
+    }
+}
+#undef STORE
+
+#define RGB2YUV_LUMA_FUNC(name, is16, origin)                                 \
+static void name(uint8_t *dst, const uint8_t *src[3],                         \
+                 const int32_t *coeffs, int width)                            \
+{                                                                             \
+    rgb_to_planar_yuv_luma(dst, src, coeffs, width, is16, origin);            \
+}
+
+#define RGB2YUV_CHROMA_FUNC(name, hsub, vsub, is16, origin)                   \
+static void name(uint8_t *dstU, uint8_t *dstV, const uint8_t *src0[3],        \
+                 const uint8_t *src1[3], const int32_t *coeffs, int width)    \
+{                                                                             \
+    rgb_to_planar_yuv_chroma(dstU, dstV, src0, src1, coeffs, width,           \
+                             hsub, vsub, is16, origin);                       \
+}
+
+#define RGB2YUV_LINE_FUNCS(name, origin)                                      \
+RGB2YUV_LUMA_FUNC(name ## _8_luma,  0, origin)                                \
+RGB2YUV_LUMA_FUNC(name ## _16_luma, 1, origin)                                \
+RGB2YUV_CHROMA_FUNC(name ## _444_8_chroma,  0, 0, 0, origin)                  \
+RGB2YUV_CHROMA_FUNC(name ## _444_16_chroma, 0, 0, 1, origin)                  \
+RGB2YUV_CHROMA_FUNC(name ## _422_8_chroma,  1, 0, 0, origin)                  \
+RGB2YUV_CHROMA_FUNC(name ## _422_16_chroma, 1, 0, 1, origin)                  \
+RGB2YUV_CHROMA_FUNC(name ## _420_8_chroma,  1, 1, 0, origin)                  \
+RGB2YUV_CHROMA_FUNC(name ## _420_16_chroma, 1, 1, 1, origin)
+
+RGB2YUV_LINE_FUNCS(rgb24toyuv, AV_PIX_FMT_RGB24)
+RGB2YUV_LINE_FUNCS(gbrptoyuv,  AV_PIX_FMT_GBRP)
+RGB2YUV_LINE_FUNCS(rgb48toyuv, AV_PIX_FMT_RGB48)
+
+static rgb2yuv_luma_fn get_rgb2yuv_luma_c(enum AVPixelFormat srcFormat,
+                                          int is16)
+{
+    switch (srcFormat) {
+    case AV_PIX_FMT_RGB24:
+    case AV_PIX_FMT_BGR24: return is16 ? rgb24toyuv_16_luma : rgb24toyuv_8_luma;
+    case AV_PIX_FMT_GBRP:  return is16 ? gbrptoyuv_16_luma  : gbrptoyuv_8_luma;
+    case AV_PIX_FMT_RGB48: return is16 ? rgb48toyuv_16_luma : rgb48toyuv_8_luma;
+    }
+    return NULL;
+}
+
+static rgb2yuv_chroma_fn get_rgb2yuv_chroma_c(enum AVPixelFormat srcFormat,
+                                              int hsub, int vsub, int is16)
+{
+#define SELECT(name) vsub ? is16 ? name ## _420_16_chroma : name ## _420_8_chroma \
+                   : hsub ? is16 ? name ## _422_16_chroma : name ## _422_8_chroma \
+                          : is16 ? name ## _444_16_chroma : name ## _444_8_chroma
+    switch (srcFormat) {
+    case AV_PIX_FMT_RGB24:
+    case AV_PIX_FMT_BGR24: return SELECT(rgb24toyuv);
+    case AV_PIX_FMT_GBRP:  return SELECT(gbrptoyuv);
+    case AV_PIX_FMT_RGB48: return SELECT(rgb48toyuv);
+    }
+#undef SELECT
+    return NULL;
+}
+
+static int rgbToPlanarYuvWrapper(SwsContext *c, const uint8_t *src[],
+                                 int srcStride[], int srcSliceY, int srcSliceH,
+                                 uint8_t *dst[], int dstStride[])
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->dstFormat);
+    const int depth = desc->comp[0].depth;
+    const int hsub  = desc->log2_chroma_w;
+    const int vsub  = desc->log2_chroma_h;
+    const int ish   = c->srcFormat == AV_PIX_FMT_RGB48 ? 4 : 0;
+    const int sh    = RGB2YUV_SHIFT - (depth - 8) + ish;
+    const int csh   = sh + hsub + vsub;
+    const int nb_src_planes = isPlanar(c->srcFormat) ? 3 : 1;
+    /* the context functions convert a multiple of 32 pixels, the C ones the
+     * rest of the line */
+    const int width   = c->srcW;
+    const int main_w  = width & ~31;
+    const int src_off = main_w * (nb_src_planes == 3 ? 1 : ish ? 6 : 3);
+    const int dst_off = main_w << (depth > 8);
+    const rgb2yuv_luma_fn   luma_c   = get_rgb2yuv_luma_c(c->srcFormat, depth > 8);
+    const rgb2yuv_chroma_fn chroma_c = get_rgb2yuv_chroma_c(c->srcFormat, hsub, vsub,
+                                                            depth > 8);
+    const int32_t *t = c->input_rgb2yuv_table;
+    int32_t k[RGB2YUV_NB_COEFFS] = { t[RY_IDX], t[GY_IDX], t[BY_IDX],
+                                     t[RU_IDX], t[GU_IDX], t[BU_IDX],
+                                     t[RV_IDX], t[GV_IDX], t[BV_IDX] };
+    int y_offset = 16 << RGB2YUV_SHIFT;
+    uint8_t *dstY = dst[0] +  srcSliceY         * dstStride[0];
+    uint8_t *dstU = dst[1] + (srcSliceY >> vsub) * dstStride[1];
+    uint8_t *dstV = dst[2] + (srcSliceY >> vsub) * dstStride[2];
+    int y, p;
+
+    /* fill_rgb2yuv_table() ignores dstRange and always builds the table for
+     * limited range output, for every matrix; the generic path expands the
+     * range afterwards, do the same on the coefficients here */
+    if (c->dstRange) {
+        for (p = 0; p < 3; p++)
+            k[p] = (k[p] * 255 + 219 / 2) / 219;
+        for (p = 3; p < 9; p++)
+            k[p] = (k[p] * 255 + 224 / 2) / 224;
+        y_offset = 0;
+    }
+    if (c->srcFormat == AV_PIX_FMT_BGR24) {
+        for (p = 0; p < 9; p += 3)
+            FFSWAP(int32_t, k[p], k[p + 2]);
+    }
+    k[RGB2YUV_Y_ADD]   = (y_offset << ish) + (1 << (sh - 1));
+    k[RGB2YUV_C_ADD]   = (128 << RGB2YUV_SHIFT << (hsub + vsub + ish)) + (1 << (csh - 1));
+    k[RGB2YUV_Y_SHIFT] = sh;
+    k[RGB2YUV_C_SHIFT] = csh;
+    k[RGB2YUV_MAX]     = (1 << depth) - 1;
+
+    for (y = 0; y < srcSliceH; y += 1 << vsub) {
+        const int y1 = FFMIN(y + 1, srcSliceH - 1);
+        const uint8_t *src0[3] = { NULL }, *src1[3] = { NULL };
+        const uint8_t *rest0[3] = { NULL }, *rest1[3] = { NULL };
+
+        for (p = 0; p < nb_src_planes; p++) {
+            src0[p]  = src[p] + y  * srcStride[p];
+            src1[p]  = src[p] + y1 * srcStride[p];
+            rest0[p] = src0[p] + src_off;
+            rest1[p] = src1[p] + src_off;
+        }
+
+        if (main_w) {
+            c->rgb2yuv_luma(dstY, src0, k, main_w);
+            if (vsub)
+                c->rgb2yuv_luma(dstY + (y1 - y) * dstStride[0], src1, k, main_w);
+            c->rgb2yuv_chroma(dstU, dstV, src0, src1, k, main_w);
+        }
+        if (width > main_w) {
+            luma_c(dstY + dst_off, rest0, k, width - main_w);
+            if (vsub)
+                luma_c(dstY + (y1 - y) * dstStride[0] + dst_off, rest1, k,
+                       width - main_w);
+            chroma_c(dstU + (dst_off >> hsub), dstV + (dst_off >> hsub),
+                     rest0, rest1, k, width - main_w);
+        }
+
+        dstY += dstStride[0] << vsub;
+        dstU += dstStride[1];
+        dstV += dstStride[2];
+    }
+
+    return srcSliceH;
+}
+
 static int uint_y_to_float_y_wrapper(SwsContext *c, const uint8_t *src[],
                                      int srcStride[], int srcSliceY,
                                      int srcSliceH, uint8_t *dst[], int dstStride[])
@@ -1971,6 +2574,13 @@ static int planarCopyWrapper(SwsContext *c, const uint8_t *src[],
      (src_fmt == pix_fmt ## LE && dst_fmt == pix_fmt ## BE))
 
 
+#define isFastPlanarYuv(f) (                                     \
+        f == AV_PIX_FMT_YUV420P   || f == AV_PIX_FMT_YUV422P   ||  \
+        f == AV_PIX_FMT_YUV444P   || f == AV_PIX_FMT_YUV420P10 ||  \
+        f == AV_PIX_FMT_YUV422P10 || f == AV_PIX_FMT_YUV444P10 ||  \
+        f == AV_PIX_FMT_YUV420P12 || f == AV_PIX_FMT_YUV422P12 ||  \
+        f == AV_PIX_FMT_YUV444P12)
+
 void ff_get_unscaled_swscale(SwsContext *c)
 {
     const enum AVPixelFormat srcFormat = c->srcFormat;
@@ -2011,6 +2621,18 @@ void ff_get_unscaled_swscale(SwsContext *c)
         c->convert_unscaled = ff_yuv2rgb_get_func_ptr(c);
         c->dst_slice_align = 2;
     }
+    /* planar yuv to rgb24/gbrp, where the table based yuv2bgr did not apply */
+    if (!c->convert_unscaled && isFastPlanarYuv(srcFormat) &&
+        (dstFormat == AV_PIX_FMT_RGB24 || dstFormat == AV_PIX_FMT_BGR24 ||
+         dstFormat == AV_PIX_FMT_GBRP  || dstFormat == AV_PIX_FMT_GBRPF32) &&
+        !(flags & (SWS_ACCURATE_RND | SWS_BITEXACT))) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(srcFormat);
+        const int is16 = desc->comp[0].depth > 8;
+        c->convert_unscaled   = planarYuvToRgbWrapper;
+        c->yuv2rgb_chroma_row = is16 ? yuv2rgb_chroma_row_16 : yuv2rgb_chroma_row_8;
+        c->yuv2rgb_line       = get_yuv2rgb_line_c(dstFormat, desc->log2_chroma_w, is16);
+    }
+
     /* yuv420p1x_to_p01x */
     if ((srcFormat == AV_PIX_FMT_YUV420P10 || srcFormat == AV_PIX_FMT_YUVA420P10 ||
          srcFormat == AV_PIX_FMT_YUV420P12 ||
@@ -2032,6 +2654,19 @@ void ff_get_unscaled_swscale(SwsContext *c)
         c->dst_slice_align = 4;
     }
 
+    /* rgb24/gbrp/rgb48 to planar yuv */
+    if ((srcFormat == AV_PIX_FMT_RGB24 || srcFormat == AV_PIX_FMT_BGR24 ||
+         srcFormat == AV_PIX_FMT_GBRP  || srcFormat == AV_PIX_FMT_RGB48) &&
+        isFastPlanarYuv(dstFormat) &&
+        !(flags & (SWS_ACCURATE_RND | SWS_BITEXACT))) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dstFormat);
+        const int is16 = desc->comp[0].depth > 8;
+        c->convert_unscaled = rgbToPlanarYuvWrapper;
+        c->rgb2yuv_luma     = get_rgb2yuv_luma_c(srcFormat, is16);
+        c->rgb2yuv_chroma   = get_rgb2yuv_chroma_c(srcFormat, desc->log2_chroma_w,
+                                                   desc->log2_chroma_h, is16);
+    }
+
     /* bgr24toYV12 */
     if (srcFormat == AV_PIX_FMT_BGR24 &&
         (dstFormat == AV_PIX_FMT_YUV420P || dstFormat == AV_PIX_FMT_YUVA420P) &&
@@ -2056,11 +2691,13 @@ void ff_get_unscaled_swscale(SwsContext *c)
         f == AV_PIX_FMT_BGR32_1 || \
         f == AV_PIX_FMT_BGR24)
 
-    if (srcFormat == AV_PIX_FMT_GBRP && isPlanar(srcFormat) && isByteRGB(dstFormat))
+    if ((srcFormat == AV_PIX_FMT_GBRP       || srcFormat == AV_PIX_FMT_GBRAP      ||
+         srcFormat == AV_PIX_FMT_GBRPF32LE  || srcFormat == AV_PIX_FMT_GBRPF32BE  ||
+         srcFormat == AV_PIX_FMT_GBRAPF32LE || srcFormat == AV_PIX_FMT_GBRAPF32BE) &&
+        isByteRGB(dstFormat)) {
         c->convert_unscaled = planarRgbToRgbWrapper;
-
-    if (srcFormat == AV_PIX_FMT_GBRAP && isByteRGB(dstFormat))
-        c->convert_unscaled = planarRgbaToRgbWrapper;
+        c->gbrp2rgb_line    = get_gbrp2rgb_line_c(srcFormat, dstFormat);
+    }
 
     if ((srcFormat == AV_PIX_FMT_RGB48LE  || srcFormat == AV_PIX_FMT_RGB48BE  ||
          srcFormat == AV_PIX_FMT_BGR48LE  || srcFormat == AV_PIX_FMT_BGR48BE  ||
@@ -2092,9 +2729,15 @@ void ff_get_unscaled_swscale(SwsContext *c)
          dstFormat == AV_PIX_FMT_BGRA64LE || dstFormat == AV_PIX_FMT_BGRA64BE))
         c->convert_unscaled = planarRgb16ToRgb16Wrapper;
 
-    if (av_pix_fmt_desc_get(srcFormat)->comp[0].depth == 8 &&
-        isPackedRGB(srcFormat) && dstFormat == AV_PIX_FMT_GBRP)
+    if ((av_pix_fmt_desc_get(srcFormat)->comp[0].depth == 8 &&
+         isPackedRGB(srcFormat) &&
+         (dstFormat == AV_PIX_FMT_GBRP || dstFormat == AV_PIX_FMT_GBRAP)) ||
+        (isByteRGB(srcFormat) &&
+         (dstFormat == AV_PIX_FMT_GBRPF32LE  || dstFormat == AV_PIX_FMT_GBRPF32BE ||
+          dstFormat == AV_PIX_FMT_GBRAPF32LE || dstFormat == AV_PIX_FMT_GBRAPF32BE))) {
         c->convert_unscaled = rgbToPlanarRgbWrapper;
+        c->rgb2gbrp_line    = get_rgb2gbrp_line_c(srcFormat, dstFormat);
+    }
 
     if (isBayer(srcFormat)) {
         c->dst_slice_align = 2;
@@ -2104,7 +2747,13 @@ void ff_get_unscaled_swscale(SwsContext *c)
             c->convert_unscaled = bayer_to_rgb48_wrapper;
         else if (dstFormat == AV_PIX_FMT_YUV420P)
             c->convert_unscaled = bayer_to_yv12_wrapper;
-        else if (!isBayer(dstFormat)) {
+        else if (dstFormat == AV_PIX_FMT_GBRP) {
+            c->convert_unscaled  = bayer_to_gbrp_wrapper;
+            c->bayer_interp_line = get_bayer_interp_line_c(srcFormat, dstFormat);
+        } else if (dstFormat == AV_PIX_FMT_GBRP16 && isBayer16BPS(srcFormat)) {
+            c->convert_unscaled  = bayer_to_gbrp16_wrapper;
+            c->bayer_interp_line = get_bayer_interp_line_c(srcFormat, dstFormat);
+        } else if (!isBayer(dstFormat)) {
             av_log(c, AV_LOG_ERROR, "unsupported bayer conversion\n");
             av_assert0(0);
         }
@@ -2232,6 +2881,8 @@ void ff_get_unscaled_swscale(SwsContext *c)
     ff_get_unscaled_swscale_arm(c);
 #elif ARCH_AARCH64
     ff_get_unscaled_swscale_aarch64(c);
+#elif ARCH_X86
+    ff_get_unscaled_swscale_x86(c);
 #endif
 }
 
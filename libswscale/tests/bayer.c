@@ -0,0 +1,185 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check the direct Bayer to GBRP/GBRP16 demosaicing against the Bayer to
+ * RGB24/RGB48 one followed by a lossless conversion, with and without slice
+ * threads.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/adler32.h"
+#include "libavutil/frame.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+
+/* not a multiple of 32, so that the line functions leave a remainder */
+#define W 102
+#define H 38
+
+static const enum AVPixelFormat bayer_fmts[] = {
+    AV_PIX_FMT_BAYER_BGGR8,    AV_PIX_FMT_BAYER_RGGB8,
+    AV_PIX_FMT_BAYER_GBRG8,    AV_PIX_FMT_BAYER_GRBG8,
+    AV_PIX_FMT_BAYER_BGGR16LE, AV_PIX_FMT_BAYER_BGGR16BE,
+    AV_PIX_FMT_BAYER_RGGB16LE, AV_PIX_FMT_BAYER_RGGB16BE,
+    AV_PIX_FMT_BAYER_GBRG16LE, AV_PIX_FMT_BAYER_GBRG16BE,
+    AV_PIX_FMT_BAYER_GRBG16LE, AV_PIX_FMT_BAYER_GRBG16BE,
+};
+
+static AVFrame *alloc_frame(enum AVPixelFormat format)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+    frame->format = format;
+    frame->width  = W;
+    frame->height = H;
+    if (av_frame_get_buffer(frame, 0) < 0)
+        av_frame_free(&frame);
+    return frame;
+}
+
+static int convert(const AVFrame *src, AVFrame *dst, int threads)
+{
+    struct SwsContext *c = sws_alloc_context();
+    int ret;
+
+    if (!c)
+        return -1;
+    av_opt_set_int(c, "srcw",       W,           0);
+    av_opt_set_int(c, "srch",       H,           0);
+    av_opt_set_int(c, "src_format", src->format, 0);
+    av_opt_set_int(c, "dstw",       W,           0);
+    av_opt_set_int(c, "dsth",       H,           0);
+    av_opt_set_int(c, "dst_format", dst->format, 0);
+    av_opt_set_int(c, "sws_flags",  SWS_BILINEAR | SWS_BITEXACT, 0);
+    av_opt_set_int(c, "threads",    threads,     0);
+
+    ret = sws_init_context(c, NULL, NULL);
+    if (ret >= 0)
+        ret = sws_scale_frame(c, dst, src);
+    sws_freeContext(c);
+
+    return ret;
+}
+
+static int compare(const AVFrame *a, const AVFrame *b)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(a->format);
+    const int bytes = W * (desc->comp[0].depth > 8 ? 2 : 1);
+
+    for (int p = 0; p < 3; p++)
+        for (int y = 0; y < H; y++)
+            if (memcmp(a->data[p] + y * a->linesize[p],
+                       b->data[p] + y * b->linesize[p], bytes))
+                return 1;
+    return 0;
+}
+
+/* of the little endian samples, to not depend on the native GBRP16 */
+static uint32_t checksum(const AVFrame *frame)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    const int is16 = desc->comp[0].depth > 8;
+    uint8_t line[2 * W];
+    uint32_t crc = 0;
+
+    for (int p = 0; p < 3; p++) {
+        for (int y = 0; y < H; y++) {
+            const uint8_t *src = frame->data[p] + y * frame->linesize[p];
+
+            if (is16) {
+                for (int x = 0; x < W; x++)
+                    AV_WL16(line + 2 * x, AV_RN16(src + 2 * x));
+                src = line;
+            }
+            crc = av_adler32_update(crc, src, W << is16);
+        }
+    }
+    return crc;
+}
+
+int main(void)
+{
+    AVFrame *src = NULL, *tmp = NULL, *ref = NULL, *out = NULL;
+    AVLFG rand;
+    int ret = 0;
+
+    av_lfg_init(&rand, 1);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(bayer_fmts); i++) {
+        const enum AVPixelFormat src_fmt = bayer_fmts[i];
+        const int is16 = av_get_bits_per_pixel(av_pix_fmt_desc_get(src_fmt)) > 8;
+
+        for (int out16 = 0; out16 <= is16; out16++) {
+            const enum AVPixelFormat dst_fmt = out16 ? AV_PIX_FMT_GBRP16 : AV_PIX_FMT_GBRP;
+            const enum AVPixelFormat tmp_fmt = out16 ? AV_PIX_FMT_RGB48  : AV_PIX_FMT_RGB24;
+
+            av_frame_free(&src);
+            av_frame_free(&tmp);
+            av_frame_free(&ref);
+            av_frame_free(&out);
+            src = alloc_frame(src_fmt);
+            tmp = alloc_frame(tmp_fmt);
+            ref = alloc_frame(dst_fmt);
+            out = alloc_frame(dst_fmt);
+            if (!src || !tmp || !ref || !out) {
+                ret = 1;
+                goto end;
+            }
+            for (int y = 0; y < H; y++)
+                for (int x = 0; x < src->linesize[0]; x++)
+                    src->data[0][y * src->linesize[0] + x] = av_lfg_get(&rand);
+
+            if (convert(src, tmp, 1) < 0 || convert(tmp, ref, 1) < 0) {
+                ret = 1;
+                goto end;
+            }
+
+            printf("%-18s -> %-6s %08"PRIx32, av_get_pix_fmt_name(src_fmt),
+                   out16 ? "gbrp16" : "gbrp", checksum(ref));
+            for (int threads = 1; threads <= 4; threads += 3) {
+                if (convert(src, out, threads) < 0) {
+                    ret = 1;
+                    goto end;
+                }
+                if (compare(ref, out)) {
+                    printf(" mismatch with %d thread%s", threads, threads > 1 ? "s" : "");
+                    ret = 1;
+                }
+            }
+            printf("\n");
+        }
+    }
+
+end:
+    av_frame_free(&src);
+    av_frame_free(&tmp);
+    av_frame_free(&ref);
+    av_frame_free(&out);
+
+    return ret;
+}
@@ -0,0 +1,527 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * End-to-end scaler benchmark.
+ *
+ * Sweeps a matrix of source format, destination format, destination size,
+ * scaler flags and thread count. For every combination one line of CSV is
+ * printed with the throughput in output megapixels per second, the code path
+ * swscale picked and the PSNR of the result against a reference computed in
+ * floating point from the same analytic test pattern, so the output of two
+ * builds can be compared with diff or a spreadsheet.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/cpu.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define MAX_LIST 32
+
+/* intermediate format the test pattern is rendered in and compared in */
+#define REF_FMT AV_PIX_FMT_GBRP16
+#define REF_FLAGS (SWS_BILINEAR | SWS_ACCURATE_RND | SWS_BITEXACT | \
+                   SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP)
+
+typedef struct BenchList {
+    char *items[MAX_LIST];
+    int nb;
+} BenchList;
+
+typedef struct BenchSize {
+    int w, h;
+} BenchSize;
+
+static const char *const default_fmts =
+    "yuv420p,nv12,yuv420p10le,yuv444p,rgb24,bgra,gbrp,rgb48le";
+static const char *const default_sizes = "1920x1080,1280x720";
+static const char *const default_flags = "bicubic";
+
+static double min_time = 0.25;
+
+static int split_list(BenchList *list, const char *str)
+{
+    char *dup = av_strdup(str), *saveptr = NULL, *tok;
+
+    if (!dup)
+        return AVERROR(ENOMEM);
+
+    list->nb = 0;
+    for (tok = av_strtok(dup, ",", &saveptr); tok && list->nb < MAX_LIST;
+         tok = av_strtok(NULL, ",", &saveptr)) {
+        list->items[list->nb] = av_strdup(tok);
+        if (!list->items[list->nb]) {
+            av_free(dup);
+            return AVERROR(ENOMEM);
+        }
+        list->nb++;
+    }
+    av_free(dup);
+
+    return list->nb ? 0 : AVERROR(EINVAL);
+}
+
+static void free_list(BenchList *list)
+{
+    for (int i = 0; i < list->nb; i++)
+        av_freep(&list->items[i]);
+    list->nb = 0;
+}
+
+/* Smooth analytic pattern: gradients plus a zone plate that stays below the
+ * Nyquist limit of all the sizes the benchmark is normally run at. u and v
+ * are the normalized picture coordinates of a sample center. */
+static double pattern(int comp, double u, double v)
+{
+    const double r2 = (u - 0.5) * (u - 0.5) + (v - 0.5) * (v - 0.5);
+    const double zone = 0.5 + 0.5 * cos(2 * M_PI * 60 * r2);
+
+    switch (comp) {
+    case 0:  return 0.1 + 0.4 * u + 0.4 * zone;
+    case 1:  return 0.1 + 0.4 * v + 0.4 * (1 - zone);
+    default: return 0.1 + 0.3 * (1 - u) * v + 0.2 * zone + 0.1 * (1 + sin(2 * M_PI * 3 * u));
+    }
+}
+
+static AVFrame *alloc_frame(enum AVPixelFormat fmt, int w, int h)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+
+    frame->format = fmt;
+    frame->width  = w;
+    frame->height = h;
+    if (av_frame_get_buffer(frame, 0) < 0)
+        av_frame_free(&frame);
+
+    return frame;
+}
+
+/* Render the pattern at the given size into a GBRP16 frame, or its BT.601
+ * luma into all three planes if gray is set. */
+static AVFrame *render_pattern(int w, int h, int gray)
+{
+    AVFrame *frame = alloc_frame(REF_FMT, w, h);
+
+    if (!frame)
+        return NULL;
+
+    for (int y = 0; y < h; y++) {
+        uint16_t *g = (uint16_t *)(frame->data[0] + y * frame->linesize[0]);
+        uint16_t *b = (uint16_t *)(frame->data[1] + y * frame->linesize[1]);
+        uint16_t *r = (uint16_t *)(frame->data[2] + y * frame->linesize[2]);
+
+        for (int x = 0; x < w; x++) {
+            const double u = (x + 0.5) / w, v = (y + 0.5) / h;
+            double rgb[3];
+
+            for (int c = 0; c < 3; c++)
+                rgb[c] = pattern(c, u, v);
+            if (gray)
+                rgb[0] = rgb[1] = rgb[2] = 0.299 * rgb[0] + 0.587 * rgb[1] + 0.114 * rgb[2];
+
+            r[x] = lrint(65535 * rgb[0]);
+            g[x] = lrint(65535 * rgb[1]);
+            b[x] = lrint(65535 * rgb[2]);
+        }
+    }
+
+    return frame;
+}
+
+static int convert(AVFrame *dst, const AVFrame *src)
+{
+    SwsContext *sws = sws_getContext(src->width, src->height, src->format,
+                                     dst->width, dst->height, dst->format,
+                                     REF_FLAGS, NULL, NULL, NULL);
+    int ret;
+
+    if (!sws)
+        return AVERROR(EINVAL);
+    ret = sws_scale_frame(sws, dst, src);
+    sws_freeContext(sws);
+
+    return ret;
+}
+
+/* PSNR of the R, G and B planes of two GBRP16 frames */
+static void get_psnr(const AVFrame *ref, const AVFrame *out, double psnr[3])
+{
+    static const int plane[3] = { 2, 0, 1 };
+
+    for (int c = 0; c < 3; c++) {
+        const int p = plane[c];
+        uint64_t sse = 0;
+
+        for (int y = 0; y < ref->height; y++) {
+            const uint16_t *a = (const uint16_t *)(ref->data[p] + y * ref->linesize[p]);
+            const uint16_t *b = (const uint16_t *)(out->data[p] + y * out->linesize[p]);
+            for (int x = 0; x < ref->width; x++) {
+                const int d = a[x] - b[x];
+                sse += (int64_t)d * d;
+            }
+        }
+
+        psnr[c] = sse ? 10 * log10(65535.0 * 65535.0 * ref->width * ref->height / sse)
+                      : INFINITY;
+    }
+}
+
+static const char *get_path(const SwsContext *c)
+{
+    if (c->nb_slice_ctx)
+        c = c->slice_ctx[0];
+
+    if (c->gamma_flag && c->cascaded_context[0])
+        return "gamma";
+    if (c->cascaded_context[0])
+        return "cascaded";
+    if (c->convert_unscaled)
+        return "unscaled";
+    return "generic";
+}
+
+static SwsContext *alloc_scaler(const AVFrame *src, const AVFrame *dst,
+                                const char *flags, int threads)
+{
+    SwsContext *sws = sws_alloc_context();
+
+    if (!sws)
+        return NULL;
+
+    if (av_opt_set_int(sws, "srcw",       src->width,  0) < 0 ||
+        av_opt_set_int(sws, "srch",       src->height, 0) < 0 ||
+        av_opt_set_int(sws, "src_format", src->format, 0) < 0 ||
+        av_opt_set_int(sws, "dstw",       dst->width,  0) < 0 ||
+        av_opt_set_int(sws, "dsth",       dst->height, 0) < 0 ||
+        av_opt_set_int(sws, "dst_format", dst->format, 0) < 0 ||
+        av_opt_set_int(sws, "threads",    threads,     0) < 0 ||
+        av_opt_set    (sws, "sws_flags",  flags,       0) < 0 ||
+        sws_init_context(sws, NULL, NULL) < 0) {
+        sws_freeContext(sws);
+        return NULL;
+    }
+
+    return sws;
+}
+
+typedef struct BenchResult {
+    const char *path;
+    int frames;
+    double mpix_s;
+    double psnr[3];
+} BenchResult;
+
+static int run_one(const AVFrame *src, AVFrame *dst, AVFrame *check,
+                   const AVFrame *ref, const char *flags, int threads,
+                   BenchResult *r)
+{
+    SwsContext *sws = alloc_scaler(src, dst, flags, threads);
+    int64_t start, elapsed;
+    int ret;
+
+    if (!sws)
+        return AVERROR(EINVAL);
+
+    r->path = get_path(sws);
+
+    /* warm up caches and lazily allocated buffers */
+    ret = sws_scale_frame(sws, dst, src);
+    if (ret < 0)
+        goto end;
+
+    r->frames = 0;
+    start = av_gettime_relative();
+    do {
+        ret = sws_scale_frame(sws, dst, src);
+        if (ret < 0)
+            goto end;
+        r->frames++;
+        elapsed = av_gettime_relative() - start;
+    } while (elapsed < min_time * 1000000 || r->frames < 3);
+
+    r->mpix_s = (double)dst->width * dst->height * r->frames / elapsed;
+
+    ret = convert(check, dst);
+    if (ret < 0)
+        goto end;
+    get_psnr(ref, check, r->psnr);
+
+end:
+    sws_freeContext(sws);
+    return ret;
+}
+
+static void print_psnr(double psnr)
+{
+    if (isinf(psnr))
+        printf(",inf");
+    else
+        printf(",%.2f", psnr);
+}
+
+static int bench(const BenchList *src_fmts, const BenchList *dst_fmts,
+                 const BenchSize *src_size, const BenchSize *sizes, int nb_sizes,
+                 const BenchList *flags, const int *threads, int nb_threads)
+{
+    AVFrame *pattern_src = render_pattern(src_size->w, src_size->h, 0);
+    int ret = 0;
+
+    if (!pattern_src)
+        return AVERROR(ENOMEM);
+
+    printf("src_fmt,dst_fmt,src_size,dst_size,flags,threads,path,frames,"
+           "mpix_s,speedup,psnr_r,psnr_g,psnr_b\n");
+
+    for (int s = 0; s < src_fmts->nb; s++) {
+        enum AVPixelFormat src_fmt = av_get_pix_fmt(src_fmts->items[s]);
+        AVFrame *src;
+
+        if (src_fmt == AV_PIX_FMT_NONE || !sws_isSupportedInput(src_fmt)) {
+            fprintf(stderr, "unsupported input format %s\n", src_fmts->items[s]);
+            continue;
+        }
+
+        src = alloc_frame(src_fmt, src_size->w, src_size->h);
+        if (!src) {
+            ret = AVERROR(ENOMEM);
+            break;
+        }
+        if ((ret = convert(src, pattern_src)) < 0) {
+            av_frame_free(&src);
+            break;
+        }
+
+        for (int n = 0; n < nb_sizes; n++) {
+            AVFrame *ref[2] = { render_pattern(sizes[n].w, sizes[n].h, 0),
+                                render_pattern(sizes[n].w, sizes[n].h, 1) };
+            AVFrame *check  = alloc_frame(REF_FMT, sizes[n].w, sizes[n].h);
+
+            if (!ref[0] || !ref[1] || !check) {
+                av_frame_free(&ref[0]);
+                av_frame_free(&ref[1]);
+                av_frame_free(&check);
+                ret = AVERROR(ENOMEM);
+                break;
+            }
+
+            for (int d = 0; d < dst_fmts->nb; d++) {
+                enum AVPixelFormat dst_fmt = av_get_pix_fmt(dst_fmts->items[d]);
+                int gray;
+                AVFrame *dst;
+
+                if (dst_fmt == AV_PIX_FMT_NONE || !sws_isSupportedOutput(dst_fmt)) {
+                    if (!s && !n)
+                        fprintf(stderr, "unsupported output format %s\n",
+                                dst_fmts->items[d]);
+                    continue;
+                }
+
+                /* compare against the luma if either side has no chroma */
+                gray = av_pix_fmt_desc_get(src_fmt)->nb_components < 3 ||
+                       av_pix_fmt_desc_get(dst_fmt)->nb_components < 3;
+
+                dst = alloc_frame(dst_fmt, sizes[n].w, sizes[n].h);
+                if (!dst) {
+                    ret = AVERROR(ENOMEM);
+                    break;
+                }
+
+                for (int f = 0; f < flags->nb; f++) {
+                    double base = 0;
+
+                    for (int t = 0; t < nb_threads; t++) {
+                        BenchResult r;
+
+                        ret = run_one(src, dst, check, ref[gray], flags->items[f],
+                                      threads[t], &r);
+                        if (ret < 0) {
+                            fprintf(stderr, "%s %dx%d -> %s %dx%d flags=%s "
+                                    "threads=%d failed: %s\n",
+                                    src_fmts->items[s], src_size->w, src_size->h,
+                                    dst_fmts->items[d], sizes[n].w, sizes[n].h,
+                                    flags->items[f], threads[t], av_err2str(ret));
+                            ret = 0;
+                            continue;
+                        }
+                        if (!t)
+                            base = r.mpix_s;
+
+                        printf("%s,%s,%dx%d,%dx%d,%s,%d,%s,%d,%.2f,%.2f",
+                               src_fmts->items[s], dst_fmts->items[d],
+                               src_size->w, src_size->h, sizes[n].w, sizes[n].h,
+                               flags->items[f], threads[t], r.path, r.frames,
+                               r.mpix_s, base ? r.mpix_s / base : 0.0);
+                        for (int c = 0; c < 3; c++)
+                            print_psnr(r.psnr[c]);
+                        printf("\n");
+                        fflush(stdout);
+                    }
+                }
+
+                av_frame_free(&dst);
+            }
+
+            av_frame_free(&ref[0]);
+            av_frame_free(&ref[1]);
+            av_frame_free(&check);
+            if (ret < 0)
+                break;
+        }
+
+        av_frame_free(&src);
+        if (ret < 0)
+            break;
+    }
+
+    av_frame_free(&pattern_src);
+    return ret;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: benchmark [options]\n"
+            "  -src <fmt,...>        source pixel formats (default %s)\n"
+            "  -dst <fmt,...>        destination pixel formats (default: as -src)\n"
+            "  -size <WxH>           source size (default 1920x1080)\n"
+            "  -dst_size <WxH,...>   destination sizes (default %s)\n"
+            "  -flags <flags,...>    scaler flags, e.g. bicubic+accurate_rnd (default %s)\n"
+            "  -threads <n,...>      thread counts, the first one is the speedup base\n"
+            "                        (default 1 and the number of CPUs)\n"
+            "  -time <seconds>       minimum time per measurement (default %.2f)\n"
+            "  -cpuflags <flags>     force cpu flags\n",
+            default_fmts, default_sizes, default_flags, min_time);
+}
+
+int main(int argc, char **argv)
+{
+    const char *src_str = default_fmts, *dst_str = NULL;
+    const char *size_str = "1920x1080", *dst_size_str = default_sizes;
+    const char *flags_str = default_flags, *threads_str = NULL;
+    BenchList src_fmts = { 0 }, dst_fmts = { 0 }, flags = { 0 };
+    BenchList list = { 0 };
+    BenchSize src_size, sizes[MAX_LIST];
+    int threads[MAX_LIST], nb_threads = 0, nb_sizes = 0;
+    char default_threads[32];
+    int ret;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (argv[i][0] != '-' || i + 1 == argc)
+            goto bad_option;
+        if (!strcmp(argv[i], "-src")) {
+            src_str = argv[i + 1];
+        } else if (!strcmp(argv[i], "-dst")) {
+            dst_str = argv[i + 1];
+        } else if (!strcmp(argv[i], "-size")) {
+            size_str = argv[i + 1];
+        } else if (!strcmp(argv[i], "-dst_size")) {
+            dst_size_str = argv[i + 1];
+        } else if (!strcmp(argv[i], "-flags")) {
+            flags_str = argv[i + 1];
+        } else if (!strcmp(argv[i], "-threads")) {
+            threads_str = argv[i + 1];
+        } else if (!strcmp(argv[i], "-time")) {
+            min_time = atof(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-cpuflags")) {
+            unsigned cpu_flags = av_get_cpu_flags();
+            ret = av_parse_cpu_caps(&cpu_flags, argv[i + 1]);
+            if (ret < 0) {
+                fprintf(stderr, "invalid cpu flags %s\n", argv[i + 1]);
+                return 1;
+            }
+            av_force_cpu_flags(cpu_flags);
+        } else {
+bad_option:
+            fprintf(stderr, "bad option or argument missing (%s)\n", argv[i]);
+            usage();
+            return 1;
+        }
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    if (!threads_str) {
+        snprintf(default_threads, sizeof(default_threads), "1,%d", av_cpu_count());
+        threads_str = av_cpu_count() > 1 ? default_threads : "1";
+    }
+
+    if ((ret = split_list(&src_fmts, src_str))               < 0 ||
+        (ret = split_list(&dst_fmts, dst_str ? dst_str : src_str)) < 0 ||
+        (ret = split_list(&flags, flags_str))                < 0)
+        goto end;
+
+    if (av_parse_video_size(&src_size.w, &src_size.h, size_str) < 0) {
+        fprintf(stderr, "invalid size %s\n", size_str);
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+
+    if ((ret = split_list(&list, dst_size_str)) < 0)
+        goto end;
+    for (int i = 0; i < list.nb; i++) {
+        if (av_parse_video_size(&sizes[i].w, &sizes[i].h, list.items[i]) < 0) {
+            fprintf(stderr, "invalid size %s\n", list.items[i]);
+            ret = AVERROR(EINVAL);
+            goto end;
+        }
+    }
+    nb_sizes = list.nb;
+    free_list(&list);
+
+    if ((ret = split_list(&list, threads_str)) < 0)
+        goto end;
+    for (int i = 0; i < list.nb; i++) {
+        threads[i] = atoi(list.items[i]);
+        if (threads[i] < 1) {
+            fprintf(stderr, "invalid thread count %s\n", list.items[i]);
+            ret = AVERROR(EINVAL);
+            goto end;
+        }
+    }
+    nb_threads = list.nb;
+    free_list(&list);
+
+    ret = bench(&src_fmts, &dst_fmts, &src_size, sizes, nb_sizes,
+                &flags, threads, nb_threads);
+
+end:
+    free_list(&src_fmts);
+    free_list(&dst_fmts);
+    free_list(&flags);
+    free_list(&list);
+    if (ret < 0)
+        fprintf(stderr, "error: %s\n", av_err2str(ret));
+
+    return ret < 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/lfg.h"
+#include "libavutil/pixfmt.h"
+
+#include "libswscale/swscale.h"
+
+#define SRC_W 64
+#define SRC_H 48
+#define DST_W 32
+#define DST_H 24
+
+/* more contexts of distinct sizes than the cache has entries */
+#define NB_FILLERS 48
+
+static uint8_t src[SRC_W * SRC_H];
+
+static uint64_t last_hits, last_misses;
+
+static int create(int dstW, int dstH, uint8_t *dst)
+{
+    const uint8_t *src_planes[4] = { src };
+    const int src_stride[4] = { SRC_W };
+    uint8_t *dst_planes[4] = { dst };
+    const int dst_stride[4] = { dstW };
+    struct SwsContext *ctx;
+
+    ctx = sws_getContext(SRC_W, SRC_H, AV_PIX_FMT_GRAY8, dstW, dstH,
+                         AV_PIX_FMT_GRAY8, SWS_BICUBIC | SWS_BITEXACT,
+                         NULL, NULL, NULL);
+    if (!ctx)
+        return -1;
+    if (dst)
+        sws_scale(ctx, src_planes, src_stride, 0, SRC_H, dst_planes, dst_stride);
+    sws_freeContext(ctx);
+    return 0;
+}
+
+static void print_stats(const char *what)
+{
+    uint64_t hits, misses;
+    int64_t time_saved;
+
+    sws_get_filter_cache_stats(&hits, &misses, &time_saved);
+    printf("%-32s %3"PRIu64" hits %3"PRIu64" misses%s\n", what,
+           hits - last_hits, misses - last_misses,
+           time_saved < 0 ? " (negative time saved)" : "");
+    last_hits   = hits;
+    last_misses = misses;
+}
+
+int main(void)
+{
+    static uint8_t out0[DST_W * DST_H], out1[DST_W * DST_H];
+    AVLFG rand;
+    int i;
+
+    av_lfg_init(&rand, 1);
+    for (i = 0; i < SRC_W * SRC_H; i++)
+        src[i] = av_lfg_get(&rand);
+
+    sws_free_filter_cache();
+
+    if (create(DST_W, DST_H, out0) < 0)
+        return 1;
+    print_stats("first context");
+
+    if (create(DST_W, DST_H, out1) < 0)
+        return 1;
+    print_stats("same context again");
+    printf("output %s\n", memcmp(out0, out1, sizeof(out0)) ? "differs" : "identical");
+
+    /* Reuse the first context after each filler, the least recently used
+     * entries are evicted first, so it stays cached while the older fillers
+     * get evicted. */
+    for (i = 0; i < NB_FILLERS; i++) {
+        if (create(DST_W + 1 + i, DST_H + 1 + i, NULL) < 0 ||
+            create(DST_W, DST_H, NULL) < 0)
+            return 1;
+    }
+    print_stats("fillers and first context");
+
+    if (create(DST_W, DST_H, NULL) < 0)
+        return 1;
+    print_stats("first context after fillers");
+
+    if (create(DST_W + NB_FILLERS, DST_H + NB_FILLERS, NULL) < 0)
+        return 1;
+    print_stats("newest filler");
+
+    if (create(DST_W + 1, DST_H + 1, NULL) < 0)
+        return 1;
+    print_stats("oldest filler");
+
+    /* this also resets the statistics */
+    sws_free_filter_cache();
+    last_hits = last_misses = 0;
+    print_stats("after freeing the cache");
+
+    if (create(DST_W, DST_H, NULL) < 0)
+        return 1;
+    print_stats("first context after freeing");
+
+    return 0;
+}
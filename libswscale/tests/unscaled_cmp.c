@@ -0,0 +1,239 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Compare the approximate unscaled planar YUV <-> RGB converters, which are
+ * only used without accurate_rnd and bitexact, against the accurate path.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/intfloat.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define W 96
+#define H 64
+
+typedef struct Format {
+    const char *name;
+    enum AVPixelFormat fmt;
+} Format;
+
+typedef struct TestCase {
+    Format src, dst;
+    int tolerance;      ///< maximum difference, in units of the 8-bit range
+} TestCase;
+
+#define YUV444P   { "yuv444p",   AV_PIX_FMT_YUV444P   }
+#define YUV422P10 { "yuv422p10", AV_PIX_FMT_YUV422P10 }
+#define YUV420P10 { "yuv420p10", AV_PIX_FMT_YUV420P10 }
+#define RGB24     { "rgb24",     AV_PIX_FMT_RGB24     }
+#define GBRP      { "gbrp",      AV_PIX_FMT_GBRP      }
+#define GBRPF32   { "gbrpf32",   AV_PIX_FMT_GBRPF32   }
+
+static const TestCase tests[] = {
+    /* YUV input matches the generic path with full chroma interpolation */
+    { YUV444P,   RGB24,     0 },
+    { YUV444P,   GBRP,      0 },
+    { YUV444P,   GBRPF32,   1 },
+    { YUV422P10, RGB24,     0 },
+    { YUV422P10, GBRP,      0 },
+    /* the generic packed RGB output takes the nearest chroma line instead
+     * of interpolating 4:2:0 vertically, the planar one interpolates */
+    { YUV420P10, RGB24,     10 },
+    { YUV420P10, GBRP,      0 },
+    { YUV420P10, GBRPF32,   1 },
+    { RGB24,     YUV444P,   1 },
+    { RGB24,     YUV420P10, 2 },
+    { GBRP,      YUV444P,   1 },
+    { GBRP,      YUV420P10, 2 },
+};
+
+static const struct {
+    const char *name;
+    int colorspace;
+} matrices[] = {
+    { "bt601", SWS_CS_ITU601 },
+    { "bt709", SWS_CS_ITU709 },
+};
+
+/* smooth pattern, so that chroma subsampling does not dominate the error */
+static void fill_pattern(AVFrame *frame)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    const int is_rgb = desc->flags & AV_PIX_FMT_FLAG_RGB;
+
+    for (int i = 0; i < desc->nb_components; i++) {
+        const AVComponentDescriptor *comp = &desc->comp[i];
+        const int is_chroma = !is_rgb && (i == 1 || i == 2);
+        const int w = is_chroma ? AV_CEIL_RSHIFT(W, desc->log2_chroma_w) : W;
+        const int h = is_chroma ? AV_CEIL_RSHIFT(H, desc->log2_chroma_h) : H;
+        const int max = (1 << comp->depth) - 1;
+        const int lo  = is_rgb ? 0   : 16 << (comp->depth - 8);
+        const int hi  = is_rgb ? max : (is_chroma ? 240 : 235) << (comp->depth - 8);
+
+        for (int y = 0; y < h; y++) {
+            uint8_t *line = frame->data[comp->plane] + y * frame->linesize[comp->plane];
+            for (int x = 0; x < w; x++) {
+                const int lx = is_chroma ? x << desc->log2_chroma_w : x;
+                const int ly = is_chroma ? y << desc->log2_chroma_h : y;
+                const double t = 0.5 + 0.5 * sin((lx * (i + 1) + ly * (3 - i)) * 2.0 / W + i);
+                const int v = lo + lrint(t * (hi - lo));
+                if (comp->depth > 8)
+                    AV_WN16(line + x * comp->step + comp->offset, v);
+                else
+                    line[x * comp->step + comp->offset] = v;
+            }
+        }
+    }
+}
+
+static double get_sample(const AVFrame *frame, const AVComponentDescriptor *comp,
+                         int x, int y)
+{
+    const uint8_t *p = frame->data[comp->plane] + y * frame->linesize[comp->plane] +
+                       x * comp->step + comp->offset;
+
+    if (frame->format == AV_PIX_FMT_GBRPF32)
+        return av_int2float(AV_RN32(p)) * 255;
+    if (comp->depth > 8)
+        return AV_RN16(p) * 255.0 / ((1 << comp->depth) - 1);
+    return *p;
+}
+
+static double max_diff(const AVFrame *a, const AVFrame *b)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(a->format);
+    double diff = 0;
+
+    for (int i = 0; i < desc->nb_components; i++) {
+        const int is_chroma = !(desc->flags & AV_PIX_FMT_FLAG_RGB) && (i == 1 || i == 2);
+        const int w = is_chroma ? AV_CEIL_RSHIFT(W, desc->log2_chroma_w) : W;
+        const int h = is_chroma ? AV_CEIL_RSHIFT(H, desc->log2_chroma_h) : H;
+
+        for (int y = 0; y < h; y++)
+            for (int x = 0; x < w; x++)
+                diff = FFMAX(diff, fabs(get_sample(a, &desc->comp[i], x, y) -
+                                        get_sample(b, &desc->comp[i], x, y)));
+    }
+
+    return diff;
+}
+
+static AVFrame *alloc_frame(enum AVPixelFormat format)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+    frame->format = format;
+    frame->width  = W;
+    frame->height = H;
+    if (av_frame_get_buffer(frame, 0) < 0)
+        av_frame_free(&frame);
+    return frame;
+}
+
+static int convert(const TestCase *t, int colorspace, int range, int flags,
+                   const AVFrame *src, AVFrame *dst, int *unscaled)
+{
+    const int *coeffs = sws_getCoefficients(colorspace);
+    struct SwsContext *c = sws_getContext(W, H, t->src.fmt, W, H, t->dst.fmt,
+                                          flags, NULL, NULL, NULL);
+    int ret;
+
+    if (!c)
+        return -1;
+    ret = sws_setColorspaceDetails(c, coeffs, range, coeffs, range,
+                                   0, 1 << 16, 1 << 16);
+    if (ret >= 0)
+        ret = sws_scale(c, (const uint8_t * const *)src->data, src->linesize,
+                        0, H, dst->data, dst->linesize);
+    *unscaled = !!c->convert_unscaled;
+    sws_freeContext(c);
+
+    return ret < 0 ? ret : 0;
+}
+
+int main(void)
+{
+    AVFrame *src = NULL, *fast = NULL, *ref = NULL;
+    int ret = 0;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        const TestCase *t = &tests[i];
+
+        av_frame_free(&src);
+        av_frame_free(&fast);
+        av_frame_free(&ref);
+        src  = alloc_frame(t->src.fmt);
+        fast = alloc_frame(t->dst.fmt);
+        ref  = alloc_frame(t->dst.fmt);
+        if (!src || !fast || !ref) {
+            ret = 1;
+            goto end;
+        }
+        fill_pattern(src);
+
+        for (int m = 0; m < FF_ARRAY_ELEMS(matrices); m++) {
+            for (int range = 0; range < 2; range++) {
+                int unscaled, ref_unscaled;
+                double diff;
+
+                if (convert(t, matrices[m].colorspace, range, SWS_BILINEAR,
+                            src, fast, &unscaled) < 0 ||
+                    convert(t, matrices[m].colorspace, range,
+                            SWS_BILINEAR | SWS_ACCURATE_RND | SWS_BITEXACT |
+                            SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP,
+                            src, ref, &ref_unscaled) < 0) {
+                    fprintf(stderr, "conversion %s -> %s failed\n",
+                            t->src.name, t->dst.name);
+                    ret = 1;
+                    goto end;
+                }
+
+                diff = max_diff(fast, ref);
+                printf("%-9s -> %-9s %s %-7s max diff %d\n", t->src.name,
+                       t->dst.name, matrices[m].name, range ? "full" : "limited",
+                       (int)ceil(diff - 0.01));
+                if (!unscaled || ref_unscaled) {
+                    printf("  unexpected conversion path\n");
+                    ret = 1;
+                }
+                if (diff > t->tolerance + 0.01) {
+                    printf("  exceeds tolerance %d\n", t->tolerance);
+                    ret = 1;
+                }
+            }
+        }
+    }
+
+end:
+    av_frame_free(&src);
+    av_frame_free(&fast);
+    av_frame_free(&ref);
+
+    return ret;
+}
@@ -49,6 +49,7 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/slicethread.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 #include "libavutil/aarch64/cpu.h"
 #include "libavutil/ppc/cpu.h"
 #include "libavutil/x86/asm.h"
@@ -386,12 +387,12 @@ static const ScaleAlgorithm scale_algorithms[] = {
     { SWS_X,             "experimental",                    8 },
 };
 
-static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
-                              int *outFilterSize, int xInc, int srcW,
-                              int dstW, int filterAlign, int one,
-                              int flags, int cpu_flags,
-                              SwsVector *srcFilter, SwsVector *dstFilter,
-                              double param[2], int srcPos, int dstPos)
+static av_cold int build_filter(int16_t **outFilter, int32_t **filterPos,
+                                int *outFilterSize, int xInc, int srcW,
+                                int dstW, int filterAlign, int one,
+                                int flags, int cpu_flags,
+                                SwsVector *srcFilter, SwsVector *dstFilter,
+                                double param[2], int srcPos, int dstPos)
 {
     int i;
     int filterSize;
@@ -795,6 +796,199 @@ done:
     return ret;
 }
 
+/* Process-wide cache of the scaler filters, so that contexts with the same
+ * geometry, e.g. the outputs of several filter graphs or repeatedly created
+ * thumbnailing contexts, do not recompute them. Entries are copied out, as
+ * the arrays get modified in place by the architecture specific init. */
+#define FILTER_CACHE_SIZE      64
+#define FILTER_CACHE_MAX_BYTES (16 << 20)
+
+typedef struct FilterKey {
+    int xInc, srcW, dstW, filterAlign, one, flags, cpu_flags, srcPos, dstPos;
+    double param[2];
+} FilterKey;
+
+typedef struct FilterCacheEntry {
+    FilterKey key;
+    int16_t *filter;
+    int32_t *filterPos;
+    int filterSize;
+    size_t size;                ///< bytes used by filter and filterPos
+    int64_t init_time;          ///< time it took to build the filter, in us
+    unsigned last_use;
+} FilterCacheEntry;
+
+static struct {
+    FilterCacheEntry entries[FILTER_CACHE_SIZE];
+    size_t size;
+    unsigned clock;
+    uint64_t hits, misses;
+    int64_t time_saved;
+} filter_cache;
+
+static AVMutex filter_cache_mutex = AV_MUTEX_INITIALIZER;
+
+static int filter_cache_get(const FilterKey *key, int16_t **filter,
+                            int32_t **filterPos, int *filterSize, int flags)
+{
+    int ret = 0;
+
+    ff_mutex_lock(&filter_cache_mutex);
+    for (int i = 0; i < FILTER_CACHE_SIZE; i++) {
+        FilterCacheEntry *e = &filter_cache.entries[i];
+        const int dstW = key->dstW;
+
+        if (!e->filter || memcmp(&e->key, key, sizeof(*key)))
+            continue;
+
+        *filter    = av_memdup(e->filter,    e->filterSize * (dstW + 3) * sizeof(**filter));
+        *filterPos = av_memdup(e->filterPos, (dstW + 3) * sizeof(**filterPos));
+        if (!*filter || !*filterPos) {
+            av_freep(filter);
+            av_freep(filterPos);
+            ret = AVERROR(ENOMEM);
+            break;
+        }
+        *filterSize = e->filterSize;
+        e->last_use = ++filter_cache.clock;
+        filter_cache.hits++;
+        filter_cache.time_saved += e->init_time;
+
+        if (flags & SWS_PRINT_INFO)
+            av_log(NULL, AV_LOG_VERBOSE,
+                   "SwScaler: filter cache hit, %"PRIu64" hits / %"PRIu64" misses, "
+                   "%"PRId64" us saved\n",
+                   filter_cache.hits, filter_cache.misses, filter_cache.time_saved);
+        ret = 1;
+        break;
+    }
+    if (!ret)
+        filter_cache.misses++;
+    ff_mutex_unlock(&filter_cache_mutex);
+
+    return ret;
+}
+
+static void filter_cache_put(const FilterKey *key, const int16_t *filter,
+                             const int32_t *filterPos, int filterSize,
+                             int64_t init_time)
+{
+    const size_t filter_size = filterSize * (key->dstW + 3) * sizeof(*filter);
+    const size_t pos_size    = (key->dstW + 3) * sizeof(*filterPos);
+    FilterCacheEntry *e = NULL;
+    int16_t *f;
+    int32_t *pos;
+
+    if (filter_size + pos_size > FILTER_CACHE_MAX_BYTES / 8)
+        return;
+
+    f   = av_memdup(filter,    filter_size);
+    pos = av_memdup(filterPos, pos_size);
+    if (!f || !pos) {
+        av_free(f);
+        av_free(pos);
+        return;
+    }
+
+    ff_mutex_lock(&filter_cache_mutex);
+    /* evict the least recently used entries until the new one fits */
+    for (;;) {
+        FilterCacheEntry *lru = NULL;
+
+        e = NULL;
+        for (int i = 0; i < FILTER_CACHE_SIZE; i++) {
+            FilterCacheEntry *cur = &filter_cache.entries[i];
+            if (!cur->filter)
+                e = cur;
+            else if (!lru || cur->last_use < lru->last_use)
+                lru = cur;
+        }
+        if (e && filter_cache.size + filter_size + pos_size <= FILTER_CACHE_MAX_BYTES)
+            break;
+
+        filter_cache.size -= lru->size;
+        av_freep(&lru->filter);
+        av_freep(&lru->filterPos);
+    }
+    memcpy(&e->key, key, sizeof(*key));
+    e->filter     = f;
+    e->filterPos  = pos;
+    e->filterSize = filterSize;
+    e->size       = filter_size + pos_size;
+    e->init_time  = init_time;
+    e->last_use   = ++filter_cache.clock;
+    filter_cache.size += e->size;
+    ff_mutex_unlock(&filter_cache_mutex);
+}
+
+void sws_get_filter_cache_stats(uint64_t *hits, uint64_t *misses,
+                                int64_t *time_saved)
+{
+    ff_mutex_lock(&filter_cache_mutex);
+    if (hits)
+        *hits = filter_cache.hits;
+    if (misses)
+        *misses = filter_cache.misses;
+    if (time_saved)
+        *time_saved = filter_cache.time_saved;
+    ff_mutex_unlock(&filter_cache_mutex);
+}
+
+void sws_free_filter_cache(void)
+{
+    ff_mutex_lock(&filter_cache_mutex);
+    for (int i = 0; i < FILTER_CACHE_SIZE; i++) {
+        av_freep(&filter_cache.entries[i].filter);
+        av_freep(&filter_cache.entries[i].filterPos);
+    }
+    memset(&filter_cache, 0, sizeof(filter_cache));
+    ff_mutex_unlock(&filter_cache_mutex);
+}
+
+static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
+                              int *outFilterSize, int xInc, int srcW,
+                              int dstW, int filterAlign, int one,
+                              int flags, int cpu_flags,
+                              SwsVector *srcFilter, SwsVector *dstFilter,
+                              double param[2], int srcPos, int dstPos)
+{
+    FilterKey key;
+    int64_t t0;
+    int ret;
+
+    /* user supplied filters are not worth caching */
+    if (srcFilter || dstFilter)
+        return build_filter(outFilter, filterPos, outFilterSize, xInc, srcW,
+                            dstW, filterAlign, one, flags, cpu_flags,
+                            srcFilter, dstFilter, param, srcPos, dstPos);
+
+    memset(&key, 0, sizeof(key));
+    key.xInc        = xInc;
+    key.srcW        = srcW;
+    key.dstW        = dstW;
+    key.filterAlign = filterAlign;
+    key.one         = one;
+    key.flags       = flags & ~SWS_PRINT_INFO;
+    key.cpu_flags   = cpu_flags;
+    key.srcPos      = srcPos;
+    key.dstPos      = dstPos;
+    key.param[0]    = param[0];
+    key.param[1]    = param[1];
+
+    ret = filter_cache_get(&key, outFilter, filterPos, outFilterSize, flags);
+    if (ret)
+        return FFMIN(ret, 0);
+
+    t0  = av_gettime_relative();
+    ret = build_filter(outFilter, filterPos, outFilterSize, xInc, srcW,
+                       dstW, filterAlign, one, flags, cpu_flags,
+                       NULL, NULL, param, srcPos, dstPos);
+    if (ret >= 0)
+        filter_cache_put(&key, *outFilter, *filterPos, *outFilterSize,
+                         av_gettime_relative() - t0);
+    return ret;
+}
+
 static void fill_rgb2yuv_table(SwsContext *c, const int table[4], int dstRange)
 {
     int64_t W, V, Z, Cy, Cu, Cv;
@@ -1204,11 +1398,115 @@ static uint16_t * alloc_gamma_tbl(double e)
         return NULL;
 
     for (i = 0; i < 65536; ++i) {
-        tbl[i] = pow(i / 65535.0, e) * 65535.0;
+        tbl[i] = lrint(pow(i / 65535.0, e) * 65535.0);
     }
     return tbl;
 }
 
+/**
+ * Set up gamma correct scaling in the float linear light pipeline:
+ * cascaded_context[0] converts the input to 8 or 16-bit planar RGB, which is
+ * scaled in float by c->lin to planar RGB of the output depth, and
+ * cascaded_context[2] converts that to the output format. Either context is
+ * left out if it has nothing to do.
+ */
+static av_cold int init_linear_gamma(SwsContext *c, SwsFilter *srcFilter,
+                                     SwsFilter *dstFilter)
+{
+    SwsLinearContext *lin = &c->lin;
+    const AVPixFmtDescriptor *desc     = av_pix_fmt_desc_get(c->srcFormat);
+    const AVPixFmtDescriptor *dst_desc = av_pix_fmt_desc_get(c->dstFormat);
+    const int alpha     = isALPHA(c->srcFormat) && isALPHA(c->dstFormat);
+    const int flags     = c->flags;
+    const int cpu_flags = av_get_cpu_flags();
+    const int lum_flags = (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags;
+    const int srcW = c->srcW, srcH = c->srcH, dstW = c->dstW, dstH = c->dstH;
+    /* c->lumXInc is adjusted for the fast bilinear scaler */
+    const int xInc = (((int64_t)srcW << 16) + (dstW >> 1)) / dstW;
+    enum AVPixelFormat inFmt, outFmt;
+    int16_t *filter = NULL;
+    int i, j, ret;
+
+    lin->is16      = desc->comp[0].depth > 8 || isFloat(c->srcFormat);
+    lin->out_depth = isFloat(c->dstFormat)       ? 32 :
+                     dst_desc->comp[0].depth > 8 ? 16 : 8;
+    lin->planes    = alpha ? 4 : 3;
+    lin->dstStride = FFALIGN(dstW, 16);
+    inFmt  = lin->is16 ? (alpha ? AV_PIX_FMT_GBRAP16 : AV_PIX_FMT_GBRP16)
+                       : (alpha ? AV_PIX_FMT_GBRAP   : AV_PIX_FMT_GBRP);
+    /* rounding to the output depth here keeps the conversion to it exact */
+    outFmt = lin->out_depth == 32 ? (alpha ? AV_PIX_FMT_GBRAPF32 : AV_PIX_FMT_GBRPF32) :
+             lin->out_depth == 16 ? (alpha ? AV_PIX_FMT_GBRAP16  : AV_PIX_FMT_GBRP16)  :
+                                    (alpha ? AV_PIX_FMT_GBRAP    : AV_PIX_FMT_GBRP);
+
+    if (c->srcFormat != inFmt) {
+        ret = av_image_alloc(c->cascaded_tmp, c->cascaded_tmpStride,
+                             srcW, srcH, inFmt, 64);
+        if (ret < 0)
+            return ret;
+
+        c->cascaded_context[0] = sws_getContext(srcW, srcH, c->srcFormat,
+                                                srcW, srcH, inFmt,
+                                                flags, NULL, NULL, c->param);
+        if (!c->cascaded_context[0])
+            return AVERROR(ENOMEM);
+    }
+
+    if (c->dstFormat != outFmt) {
+        ret = av_image_alloc(c->cascaded1_tmp, c->cascaded1_tmpStride,
+                             dstW, dstH, outFmt, 64);
+        if (ret < 0)
+            return ret;
+
+        c->cascaded_context[2] = sws_getContext(dstW, dstH, outFmt,
+                                                dstW, dstH, c->dstFormat,
+                                                flags, NULL, NULL, c->param);
+        if (!c->cascaded_context[2])
+            return AVERROR(ENOMEM);
+        c->dst_slice_align = FFMAX(c->dst_slice_align,
+                                   c->cascaded_context[2]->dst_slice_align);
+    }
+
+    if ((ret = initFilter(&filter, &lin->hFilterPos, &lin->hFilterSize,
+                          xInc, srcW, dstW, 1, 1 << 14, lum_flags,
+                          cpu_flags, srcFilter->lumH, dstFilter->lumH, c->param,
+                          get_local_pos(c, 0, 0, 0),
+                          get_local_pos(c, 0, 0, 0))) < 0)
+        return ret;
+
+    /* transpose, so that SIMD loads the same tap of adjacent outputs */
+    lin->hFilter = av_calloc(lin->hFilterSize * lin->dstStride, sizeof(*lin->hFilter));
+    if (!lin->hFilter || av_reallocp_array(&lin->hFilterPos, lin->dstStride,
+                                           sizeof(*lin->hFilterPos)) < 0) {
+        av_free(filter);
+        return AVERROR(ENOMEM);
+    }
+    for (i = 0; i < dstW; i++)
+        for (j = 0; j < lin->hFilterSize; j++)
+            lin->hFilter[j * lin->dstStride + i] = filter[i * lin->hFilterSize + j] / 16384.0f;
+    for (; i < lin->dstStride; i++)
+        lin->hFilterPos[i] = lin->hFilterPos[dstW - 1];
+    av_freep(&filter);
+
+    if ((ret = initFilter(&filter, &lin->vFilterPos, &lin->vFilterSize,
+                          c->lumYInc, srcH, dstH, 1, 1 << 14, lum_flags,
+                          cpu_flags, srcFilter->lumV, dstFilter->lumV, c->param,
+                          get_local_pos(c, 0, 0, 1),
+                          get_local_pos(c, 0, 0, 1))) < 0)
+        return ret;
+
+    lin->vFilter = av_malloc_array(dstH * lin->vFilterSize, sizeof(*lin->vFilter));
+    if (!lin->vFilter) {
+        av_free(filter);
+        return AVERROR(ENOMEM);
+    }
+    for (i = 0; i < dstH * lin->vFilterSize; i++)
+        lin->vFilter[i] = filter[i] / 16384.0f;
+    av_freep(&filter);
+
+    return ff_sws_init_linear(lin, c->gamma_value, srcW, dstW);
+}
+
 static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
 {
     switch(fmt) {
@@ -1571,7 +1869,13 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
 
     // hardcoded for now
     c->gamma_value = 2.2;
-    tmpFmt = AV_PIX_FMT_RGBA64LE;
+
+    if (!unscaled && c->gamma_flag && c->gamma_float)
+        return init_linear_gamma(c, srcFilter, dstFilter);
+
+    // only carry alpha through the linear light pipeline if it is kept
+    tmpFmt = isALPHA(srcFormat) && isALPHA(dstFormat) ? AV_PIX_FMT_RGBA64LE
+                                                      : AV_PIX_FMT_RGB48LE;
 
 
     if (!unscaled && c->gamma_flag && (srcFormat != tmpFmt || dstFormat != tmpFmt)) {
@@ -1633,7 +1937,8 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
     if (isBayer(srcFormat)) {
         if (!unscaled ||
             (dstFormat != AV_PIX_FMT_RGB24 && dstFormat != AV_PIX_FMT_YUV420P &&
-             dstFormat != AV_PIX_FMT_RGB48)) {
+             dstFormat != AV_PIX_FMT_RGB48 && dstFormat != AV_PIX_FMT_GBRP &&
+             !(dstFormat == AV_PIX_FMT_GBRP16 && isBayer16BPS(srcFormat)))) {
             enum AVPixelFormat tmpFormat = isBayer16BPS(srcFormat) ? AV_PIX_FMT_RGB48 : AV_PIX_FMT_RGB24;
 
             ret = av_image_alloc(c->cascaded_tmp, c->cascaded_tmpStride,
@@ -2025,7 +2330,7 @@ static int context_init_threaded(SwsContext *c,
 
         c->nb_slice_ctx++;
 
-        if (c->slice_ctx[i]->dither == SWS_DITHER_ED) {
+        if (c->slice_ctx[i]->dither == SWS_DITHER_ED && !c->ed_bands) {
             av_log(c, AV_LOG_VERBOSE,
                    "Error-diffusion dither is in use, scaling will be single-threaded.");
             break;
@@ -2058,6 +2363,15 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     if (src_format != c->srcFormat || dst_format != c->dstFormat)
         av_log(c, AV_LOG_WARNING, "deprecated pixel format used, make sure you did set range correctly\n");
 
+    /* Every slice context would run the complete integer gamma correcting
+     * cascade, as it needs the whole intermediate image, so keep it
+     * single-threaded. The float pipeline only scales the lines of its slice. */
+    if (c->gamma_flag && !c->gamma_float && c->nb_threads != 1 &&
+        (c->srcW != c->dstW || c->srcH != c->dstH)) {
+        av_log(c, AV_LOG_VERBOSE, "Integer gamma correct scaling is not threaded\n");
+        c->nb_threads = 1;
+    }
+
     if (c->nb_threads != 1) {
         ret = context_init_threaded(c, srcFilter, dstFilter);
         if (ret < 0 || c->nb_threads > 1)
@@ -2490,9 +2804,11 @@ void sws_freeContext(SwsContext *c)
 
     av_freep(&c->gamma);
     av_freep(&c->inv_gamma);
+    ff_sws_uninit_linear(&c->lin);
 
     av_freep(&c->rgb0_scratch);
     av_freep(&c->xyz_scratch);
+    av_freep(&c->chroma_rows);
 
     ff_free_filters(c);
 
@@ -0,0 +1,148 @@
+;******************************************************************************
+;* x86-optimized Bayer demosaicing to planar RGB
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; interpolate half of the pixels of an iteration, starting at pixel %4, into
+; m%1 (sampled colour), m%2 (green) and m%3 (other colour)
+%macro BAYER_HALF 4
+    LOADZX          m6, [srcq   + xq * ISZ + (%4 - 1) * ISZ]
+    LOADZX          m7, [srcq   + xq * ISZ + (%4 + 1) * ISZ]
+    PADD            m6, m7                      ; horizontal
+    LOADZX          m7, [aboveq + xq * ISZ + %4 * ISZ]
+    LOADZX          m8, [belowq + xq * ISZ + %4 * ISZ]
+    PADD            m7, m8                      ; vertical
+    PADD            m8, m6, m7                  ; cross
+    LOADZX          m9, [aboveq + xq * ISZ + (%4 - 1) * ISZ]
+    LOADZX         m10, [aboveq + xq * ISZ + (%4 + 1) * ISZ]
+    PADD            m9, m10
+    LOADZX         m10, [belowq + xq * ISZ + (%4 - 1) * ISZ]
+    PADD            m9, m10
+    LOADZX         m10, [belowq + xq * ISZ + (%4 + 1) * ISZ]
+    PADD            m9, m10                     ; diagonal
+    PSRL            m6, 1 + SHIFT
+    PSRL            m7, 1 + SHIFT
+    PSRL            m8, 2 + SHIFT
+    PSRL            m9, 2 + SHIFT
+    LOADZX         m10, [srcq   + xq * ISZ + %4 * ISZ]
+%if SHIFT
+    PSRL           m10, SHIFT
+%endif
+    ; the colour is sampled at the even pixels, green at the odd ones
+    pblendw        m%1, m10, m6, ODD
+    pblendw        m%2, m8, m10, ODD
+    pblendw        m%3, m9, m7, ODD
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_bayer_interp_line_<in>[_to_<out>](uint8_t *dst_c, uint8_t *dst_g,
+;                                           uint8_t *dst_o, const uint8_t *src,
+;                                           ptrdiff_t src_stride, int width)
+;
+; width is a multiple of 32
+;-----------------------------------------------------------------------------
+%macro BAYER_INTERP_LINE 3 ; name, input depth, output depth
+%if %2 == 8
+    %define ISZ    1
+    %define LOADZX pmovzxbw
+    %define PADD   paddw
+    %define PSRL   psrlw
+    %define ODD    0xAA
+    %define STEP   mmsize
+%else
+    %define ISZ    2
+    %define LOADZX pmovzxwd
+    %define PADD   paddd
+    %define PSRL   psrld
+    %define ODD    0xCC
+    %define STEP   mmsize / 2
+%endif
+%define SHIFT (%2 - %3)
+
+cglobal bayer_interp_line_%1, 6, 9, 11, dstc, dstg, dsto, src, stride, w, above, below, x
+    movsxdifnidn    wq, wd
+    mov         aboveq, srcq
+    sub         aboveq, strideq
+    lea         belowq, [srcq + strideq]
+    xor             xq, xq
+.loop:
+    BAYER_HALF 0, 1, 2, 0
+    BAYER_HALF 3, 4, 5, STEP / 2
+%if %2 == 8
+    packuswb        m0, m3
+    packuswb        m1, m4
+    packuswb        m2, m5
+%else
+    packusdw        m0, m3
+    packusdw        m1, m4
+    packusdw        m2, m5
+%endif
+%if cpuflag(avx2)
+    vpermq          m0, m0, q3120
+    vpermq          m1, m1, q3120
+    vpermq          m2, m2, q3120
+%endif
+%if %3 == 16
+    movu [dstcq + xq * 2], m0
+    movu [dstgq + xq * 2], m1
+    movu [dstoq + xq * 2], m2
+%elif %2 == 8
+    movu [dstcq + xq], m0
+    movu [dstgq + xq], m1
+    movu [dstoq + xq], m2
+%else
+    packuswb        m0, m0
+    packuswb        m1, m1
+    packuswb        m2, m2
+%if cpuflag(avx2)
+    vpermq          m0, m0, q2020
+    vpermq          m1, m1, q2020
+    vpermq          m2, m2, q2020
+    movu [dstcq + xq], xm0
+    movu [dstgq + xq], xm1
+    movu [dstoq + xq], xm2
+%else
+    movq [dstcq + xq], m0
+    movq [dstgq + xq], m1
+    movq [dstoq + xq], m2
+%endif
+%endif
+    add             xq, STEP
+    cmp             xq, wq
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse4
+BAYER_INTERP_LINE 8,       8,  8
+BAYER_INTERP_LINE 16,      16, 16
+BAYER_INTERP_LINE 16_to_8, 16, 8
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+BAYER_INTERP_LINE 8,       8,  8
+BAYER_INTERP_LINE 16,      16, 16
+BAYER_INTERP_LINE 16_to_8, 16, 8
+%endif
+%endif
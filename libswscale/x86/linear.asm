@@ -0,0 +1,188 @@
+;******************************************************************************
+;* x86-optimized filters for the float linear light scaling pipeline
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+; LINEAR_DELIN_LUT_BASE and LINEAR_DELIN_LUT_SHIFT in swscale_internal.h
+pd_delin_base:      times 8 dd (127 - 32) << 7
+pd_delin_frac:      times 8 dd 0xFFFF
+ps_delin_frac:      times 8 dd 0x37800000 ; 1.0f / (1 << 16)
+ps_1:               times 8 dd 1.0
+; 8 - n dwords in, the first n lanes are set
+tail_mask:          times 8 dd -1
+                    times 8 dd 0
+
+SECTION .text
+
+%if ARCH_X86_64
+INIT_YMM avx2
+
+;-----------------------------------------------------------------------------
+; void ff_sws_linearize_<depth>(float *dst, const uint8_t *src,
+;                               const float *lut, int width)
+;-----------------------------------------------------------------------------
+%macro LINEARIZE 1 ; depth
+cglobal sws_linearize_%1, 4, 6, 3, dst, src, lut, w, x, tmp
+    movsxdifnidn wq, wd
+    xor          xq, xq
+    mov        tmpq, wq
+    and        tmpq, ~(mmsize / 4 - 1)
+    jz .tail
+.loop:
+%if %1 == 8
+    pmovzxbd     m0, [srcq + xq]
+%else
+    pmovzxwd     m0, [srcq + xq * 2]
+%endif
+    pcmpeqd      m1, m1
+    vgatherdps   m2, [lutq + m0 * 4], m1
+    movu [dstq + xq * 4], m2
+    add          xq, mmsize / 4
+    cmp          xq, tmpq
+    jl .loop
+.tail:
+    cmp          xq, wq
+    jge .end
+.tail_loop:
+%if %1 == 8
+    movzx      tmpd, byte [srcq + xq]
+%else
+    movzx      tmpd, word [srcq + xq * 2]
+%endif
+    movss       xm0, [lutq + tmpq * 4]
+    movss [dstq + xq * 4], xm0
+    inc          xq
+    cmp          xq, wq
+    jl .tail_loop
+.end:
+    RET
+%endmacro
+
+LINEARIZE 8
+LINEARIZE 16
+
+;-----------------------------------------------------------------------------
+; void ff_sws_linear_hscale(float *dst, const float *src, const float *filter,
+;                           const int32_t *filterPos, int filterSize,
+;                           int width)
+;
+; The filter holds tap j of output i at filter[j * width + i], width is a
+; multiple of 16.
+;-----------------------------------------------------------------------------
+cglobal sws_linear_hscale, 6, 10, 4, dst, src, filter, pos, size, w, x, j, coef, srcj
+    movsxdifnidn sizeq, sized
+    movsxdifnidn    wq, wd
+    xor             xq, xq
+.loop:
+    movu            m0, [posq + xq * 4]
+    xorps           m1, m1
+    lea          coefq, [filterq + xq * 4]
+    mov          srcjq, srcq
+    mov             jq, sizeq
+.tap:
+    pcmpeqd         m2, m2
+    vgatherdps      m3, [srcjq + m0 * 4], m2
+    mulps           m3, [coefq]
+    addps           m1, m3
+    lea          coefq, [coefq + wq * 4]
+    add          srcjq, 4
+    dec             jq
+    jnz .tap
+    movu [dstq + xq * 4], m1
+    add             xq, mmsize / 4
+    cmp             xq, wq
+    jl .loop
+    RET
+
+;-----------------------------------------------------------------------------
+; void ff_sws_linear_vscale(float *dst, const float *const *src,
+;                           const float *filter, int filterSize, int width)
+; void ff_sws_linear_vscale_delin(float *dst, const float *const *src,
+;                                 const float *filter, int filterSize,
+;                                 const float *lut, int width)
+;-----------------------------------------------------------------------------
+
+; convert m0 from linear light, see delinearize() in linear.c
+%macro DELIN 0
+    xorps           m2, m2
+    maxps           m0, m2
+    minps           m0, [ps_1]
+    psrld           m1, m0, 16
+    psubd           m1, [pd_delin_base]
+    pand            m3, m0, [pd_delin_frac]
+    cvtdq2ps        m3, m3
+    mulps           m3, [ps_delin_frac]
+    pcmpgtd         m4, m2, m1          ; below the table, flushed to 0
+    pmaxsd          m1, m2
+    pcmpeqd         m5, m5
+    vgatherdps      m6, [lutq + m1 * 4], m5
+    pcmpeqd         m5, m5
+    vgatherdps      m7, [lutq + m1 * 4 + 4], m5
+    subps           m7, m6
+    mulps           m7, m3
+    addps           m7, m6
+    pandn           m0, m4, m7
+%endmacro
+
+%macro VSCALE 1 ; delin
+%if %1
+cglobal sws_linear_vscale_delin, 6, 9, 8, dst, src, filter, size, lut, w, x, j, line
+%else
+cglobal sws_linear_vscale, 5, 8, 2, dst, src, filter, size, w, x, j, line
+%endif
+    movsxdifnidn sizeq, sized
+    movsxdifnidn    wq, wd
+    xor             xq, xq
+.loop:
+    xorps           m0, m0
+    xor             jq, jq
+.tap:
+    mov          lineq, [srcq + jq * 8]
+    vbroadcastss    m1, [filterq + jq * 4]
+    mulps           m1, [lineq + xq * 4]
+    addps           m0, m1
+    inc             jq
+    cmp             jq, sizeq
+    jl .tap
+%if %1
+    DELIN
+%endif
+    lea             jq, [xq + mmsize / 4]
+    cmp             jq, wq
+    jg .tail
+    movu [dstq + xq * 4], m0
+    mov             xq, jq
+    cmp             xq, wq
+    jl .loop
+    RET
+.tail:
+    sub             xq, wq
+    lea          lineq, [tail_mask + mmsize]
+    movu            m1, [lineq + xq * 4]
+    add             xq, wq
+    vmaskmovps [dstq + xq * 4], m1, m0
+    RET
+%endmacro
+
+VSCALE 0
+VSCALE 1
+%endif
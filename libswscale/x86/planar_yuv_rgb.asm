@@ -0,0 +1,486 @@
+;******************************************************************************
+;* x86-optimized line converters for the unscaled planar YUV <-> RGB paths
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 64
+
+pd_round_22:        times 16 dd 1 << 21
+pd_round_14:        times 16 dd 1 << 13
+pd_uv_offset:       times 16 dd 128 << 9
+pd_clip_30:         times 16 dd (1 << 30) - 1
+ps_1_65535:         times 16 dd 0x37800080 ; 1.0f / 65535.0f
+
+; 0x00BBGGRR dwords to packed RGB24, 12 bytes per lane
+pb_pack_rgb24:      times 4 db 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
+
+; packed RGB24 to dwords, the lanes are loaded from 0 and 8 bytes into each
+; group of 8 pixels, so that the second one starts at its 4th byte
+pb_unpack_rgb24_r:
+%rep 2
+    db 0, -1, -1, -1, 3, -1, -1, -1,  6, -1, -1, -1,  9, -1, -1, -1
+    db 4, -1, -1, -1, 7, -1, -1, -1, 10, -1, -1, -1, 13, -1, -1, -1
+%endrep
+pb_unpack_rgb24_g:
+%rep 2
+    db 1, -1, -1, -1, 4, -1, -1, -1,  7, -1, -1, -1, 10, -1, -1, -1
+    db 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1, 14, -1, -1, -1
+%endrep
+pb_unpack_rgb24_b:
+%rep 2
+    db 2, -1, -1, -1, 5, -1, -1, -1,  8, -1, -1, -1, 11, -1, -1, -1
+    db 6, -1, -1, -1, 9, -1, -1, -1, 12, -1, -1, -1, 15, -1, -1, -1
+%endrep
+
+pd_pack_rgb24_perm: dd 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 3, 7, 11, 15
+pd_pairs_even:      dd 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30
+pd_pairs_odd:       dd 1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31
+pd_pack_rgb24_perm_avx2: dd 0, 1, 2, 4, 5, 6, 3, 7
+pd_pack_gbrp_perm:  dd 0, 4, 1, 5, 2, 6, 3, 7
+
+SECTION .text
+
+%if ARCH_X86_64
+
+;------------------------------------------------------------------------------
+; YUV -> RGB
+;------------------------------------------------------------------------------
+
+; void yuv2rgb_chroma_row_<depth>(uint16_t *dst, const uint8_t *src0,
+;                                 const uint8_t *src1, int width)
+%macro YUV2RGB_CHROMA_ROW 1 ; depth
+cglobal yuv2rgb_chroma_row_%1, 4, 4, 2, dst, src0, src1, w
+    movsxdifnidn         wq, wd
+.loop:
+%if %1 == 8
+    pmovzxbw             m0, [src0q]
+    pmovzxbw             m1, [src1q]
+%else
+    movu                 m0, [src0q]
+    movu                 m1, [src1q]
+%endif
+    paddw                m1, m0
+    paddw                m0, m0
+    paddw                m0, m1
+    movu             [dstq], m0
+    add                dstq, mmsize
+    add               src0q, mmsize / 2 * %1 / 8
+    add               src1q, mmsize / 2 * %1 / 8
+    sub                  wq, mmsize / 2
+    jg .loop
+    RET
+%endmacro
+
+; interpolate the padded chroma row at %2 horizontally into dwords in m%1,
+; (3 * cur + left) for even and (3 * cur + right) for odd pixels
+%macro LOAD_CHROMA_H2 2 ; dst, src
+%if mmsize == 64
+    movu                xm4, [%2]
+    movu                xm5, [%2 - 2]
+    movu                xm6, [%2 + 2]
+%else
+    movq                xm4, [%2]
+    movq                xm5, [%2 - 2]
+    movq                xm6, [%2 + 2]
+%endif
+    paddw               xm5, xm4
+    paddw               xm6, xm4
+    paddw               xm4, xm4
+    paddw               xm5, xm4
+    paddw               xm6, xm4
+%if mmsize == 64
+    punpckhwd           xm4, xm5, xm6
+    punpcklwd           xm5, xm6
+    vinserti32x4        ym5, ym5, xm4, 1
+    pmovzxwd            m%1, ym5
+%else
+    punpcklwd           xm5, xm6
+    pmovzxwd            m%1, xm5
+%endif
+%endmacro
+
+; void yuv2<dst>_<444|422>_<depth>_line(uint8_t *dst[3], const uint8_t *srcY,
+;                                       const uint16_t *srcU,
+;                                       const uint16_t *srcV,
+;                                       const int32_t *coeffs, int width)
+%macro YUV2RGB_LINE 3 ; dst format, chroma subsampling, depth
+cglobal yuv2%1_%2_%3_line, 6, 9, 16, dst, srcy, srcu, srcv, coeffs, w, dst0, dst1, dst2
+    mov               dst0q, [dstq]
+%ifnidn %1, rgb24
+    mov               dst1q, [dstq + 8]
+    mov               dst2q, [dstq + 16]
+%endif
+    vpbroadcastd         m8, [coeffsq + 4 * 0] ; y_offset
+    vpbroadcastd         m9, [coeffsq + 4 * 1] ; y_coeff
+    vpbroadcastd        m10, [coeffsq + 4 * 2] ; v2r
+    vpbroadcastd        m11, [coeffsq + 4 * 3] ; v2g
+    vpbroadcastd        m12, [coeffsq + 4 * 4] ; u2g
+    vpbroadcastd        m13, [coeffsq + 4 * 5] ; u2b
+    movd               xm14, [coeffsq + 4 * 6] ; y_shift
+    movd               xm15, [coeffsq + 4 * 7] ; c_shift
+    pxor                 m7, m7
+    movsxdifnidn         wq, wd
+.loop:
+%if %3 == 8
+    pmovzxbd             m0, [srcyq]
+%else
+    pmovzxwd             m0, [srcyq]
+%endif
+    pslld                m0, xm14
+    psubd                m0, m8
+    pmulld               m0, m9
+%ifidn %1, gbrpf32
+    paddd                m0, [pd_round_14]
+%else
+    paddd                m0, [pd_round_22]
+%endif
+%if %2 == 422
+    LOAD_CHROMA_H2        1, srcuq
+    LOAD_CHROMA_H2        2, srcvq
+%else
+    pmovzxwd             m1, [srcuq]
+    pmovzxwd             m2, [srcvq]
+%endif
+    pslld                m1, xm15
+    pslld                m2, xm15
+    psubd                m1, [pd_uv_offset]
+    psubd                m2, [pd_uv_offset]
+    pmulld               m3, m2, m10
+    pmulld               m4, m2, m11
+    pmulld               m6, m1, m12
+    pmulld               m5, m1, m13
+    paddd                m3, m0               ; R
+    paddd                m4, m6
+    paddd                m4, m0               ; G
+    paddd                m5, m0               ; B
+    pmaxsd               m3, m7
+    pmaxsd               m4, m7
+    pmaxsd               m5, m7
+    pminsd               m3, [pd_clip_30]
+    pminsd               m4, [pd_clip_30]
+    pminsd               m5, [pd_clip_30]
+%ifidn %1, rgb24
+    psrld                m3, 22
+    psrld                m4, 22
+    psrld                m5, 22
+    pslld                m4, 8
+    pslld                m5, 16
+    por                  m3, m4
+    por                  m3, m5
+    pshufb               m3, [pb_pack_rgb24]
+%if mmsize == 64
+    mova                 m6, [pd_pack_rgb24_perm]
+    vpermd               m3, m6, m3
+    movu            [dst0q], ym3
+    vextracti32x4 [dst0q + 32], m3, 2
+%else
+    mova                 m6, [pd_pack_rgb24_perm_avx2]
+    vpermd               m3, m6, m3
+    movu            [dst0q], xm3
+    vextracti128        xm3, m3, 1
+    movq       [dst0q + 16], xm3
+%endif
+    add               dst0q, mmsize / 4 * 3
+%elifidn %1, gbrp
+    psrld                m3, 22
+    psrld                m4, 22
+    psrld                m5, 22
+%if mmsize == 64
+    vpmovdb         [dst0q], m4
+    vpmovdb         [dst1q], m5
+    vpmovdb         [dst2q], m3
+%else
+    packusdw             m4, m5
+    packusdw             m3, m3
+    packuswb             m4, m3
+    mova                 m6, [pd_pack_gbrp_perm]
+    vpermd               m4, m6, m4
+    movq            [dst0q], xm4
+    movhps          [dst1q], xm4
+    vextracti128        xm4, m4, 1
+    movq            [dst2q], xm4
+%endif
+    add               dst0q, mmsize / 4
+    add               dst1q, mmsize / 4
+    add               dst2q, mmsize / 4
+%else ; gbrpf32
+    psrld                m3, 14
+    psrld                m4, 14
+    psrld                m5, 14
+    cvtdq2ps             m3, m3
+    cvtdq2ps             m4, m4
+    cvtdq2ps             m5, m5
+    mulps                m3, [ps_1_65535]
+    mulps                m4, [ps_1_65535]
+    mulps                m5, [ps_1_65535]
+    movu            [dst0q], m4
+    movu            [dst1q], m5
+    movu            [dst2q], m3
+    add               dst0q, mmsize
+    add               dst1q, mmsize
+    add               dst2q, mmsize
+%endif
+    add               srcyq, mmsize / 4 * %3 / 8
+%if %2 == 422
+    add               srcuq, mmsize / 4
+    add               srcvq, mmsize / 4
+%else
+    add               srcuq, mmsize / 2
+    add               srcvq, mmsize / 2
+%endif
+    sub                  wq, mmsize / 4
+    jg .loop
+    RET
+%endmacro
+
+%macro YUV2RGB_LINES 1 ; dst format
+YUV2RGB_LINE %1, 444, 8
+YUV2RGB_LINE %1, 444, 16
+YUV2RGB_LINE %1, 422, 8
+YUV2RGB_LINE %1, 422, 16
+%endmacro
+
+;------------------------------------------------------------------------------
+; RGB -> YUV
+;------------------------------------------------------------------------------
+
+; load mmsize / 4 pixels, starting %8 pixels into the line, as r, g and b
+; dwords into m%1-m%3, from the packed RGB24 pointer or from the G plane
+; pointer %5 with the offsets %6 and %7 of the B and R planes to it
+%macro LOAD_RGB 8 ; r, g, b, src format, src, b offset, r offset, offset
+%ifidn %4, rgb24
+    movu               xm%3, [%5 + 3 * %8]
+%if mmsize == 64
+    vinserti32x4        m%3, m%3, [%5 + 3 * %8 +  8], 1
+    vinserti32x4        m%3, m%3, [%5 + 3 * %8 + 24], 2
+    vinserti32x4        m%3, m%3, [%5 + 3 * %8 + 32], 3
+%else
+    vinserti128         m%3, m%3, [%5 + 3 * %8 +  8], 1
+%endif
+    pshufb              m%1, m%3, [pb_unpack_rgb24_r]
+    pshufb              m%2, m%3, [pb_unpack_rgb24_g]
+    pshufb              m%3, [pb_unpack_rgb24_b]
+%else
+    pmovzxbd            m%2, [%5 + %8]
+    pmovzxbd            m%3, [%5 + %6 + %8]
+    pmovzxbd            m%1, [%5 + %7 + %8]
+%endif
+%endmacro
+
+; clip the dwords in m%2 to [0, m%4] and store them with the depth %3 to %1
+%macro STORE_YUV 4 ; dst, src, depth, max
+    pmaxsd              m%2, m12
+    pminsd              m%2, m%4
+%if mmsize == 64
+%if %3 == 8
+    vpmovdb            [%1], m%2
+%else
+    vpmovdw            [%1], m%2
+%endif
+%else
+    vextracti128        xm6, m%2, 1
+    packusdw           xm%2, xm6
+%if %3 == 8
+    packuswb           xm%2, xm%2
+    movq               [%1], xm%2
+%else
+    movu               [%1], xm%2
+%endif
+%endif
+%endmacro
+
+; void <src>toyuv_<depth>_luma(uint8_t *dst, const uint8_t *src[3],
+;                              const int32_t *coeffs, int width)
+%macro RGB2YUV_LUMA 2 ; src format, depth
+cglobal %1toyuv_%2_luma, 4, 7, 16, dst, src, coeffs, w, src0, src1, src2
+    mov               src0q, [srcq]
+%ifidn %1, gbrp
+    mov               src1q, [srcq + 8]
+    mov               src2q, [srcq + 16]
+    sub               src1q, src0q
+    sub               src2q, src0q
+%endif
+    vpbroadcastd         m8, [coeffsq + 4 * 0]  ; ry
+    vpbroadcastd         m9, [coeffsq + 4 * 1]  ; gy
+    vpbroadcastd        m10, [coeffsq + 4 * 2]  ; by
+    vpbroadcastd        m11, [coeffsq + 4 * 9]  ; y_add
+    vpbroadcastd        m13, [coeffsq + 4 * 13] ; max
+    movd               xm14, [coeffsq + 4 * 11] ; y_shift
+    pxor                m12, m12
+    movsxdifnidn         wq, wd
+.loop:
+    LOAD_RGB              0, 1, 2, %1, src0q, src1q, src2q, 0
+    pmulld               m0, m8
+    pmulld               m1, m9
+    pmulld               m2, m10
+    paddd                m0, m1
+    paddd                m0, m2
+    paddd                m0, m11
+    psrad                m0, xm14
+    STORE_YUV          dstq, 0, %2, 13
+%ifidn %1, rgb24
+    add               src0q, mmsize / 4 * 3
+%else
+    add               src0q, mmsize / 4
+%endif
+    add                dstq, mmsize / 4 * %2 / 8
+    sub                  wq, mmsize / 4
+    jg .loop
+    RET
+%endmacro
+
+; sum the horizontal pairs of the dwords of m%2 and m%3 into m%1
+%macro SUM_PAIRS 4 ; dst, src1, src2, tmp
+%if mmsize == 64
+    mova                m%1, [pd_pairs_even]
+    mova                m%4, [pd_pairs_odd]
+    vpermi2d            m%1, m%2, m%3
+    vpermi2d            m%4, m%2, m%3
+    paddd               m%1, m%4
+%else
+    ; the pairs stay in lane order, which is fixed on the final values
+    phaddd              m%1, m%2, m%3
+%endif
+%endmacro
+
+; compute one chroma plane into m%1 from the r, g and b sums in m%4-m%6, with
+; the coefficients at index %2 of coeffs; %3 is set if the sums are in the
+; lane order of phaddd
+%macro RGB2YUV_CHROMA_PLANE 6 ; dst, coeff index, pairs, r, g, b
+    vpbroadcastd        m%1, [coeffsq + 4 * %2]
+    vpbroadcastd         m7, [coeffsq + 4 * (%2 + 1)]
+    vpbroadcastd         m8, [coeffsq + 4 * (%2 + 2)]
+    pmulld              m%1, m%4
+    pmulld               m7, m%5
+    pmulld               m8, m%6
+    paddd               m%1, m7
+    paddd               m%1, m8
+    paddd               m%1, m9
+    psrad               m%1, xm10
+%if mmsize == 32 && %3
+    vpermq              m%1, m%1, q3120
+%endif
+%endmacro
+
+; void <src>toyuv_<444|422|420>_<depth>_chroma(uint8_t *dstU, uint8_t *dstV,
+;                                              const uint8_t *src0[3],
+;                                              const uint8_t *src1[3],
+;                                              const int32_t *coeffs, int width)
+%macro RGB2YUV_CHROMA 3 ; src format, chroma subsampling, depth
+%ifidn %1, gbrp
+cglobal %1toyuv_%2_%3_chroma, 6, 10, 16, dstu, dstv, src0, src1, coeffs, w, srcb0, srcr0, srcb1, srcr1
+    mov              srcb0q, [src0q + 8]
+    mov              srcr0q, [src0q + 16]
+    mov              srcb1q, [src1q + 8]
+    mov              srcr1q, [src1q + 16]
+    mov               src0q, [src0q]
+    mov               src1q, [src1q]
+    sub              srcb0q, src0q
+    sub              srcr0q, src0q
+    sub              srcb1q, src1q
+    sub              srcr1q, src1q
+%else
+cglobal %1toyuv_%2_%3_chroma, 6, 6, 16, dstu, dstv, src0, src1, coeffs, w
+    mov               src0q, [src0q]
+    mov               src1q, [src1q]
+%endif
+    vpbroadcastd         m9, [coeffsq + 4 * 10] ; c_add
+    vpbroadcastd        m11, [coeffsq + 4 * 13] ; max
+    movd               xm10, [coeffsq + 4 * 12] ; c_shift
+    pxor                m12, m12
+    movsxdifnidn         wq, wd
+.loop:
+    LOAD_RGB              0, 1, 2, %1, src0q, srcb0q, srcr0q, 0
+%if %2 == 420
+    LOAD_RGB              3, 4, 5, %1, src1q, srcb1q, srcr1q, 0
+    paddd                m0, m3
+    paddd                m1, m4
+    paddd                m2, m5
+%endif
+%if %2 != 444
+    LOAD_RGB              3, 4, 5, %1, src0q, srcb0q, srcr0q, mmsize / 4
+%if %2 == 420
+    LOAD_RGB              6, 7, 8, %1, src1q, srcb1q, srcr1q, mmsize / 4
+    paddd                m3, m6
+    paddd                m4, m7
+    paddd                m5, m8
+%endif
+    SUM_PAIRS             6, 0, 3, 7
+    SUM_PAIRS             0, 1, 4, 7
+    SUM_PAIRS             1, 2, 5, 7
+    RGB2YUV_CHROMA_PLANE  3, 3, 1, 6, 0, 1
+    RGB2YUV_CHROMA_PLANE  4, 6, 1, 6, 0, 1
+%else
+    RGB2YUV_CHROMA_PLANE  3, 3, 0, 0, 1, 2
+    RGB2YUV_CHROMA_PLANE  4, 6, 0, 0, 1, 2
+%endif
+    STORE_YUV         dstuq, 3, %3, 11
+    STORE_YUV         dstvq, 4, %3, 11
+%if %2 == 444
+%define src_step mmsize / 4
+%else
+%define src_step mmsize / 2
+%endif
+%ifidn %1, rgb24
+    add               src0q, 3 * src_step
+    add               src1q, 3 * src_step
+%else
+    add               src0q, src_step
+    add               src1q, src_step
+%endif
+    add               dstuq, mmsize / 4 * %3 / 8
+    add               dstvq, mmsize / 4 * %3 / 8
+    sub                  wq, src_step
+    jg .loop
+    RET
+%endmacro
+
+%macro RGB2YUV_LINES 1 ; src format
+RGB2YUV_LUMA   %1, 8
+RGB2YUV_LUMA   %1, 16
+RGB2YUV_CHROMA %1, 444, 8
+RGB2YUV_CHROMA %1, 444, 16
+RGB2YUV_CHROMA %1, 422, 8
+RGB2YUV_CHROMA %1, 422, 16
+RGB2YUV_CHROMA %1, 420, 8
+RGB2YUV_CHROMA %1, 420, 16
+%endmacro
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+YUV2RGB_CHROMA_ROW 8
+YUV2RGB_CHROMA_ROW 16
+YUV2RGB_LINES rgb24
+YUV2RGB_LINES gbrp
+YUV2RGB_LINES gbrpf32
+RGB2YUV_LINES rgb24
+RGB2YUV_LINES gbrp
+%endif
+
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+YUV2RGB_LINES rgb24
+YUV2RGB_LINES gbrp
+YUV2RGB_LINES gbrpf32
+RGB2YUV_LINES rgb24
+RGB2YUV_LINES gbrp
+%endif
+
+%endif ; ARCH_X86_64
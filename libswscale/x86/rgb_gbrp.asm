@@ -0,0 +1,493 @@
+;******************************************************************************
+;* x86-optimized packed RGB <-> planar RGB conversion
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 64
+
+pf_255:          times 16 dd 255.0
+pf_inv255:       times 16 dd 0x3b808081 ; 1.0f / 255
+pf_1:            times 16 dd 1.0
+pd_ff000000:     times 16 dd 0xff000000
+pd_000000ff:     times 16 dd 0x000000ff
+pd_ffffffff:     times 16 dd -1
+
+pd_transpose16:  dd 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15
+pd_pack24_16_0:  dd  0,  1,  2,  4,  5,  6,  8,  9, 10, 12, 13, 14, 16, 17, 18, 20
+pd_pack24_16_1:  dd  5,  6,  8,  9, 10, 12, 13, 14, 16, 17, 18, 20, 21, 22, 24, 25
+pd_pack24_16_2:  dd 10, 12, 13, 14, 16, 17, 18, 20, 21, 22, 24, 25, 26, 28, 29, 30
+
+pd_transpose8:   dd 0, 4, 1, 5, 2, 6, 3, 7
+pd_pack24_8_0:   dd 0, 1, 2, 4, 5, 6, 0, 1
+pd_pack24_8_1:   dd 2, 4, 5, 6, 0, 1, 2, 4
+pd_pack24_8_2:   dd 5, 6, 0, 1, 2, 4, 5, 6
+
+; byte %1 of each pixel of a 24-bit input register, zero elsewhere
+pb_rgb24_00: db  0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+pb_rgb24_01: db -1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14, -1, -1, -1, -1, -1
+pb_rgb24_02: db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  1,  4,  7, 10, 13
+pb_rgb24_10: db  1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+pb_rgb24_11: db -1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1
+pb_rgb24_12: db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14
+pb_rgb24_20: db  2,  5,  8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+pb_rgb24_21: db -1, -1, -1, -1, -1,  1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1
+pb_rgb24_22: db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15
+
+pb_transpose_rgb32:   db 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15
+pb_transpose_rgb32_1: db 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12
+pb_pack24:            db 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
+
+; zero extend byte %1 of each dword
+pb_zx_byte0: db 0, -1, -1, -1, 4, -1, -1, -1,  8, -1, -1, -1, 12, -1, -1, -1
+pb_zx_byte1: db 1, -1, -1, -1, 5, -1, -1, -1,  9, -1, -1, -1, 13, -1, -1, -1
+pb_zx_byte2: db 2, -1, -1, -1, 6, -1, -1, -1, 10, -1, -1, -1, 14, -1, -1, -1
+pb_zx_byte3: db 3, -1, -1, -1, 7, -1, -1, -1, 11, -1, -1, -1, 15, -1, -1, -1
+
+; zero extend the bytes of dword %1 to dwords
+pb_zx_dword0: db  0, -1, -1, -1,  1, -1, -1, -1,  2, -1, -1, -1,  3, -1, -1, -1
+pb_zx_dword1: db  4, -1, -1, -1,  5, -1, -1, -1,  6, -1, -1, -1,  7, -1, -1, -1
+pb_zx_dword2: db  8, -1, -1, -1,  9, -1, -1, -1, 10, -1, -1, -1, 11, -1, -1, -1
+pb_zx_dword3: db 12, -1, -1, -1, 13, -1, -1, -1, 14, -1, -1, -1, 15, -1, -1, -1
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; load a 16 byte constant into all lanes of m%1
+%macro BCAST16 2
+%if mmsize == 16
+    mova            m%1, %2
+%else
+    vbroadcasti128  m%1, %2
+%endif
+%endmacro
+
+; load the 16 bytes at srcq + %2 of each group of 48 into the lanes of m%1, so
+; that three such loads hold 16 whole pixels per lane
+%macro LOAD_RGB24 2
+    movu           xm%1, [srcq + %2]
+%if mmsize == 32
+    vinserti128     m%1, m%1, [srcq + %2 + 48], 1
+%elif mmsize == 64
+    vinserti32x4    m%1, m%1, [srcq + %2 + 48], 1
+    vinserti32x4    m%1, m%1, [srcq + %2 + 96], 2
+    vinserti32x4    m%1, m%1, [srcq + %2 + 144], 3
+%endif
+%endmacro
+
+; gather one component of the 24-bit pixels in m3-m5 into m%1, with the masks
+; in m%2-m%4
+%macro GATHER_RGB24 4
+    pshufb          m%1, m3, m%2
+    pshufb           m6, m4, m%3
+    por             m%1, m6
+    pshufb           m6, m5, m%4
+    por             m%1, m6
+%endmacro
+
+; zero extend the bytes of part %3 of m%2 to the dwords of m%1
+%macro ZX_PART 3
+%if mmsize == 16
+    pshufb          m%1, m%2, [pb_zx_dword0 + %3 * 16]
+%elif mmsize == 32
+%if %3 < 2
+    ZX_HALF         %1, xm%2, %3
+%else
+    vextracti128   xm%1, m%2, 1
+    ZX_HALF         %1, xm%1, %3 - 2
+%endif
+%else
+%if %3 == 0
+    vpmovzxbd       m%1, xm%2
+%else
+    vextracti32x4  xm%1, m%2, %3
+    vpmovzxbd       m%1, xm%1
+%endif
+%endif
+%endmacro
+
+; zero extend the low (%3 == 0) or high (%3 == 1) 8 bytes of %2 into m%1
+%macro ZX_HALF 3
+%if %3
+    pshufd         xm%1, %2, q3232
+    vpmovzxbd       m%1, xm%1
+%else
+    vpmovzxbd       m%1, %2
+%endif
+%endmacro
+
+; zero extend the mmsize / 4 bytes at %2 to the dwords of m%1
+%macro LOAD_ZX 2
+%if mmsize == 16
+    movd            m%1, %2
+    pshufb          m%1, m14
+%else
+    pmovzxbd        m%1, %2
+%endif
+%endmacro
+
+; convert the dwords of m%1 to floats divided by 255, bitexact with the C code
+%macro TO_FLOAT 2
+    cvtdq2ps        m%1, m%1
+%if cpuflag(avx2)
+    mulps           m%2, m%1, [pf_inv255]
+    vfnmadd231ps    m%1, m%2, [pf_255]
+    vfmadd132ps     m%1, m%2, [pf_inv255]
+%else
+    divps           m%1, [pf_255]
+%endif
+%endmacro
+
+; convert the floats of m%1 to clipped dwords, NaN to 0, m15 is zero
+%macro FROM_FLOAT 1
+    mulps           m%1, [pf_255]
+    maxps           m%1, m15
+    minps           m%1, [pf_255]
+    cvtps2dq        m%1, m%1
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_<packed>to<planar>(uint8_t *dst[4], const uint8_t *src, int width)
+;
+; width is a multiple of 64, dst holds the planes of the packed components in
+; memory order, then alpha
+;-----------------------------------------------------------------------------
+%macro RGB2GBRP 5 ; packed name, planar name, layout (0: 24, 1: 32, 2: 32_1), alpha, float
+%if %3 == 0
+    %define IN_BPP 3
+%else
+    %define IN_BPP 4
+%endif
+
+cglobal %1to%2, 3, 8, 16, dst, src, w, dst0, dst1, dst2, dst3, x
+    mov          dst0q, [dstq]
+    mov          dst1q, [dstq + 8]
+    mov          dst2q, [dstq + 16]
+%if %4
+    mov          dst3q, [dstq + 24]
+%endif
+    movsxdifnidn    wq, wd
+    xor             xq, xq
+%if %3 == 0
+    BCAST16          7, [pb_rgb24_00]
+    BCAST16          8, [pb_rgb24_01]
+    BCAST16          9, [pb_rgb24_02]
+    BCAST16         10, [pb_rgb24_10]
+    BCAST16         11, [pb_rgb24_11]
+    BCAST16         12, [pb_rgb24_12]
+    BCAST16         13, [pb_rgb24_20]
+    BCAST16         14, [pb_rgb24_21]
+    BCAST16         15, [pb_rgb24_22]
+%elif %5
+%if %3 == 1
+    BCAST16          8, [pb_zx_byte0]
+    BCAST16          9, [pb_zx_byte1]
+    BCAST16         10, [pb_zx_byte2]
+    BCAST16         11, [pb_zx_byte3]
+%else
+    BCAST16          8, [pb_zx_byte1]
+    BCAST16          9, [pb_zx_byte2]
+    BCAST16         10, [pb_zx_byte3]
+    BCAST16         11, [pb_zx_byte0]
+%endif
+%else
+%if %3 == 1
+    BCAST16          8, [pb_transpose_rgb32]
+%else
+    BCAST16          8, [pb_transpose_rgb32_1]
+%endif
+%if mmsize == 32
+    mova             m9, [pd_transpose8]
+%elif mmsize == 64
+    mova             m9, [pd_transpose16]
+%endif
+%endif
+.loop:
+%if %3 == 0
+    LOAD_RGB24       3, 0
+    LOAD_RGB24       4, 16
+    LOAD_RGB24       5, 32
+    GATHER_RGB24     0,  7,  8,  9
+    GATHER_RGB24     1, 10, 11, 12
+    GATHER_RGB24     2, 13, 14, 15
+%if %5
+%assign k 0
+%rep 4
+    ZX_PART          3, 0, k
+    TO_FLOAT         3, 4
+    movu [dst0q + xq * 4 + k * mmsize], m3
+    ZX_PART          3, 1, k
+    TO_FLOAT         3, 4
+    movu [dst1q + xq * 4 + k * mmsize], m3
+    ZX_PART          3, 2, k
+    TO_FLOAT         3, 4
+    movu [dst2q + xq * 4 + k * mmsize], m3
+%if %4
+    mova             m6, [pf_1]
+    movu [dst3q + xq * 4 + k * mmsize], m6
+%endif
+%assign k k + 1
+%endrep
+%else
+    movu [dst0q + xq], m0
+    movu [dst1q + xq], m1
+    movu [dst2q + xq], m2
+%if %4
+    mova             m6, [pd_ffffffff]
+    movu [dst3q + xq], m6
+%endif
+%endif
+%elif %5
+%assign k 0
+%rep 4
+    movu             m0, [srcq + k * mmsize]
+    pshufb           m1, m0, m8
+    TO_FLOAT         1, 4
+    movu [dst0q + xq * 4 + k * mmsize], m1
+    pshufb           m1, m0, m9
+    TO_FLOAT         1, 4
+    movu [dst1q + xq * 4 + k * mmsize], m1
+    pshufb           m1, m0, m10
+    TO_FLOAT         1, 4
+    movu [dst2q + xq * 4 + k * mmsize], m1
+%if %4
+    pshufb           m1, m0, m11
+    TO_FLOAT         1, 4
+    movu [dst3q + xq * 4 + k * mmsize], m1
+%endif
+%assign k k + 1
+%endrep
+%else
+    ; 4x4 transpose of the components of 4 pixels in each 16 byte lane
+    movu             m0, [srcq]
+    movu             m1, [srcq + mmsize]
+    movu             m2, [srcq + mmsize * 2]
+    movu             m3, [srcq + mmsize * 3]
+    pshufb           m0, m8
+    pshufb           m1, m8
+    pshufb           m2, m8
+    pshufb           m3, m8
+    punpckldq        m4, m0, m1
+    punpckhdq        m0, m1
+    punpckldq        m5, m2, m3
+    punpckhdq        m2, m3
+    punpcklqdq       m1, m4, m5
+    punpckhqdq       m4, m5
+    punpcklqdq       m3, m0, m2
+    punpckhqdq       m0, m2
+%if mmsize > 16
+    vpermd           m1, m9, m1
+    vpermd           m4, m9, m4
+    vpermd           m3, m9, m3
+%endif
+    movu [dst0q + xq], m1
+    movu [dst1q + xq], m4
+    movu [dst2q + xq], m3
+%if %4
+%if mmsize > 16
+    vpermd           m0, m9, m0
+%endif
+    movu [dst3q + xq], m0
+%endif
+%endif
+    add           srcq, mmsize * IN_BPP
+    add             xq, mmsize
+    cmp             xq, wq
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_<planar>to<packed>(uint8_t *dst, const uint8_t *src[4], int width)
+;
+; width is a multiple of 64, src holds the planes of the packed components in
+; memory order, then alpha
+;-----------------------------------------------------------------------------
+%macro GBRP2RGB 5 ; planar name, packed name, layout (0: 24, 1: 32, 2: 32_1), alpha, float
+%if %3 == 0
+    %define OUT_BPP 3
+%else
+    %define OUT_BPP 4
+%endif
+
+cglobal %1to%2, 3, 8, 16, dst, src, w, src0, src1, src2, src3, x
+    mov          src0q, [srcq]
+    mov          src1q, [srcq + 8]
+    mov          src2q, [srcq + 16]
+%if %4
+    mov          src3q, [srcq + 24]
+%endif
+    movsxdifnidn    wq, wd
+    xor             xq, xq
+    pxor            m15, m15
+%if mmsize == 16
+    mova            m14, [pb_zx_dword0]
+%endif
+%if %3 == 0
+    BCAST16          8, [pb_pack24]
+%if mmsize == 32
+    mova             m9, [pd_pack24_8_0]
+    mova            m10, [pd_pack24_8_1]
+    mova            m11, [pd_pack24_8_2]
+%elif mmsize == 64
+    mova             m9, [pd_pack24_16_0]
+    mova            m10, [pd_pack24_16_1]
+    mova            m11, [pd_pack24_16_2]
+%endif
+%endif
+.loop:
+%assign k 0
+%rep 4
+%if %5
+    movu             m4, [src0q + xq * 4 + k * mmsize]
+    movu             m5, [src1q + xq * 4 + k * mmsize]
+    movu             m6, [src2q + xq * 4 + k * mmsize]
+    FROM_FLOAT       4
+    FROM_FLOAT       5
+    FROM_FLOAT       6
+%if %4
+    movu             m7, [src3q + xq * 4 + k * mmsize]
+    FROM_FLOAT       7
+%endif
+%else
+    LOAD_ZX          4, [src0q + xq + k * mmsize / 4]
+    LOAD_ZX          5, [src1q + xq + k * mmsize / 4]
+    LOAD_ZX          6, [src2q + xq + k * mmsize / 4]
+%if %4
+    LOAD_ZX          7, [src3q + xq + k * mmsize / 4]
+%endif
+%endif
+%if %3 == 2
+    pslld            m4, 8
+    pslld            m5, 16
+    pslld            m6, 24
+%else
+    pslld            m5, 8
+    pslld            m6, 16
+%endif
+    por              m4, m5
+    por              m4, m6
+%if %4
+%if %3 == 1
+    pslld            m7, 24
+%endif
+    por              m4, m7
+%elif %3 == 1
+    por              m4, [pd_ff000000]
+%elif %3 == 2
+    por              m4, [pd_000000ff]
+%endif
+%if %3 == 0
+    pshufb          m %+ k, m4, m8
+%else
+    movu [dstq + k * mmsize], m4
+%endif
+%assign k k + 1
+%endrep
+%if %3 == 0
+    ; m0-m3 hold 12 bytes in each 16 byte lane, compact them
+%if mmsize == 16
+    mova             m4, m1
+    pslldq           m4, 12
+    por              m4, m0
+    psrldq           m1, 4
+    mova             m5, m2
+    pslldq           m5, 8
+    por              m1, m5
+    psrldq           m2, 8
+    pslldq           m3, 4
+    por              m2, m3
+    movu [dstq],              m4
+    movu [dstq + mmsize],     m1
+    movu [dstq + mmsize * 2], m2
+%elif mmsize == 32
+    vpermd           m4, m9, m0
+    vpermd           m5, m9, m1
+    vpblendd         m4, m4, m5, 0xC0
+    vpermd           m5, m10, m1
+    vpermd           m6, m10, m2
+    vpblendd         m5, m5, m6, 0xF0
+    vpermd           m6, m11, m2
+    vpermd           m7, m11, m3
+    vpblendd         m6, m6, m7, 0xFC
+    movu [dstq],              m4
+    movu [dstq + mmsize],     m5
+    movu [dstq + mmsize * 2], m6
+%else
+    mova             m4, m9
+    vpermi2d         m4, m0, m1
+    mova             m5, m10
+    vpermi2d         m5, m1, m2
+    mova             m6, m11
+    vpermi2d         m6, m2, m3
+    movu [dstq],              m4
+    movu [dstq + mmsize],     m5
+    movu [dstq + mmsize * 2], m6
+%endif
+%endif
+    add           dstq, mmsize * OUT_BPP
+    add             xq, mmsize
+    cmp             xq, wq
+    jl .loop
+    RET
+%endmacro
+
+%macro RGB_GBRP_FUNCS 0
+RGB2GBRP rgb24,   gbrp,       0, 0, 0
+RGB2GBRP rgb24,   gbrap,      0, 1, 0
+RGB2GBRP rgb24,   gbrpf32le,  0, 0, 1
+RGB2GBRP rgb24,   gbrapf32le, 0, 1, 1
+RGB2GBRP rgb32,   gbrp,       1, 0, 0
+RGB2GBRP rgb32,   gbrap,      1, 1, 0
+RGB2GBRP rgb32,   gbrpf32le,  1, 0, 1
+RGB2GBRP rgb32,   gbrapf32le, 1, 1, 1
+RGB2GBRP rgb32_1, gbrp,       2, 0, 0
+RGB2GBRP rgb32_1, gbrap,      2, 1, 0
+RGB2GBRP rgb32_1, gbrpf32le,  2, 0, 1
+RGB2GBRP rgb32_1, gbrapf32le, 2, 1, 1
+
+; without alpha in the output, the alpha plane is ignored
+GBRP2RGB gbrp,       rgb24,   0, 0, 0
+GBRP2RGB gbrap,      rgb24,   0, 0, 0
+GBRP2RGB gbrpf32le,  rgb24,   0, 0, 1
+GBRP2RGB gbrapf32le, rgb24,   0, 0, 1
+GBRP2RGB gbrp,       rgb32,   1, 0, 0
+GBRP2RGB gbrap,      rgb32,   1, 1, 0
+GBRP2RGB gbrpf32le,  rgb32,   1, 0, 1
+GBRP2RGB gbrapf32le, rgb32,   1, 1, 1
+GBRP2RGB gbrp,       rgb32_1, 2, 0, 0
+GBRP2RGB gbrap,      rgb32_1, 2, 1, 0
+GBRP2RGB gbrpf32le,  rgb32_1, 2, 0, 1
+GBRP2RGB gbrapf32le, rgb32_1, 2, 1, 1
+%endmacro
+
+INIT_XMM ssse3
+RGB_GBRP_FUNCS
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+RGB_GBRP_FUNCS
+%endif
+
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+RGB_GBRP_FUNCS
+%endif
+%endif
@@ -450,6 +450,7 @@ INPUT_PLANAR_RGB_A_ALL_DECL(avx2);
 av_cold void ff_sws_init_swscale_x86(SwsContext *c)
 {
     int cpu_flags = av_get_cpu_flags();
+    yuv2planarX_fn yuv2planeX_c = c->yuv2planeX;
 
 #if HAVE_MMXEXT_INLINE
     if (INLINE_MMXEXT(cpu_flags))
@@ -469,6 +470,12 @@ av_cold void ff_sws_init_swscale_x86(SwsContext *c)
             c->yuv2planeX = yuv2yuvX_avx2;
 #endif
     }
+    /* Only yuv2yuvX understands the MMX filter layout, without it (e.g. no
+     * external asm) the planar vertical scaler must get the plain filter. */
+    if (c->use_mmx_vfilter && c->yuv2planeX == yuv2planeX_c &&
+        (isPlanarYUV(c->dstFormat) ||
+         (isGray(c->dstFormat) && !isALPHA(c->dstFormat))))
+        c->use_mmx_vfilter = 0;
 #if ARCH_X86_32 && !HAVE_ALIGNED_STACK
     // The better yuv2planeX_8 functions need aligned stack on x86-32,
     // so we use MMXEXT in this case if they are not available.
@@ -806,3 +813,33 @@ switch(c->dstBpc){ \
 
 #endif
 }
+
+#if ARCH_X86_64
+void ff_sws_linearize_8_avx2(float *dst, const uint8_t *src, const float *lut,
+                             int width);
+void ff_sws_linearize_16_avx2(float *dst, const uint8_t *src, const float *lut,
+                              int width);
+void ff_sws_linear_hscale_avx2(float *dst, const float *src, const float *filter,
+                               const int32_t *filterPos, int filterSize,
+                               int width);
+void ff_sws_linear_vscale_avx2(float *dst, const float *const *src,
+                               const float *filter, int filterSize, int width);
+void ff_sws_linear_vscale_delin_avx2(float *dst, const float *const *src,
+                                     const float *filter, int filterSize,
+                                     const float *lut, int width);
+#endif
+
+av_cold void ff_sws_init_linear_funcs_x86(SwsLinearContext *lin)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_SLOW_GATHER)) {
+        lin->linearize    = lin->is16 ? ff_sws_linearize_16_avx2
+                                      : ff_sws_linearize_8_avx2;
+        lin->hscale       = ff_sws_linear_hscale_avx2;
+        lin->vscale       = ff_sws_linear_vscale_avx2;
+        lin->vscale_delin = ff_sws_linear_vscale_delin_avx2;
+    }
+#endif
+}
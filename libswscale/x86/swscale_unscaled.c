@@ -0,0 +1,262 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/x86/cpu.h"
+#include "libswscale/swscale_internal.h"
+
+#define YUV2RGB_LINE_FUNCS(name, opt)                                         \
+void ff_ ## name ## _444_8_line_  ## opt(uint8_t *dst[3], const uint8_t *srcY, \
+        const uint16_t *srcU, const uint16_t *srcV, const int32_t *coeffs,    \
+        int width);                                                           \
+void ff_ ## name ## _444_16_line_ ## opt(uint8_t *dst[3], const uint8_t *srcY, \
+        const uint16_t *srcU, const uint16_t *srcV, const int32_t *coeffs,    \
+        int width);                                                           \
+void ff_ ## name ## _422_8_line_  ## opt(uint8_t *dst[3], const uint8_t *srcY, \
+        const uint16_t *srcU, const uint16_t *srcV, const int32_t *coeffs,    \
+        int width);                                                           \
+void ff_ ## name ## _422_16_line_ ## opt(uint8_t *dst[3], const uint8_t *srcY, \
+        const uint16_t *srcU, const uint16_t *srcV, const int32_t *coeffs,    \
+        int width);
+
+#define RGB2YUV_CHROMA_FUNC(name, opt)                                        \
+void ff_ ## name ## _chroma_ ## opt(uint8_t *dstU, uint8_t *dstV,             \
+        const uint8_t *src0[3], const uint8_t *src1[3],                       \
+        const int32_t *coeffs, int width);
+
+#define RGB2YUV_LINE_FUNCS(name, opt)                                         \
+void ff_ ## name ## _8_luma_  ## opt(uint8_t *dst, const uint8_t *src[3],     \
+                                     const int32_t *coeffs, int width);       \
+void ff_ ## name ## _16_luma_ ## opt(uint8_t *dst, const uint8_t *src[3],     \
+                                     const int32_t *coeffs, int width);       \
+RGB2YUV_CHROMA_FUNC(name ## _444_8,  opt)                                     \
+RGB2YUV_CHROMA_FUNC(name ## _444_16, opt)                                     \
+RGB2YUV_CHROMA_FUNC(name ## _422_8,  opt)                                     \
+RGB2YUV_CHROMA_FUNC(name ## _422_16, opt)                                     \
+RGB2YUV_CHROMA_FUNC(name ## _420_8,  opt)                                     \
+RGB2YUV_CHROMA_FUNC(name ## _420_16, opt)
+
+#define PLANAR_YUV_RGB_FUNCS(opt)                                             \
+YUV2RGB_LINE_FUNCS(yuv2rgb24,   opt)                                          \
+YUV2RGB_LINE_FUNCS(yuv2gbrp,    opt)                                          \
+YUV2RGB_LINE_FUNCS(yuv2gbrpf32, opt)                                          \
+RGB2YUV_LINE_FUNCS(rgb24toyuv,  opt)                                          \
+RGB2YUV_LINE_FUNCS(gbrptoyuv,   opt)
+
+void ff_yuv2rgb_chroma_row_8_avx2(uint16_t *dst, const uint8_t *src0,
+                                  const uint8_t *src1, int width);
+void ff_yuv2rgb_chroma_row_16_avx2(uint16_t *dst, const uint8_t *src0,
+                                   const uint8_t *src1, int width);
+
+PLANAR_YUV_RGB_FUNCS(avx2)
+PLANAR_YUV_RGB_FUNCS(avx512)
+
+#define BAYER_INTERP_LINE_FUNCS(opt)                                          \
+void ff_bayer_interp_line_8_ ## opt(uint8_t *dst_c, uint8_t *dst_g,           \
+        uint8_t *dst_o, const uint8_t *src, ptrdiff_t src_stride, int width); \
+void ff_bayer_interp_line_16_ ## opt(uint8_t *dst_c, uint8_t *dst_g,          \
+        uint8_t *dst_o, const uint8_t *src, ptrdiff_t src_stride, int width); \
+void ff_bayer_interp_line_16_to_8_ ## opt(uint8_t *dst_c, uint8_t *dst_g,     \
+        uint8_t *dst_o, const uint8_t *src, ptrdiff_t src_stride, int width);
+
+BAYER_INTERP_LINE_FUNCS(sse4)
+BAYER_INTERP_LINE_FUNCS(avx2)
+
+#define SELECT_BAYER_INTERP_LINE(opt)                                         \
+    (!is16 ? ff_bayer_interp_line_8_       ## opt                             \
+   : out16 ? ff_bayer_interp_line_16_      ## opt                             \
+           : ff_bayer_interp_line_16_to_8_ ## opt)
+
+#define RGB_GBRP_LINE_FUNCS(layout, opt)                                      \
+void ff_ ## layout ## togbrp_       ## opt(uint8_t *dst[4],                   \
+                                           const uint8_t *src, int width);    \
+void ff_ ## layout ## togbrap_      ## opt(uint8_t *dst[4],                   \
+                                           const uint8_t *src, int width);    \
+void ff_ ## layout ## togbrpf32le_  ## opt(uint8_t *dst[4],                   \
+                                           const uint8_t *src, int width);    \
+void ff_ ## layout ## togbrapf32le_ ## opt(uint8_t *dst[4],                   \
+                                           const uint8_t *src, int width);    \
+void ff_gbrpto       ## layout ## _ ## opt(uint8_t *dst,                      \
+                                           const uint8_t *src[4], int width); \
+void ff_gbrapto      ## layout ## _ ## opt(uint8_t *dst,                      \
+                                           const uint8_t *src[4], int width); \
+void ff_gbrpf32leto  ## layout ## _ ## opt(uint8_t *dst,                      \
+                                           const uint8_t *src[4], int width); \
+void ff_gbrapf32leto ## layout ## _ ## opt(uint8_t *dst,                      \
+                                           const uint8_t *src[4], int width);
+
+#define RGB_GBRP_FUNCS(opt)                                                   \
+RGB_GBRP_LINE_FUNCS(rgb24,   opt)                                             \
+RGB_GBRP_LINE_FUNCS(rgb32,   opt)                                             \
+RGB_GBRP_LINE_FUNCS(rgb32_1, opt)
+
+RGB_GBRP_FUNCS(ssse3)
+RGB_GBRP_FUNCS(avx2)
+RGB_GBRP_FUNCS(avx512)
+
+#define SELECT_RGB2GBRP_LINE(layout, opt)                                     \
+    (alpha ? isf ? ff_ ## layout ## togbrapf32le_ ## opt                      \
+                 : ff_ ## layout ## togbrap_      ## opt                      \
+           : isf ? ff_ ## layout ## togbrpf32le_  ## opt                      \
+                 : ff_ ## layout ## togbrp_       ## opt)
+
+#define SELECT_GBRP2RGB_LINE(layout, opt)                                     \
+    (alpha ? isf ? ff_gbrapf32leto ## layout ## _ ## opt                      \
+                 : ff_gbrapto      ## layout ## _ ## opt                      \
+           : isf ? ff_gbrpf32leto  ## layout ## _ ## opt                      \
+                 : ff_gbrpto       ## layout ## _ ## opt)
+
+#define SELECT_RGB_GBRP_LINE(layout, opt)                                     \
+    do {                                                                      \
+        if (c->rgb2gbrp_line)                                                 \
+            c->rgb2gbrp_line = SELECT_RGB2GBRP_LINE(layout, opt);             \
+        else                                                                  \
+            c->gbrp2rgb_line = SELECT_GBRP2RGB_LINE(layout, opt);             \
+    } while (0)
+
+#define SELECT_RGB_GBRP(opt)                                                  \
+    do {                                                                      \
+        switch (packed) {                                                     \
+        case AV_PIX_FMT_RGB24:                                                \
+        case AV_PIX_FMT_BGR24:                                                \
+            SELECT_RGB_GBRP_LINE(rgb24, opt);                                 \
+            break;                                                            \
+        case AV_PIX_FMT_RGBA:                                                 \
+        case AV_PIX_FMT_BGRA:                                                 \
+            SELECT_RGB_GBRP_LINE(rgb32, opt);                                 \
+            break;                                                            \
+        case AV_PIX_FMT_ARGB:                                                 \
+        case AV_PIX_FMT_ABGR:                                                 \
+            SELECT_RGB_GBRP_LINE(rgb32_1, opt);                               \
+            break;                                                            \
+        }                                                                     \
+    } while (0)
+
+#define SELECT_YUV2RGB_LINE(name, opt)                                        \
+    (hsub ? is16 ? ff_ ## name ## _422_16_line_ ## opt                        \
+                 : ff_ ## name ## _422_8_line_  ## opt                        \
+          : is16 ? ff_ ## name ## _444_16_line_ ## opt                        \
+                 : ff_ ## name ## _444_8_line_  ## opt)
+
+#define SELECT_YUV2RGB(opt)                                                   \
+    do {                                                                      \
+        switch (c->dstFormat) {                                               \
+        case AV_PIX_FMT_RGB24:                                                \
+        case AV_PIX_FMT_BGR24:                                                \
+            c->yuv2rgb_line = SELECT_YUV2RGB_LINE(yuv2rgb24, opt);            \
+            break;                                                            \
+        case AV_PIX_FMT_GBRP:                                                 \
+            c->yuv2rgb_line = SELECT_YUV2RGB_LINE(yuv2gbrp, opt);             \
+            break;                                                            \
+        case AV_PIX_FMT_GBRPF32:                                              \
+            c->yuv2rgb_line = SELECT_YUV2RGB_LINE(yuv2gbrpf32, opt);          \
+            break;                                                            \
+        }                                                                     \
+    } while (0)
+
+#define SELECT_RGB2YUV_CHROMA(name, opt)                                      \
+    (vsub ? is16 ? ff_ ## name ## _420_16_chroma_ ## opt                      \
+                 : ff_ ## name ## _420_8_chroma_  ## opt                      \
+   : hsub ? is16 ? ff_ ## name ## _422_16_chroma_ ## opt                      \
+                 : ff_ ## name ## _422_8_chroma_  ## opt                      \
+          : is16 ? ff_ ## name ## _444_16_chroma_ ## opt                      \
+                 : ff_ ## name ## _444_8_chroma_  ## opt)
+
+#define SELECT_RGB2YUV(opt)                                                   \
+    do {                                                                      \
+        switch (c->srcFormat) {                                               \
+        case AV_PIX_FMT_RGB24:                                                \
+        case AV_PIX_FMT_BGR24:                                                \
+            c->rgb2yuv_luma   = is16 ? ff_rgb24toyuv_16_luma_ ## opt          \
+                                     : ff_rgb24toyuv_8_luma_  ## opt;         \
+            c->rgb2yuv_chroma = SELECT_RGB2YUV_CHROMA(rgb24toyuv, opt);       \
+            break;                                                            \
+        case AV_PIX_FMT_GBRP:                                                 \
+            c->rgb2yuv_luma   = is16 ? ff_gbrptoyuv_16_luma_ ## opt           \
+                                     : ff_gbrptoyuv_8_luma_  ## opt;          \
+            c->rgb2yuv_chroma = SELECT_RGB2YUV_CHROMA(gbrptoyuv, opt);        \
+            break;                                                            \
+        }                                                                     \
+    } while (0)
+
+av_cold void ff_get_unscaled_swscale_x86(SwsContext *c)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (c->yuv2rgb_line) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+        const int hsub = desc->log2_chroma_w;
+        const int is16 = desc->comp[0].depth > 8;
+
+        if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+            c->yuv2rgb_chroma_row = is16 ? ff_yuv2rgb_chroma_row_16_avx2
+                                         : ff_yuv2rgb_chroma_row_8_avx2;
+            SELECT_YUV2RGB(avx2);
+        }
+        if (EXTERNAL_AVX512(cpu_flags))
+            SELECT_YUV2RGB(avx512);
+    }
+
+    /* RGB48 is left to the C code */
+    if (c->rgb2yuv_luma && c->srcFormat != AV_PIX_FMT_RGB48) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->dstFormat);
+        const int hsub = desc->log2_chroma_w;
+        const int vsub = desc->log2_chroma_h;
+        const int is16 = desc->comp[0].depth > 8;
+
+        if (EXTERNAL_AVX2_FAST(cpu_flags))
+            SELECT_RGB2YUV(avx2);
+        if (EXTERNAL_AVX512(cpu_flags))
+            SELECT_RGB2YUV(avx512);
+    }
+
+    /* big endian Bayer is left to the C code */
+    if (c->bayer_interp_line && !isBE(c->srcFormat)) {
+        const int is16  = isBayer16BPS(c->srcFormat);
+        const int out16 = c->dstFormat == AV_PIX_FMT_GBRP16;
+
+        if (EXTERNAL_SSE4(cpu_flags))
+            c->bayer_interp_line = SELECT_BAYER_INTERP_LINE(sse4);
+        if (EXTERNAL_AVX2_FAST(cpu_flags))
+            c->bayer_interp_line = SELECT_BAYER_INTERP_LINE(avx2);
+    }
+
+    if (c->rgb2gbrp_line || c->gbrp2rgb_line) {
+        const enum AVPixelFormat packed = c->rgb2gbrp_line ? c->srcFormat
+                                                           : c->dstFormat;
+        const enum AVPixelFormat planar = c->rgb2gbrp_line ? c->dstFormat
+                                                           : c->srcFormat;
+        const int alpha = !!isALPHA(planar);
+        const int isf   = isFloat(planar);
+
+        /* big endian float is left to the C code */
+        if (!(isf && isBE(planar))) {
+            if (EXTERNAL_SSSE3(cpu_flags))
+                SELECT_RGB_GBRP(ssse3);
+            if (EXTERNAL_AVX2_FAST(cpu_flags) && (!isf || EXTERNAL_FMA3(cpu_flags)))
+                SELECT_RGB_GBRP(avx2);
+            if (EXTERNAL_AVX512(cpu_flags))
+                SELECT_RGB_GBRP(avx512);
+        }
+    }
+#endif
+}
@@ -17,11 +17,14 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <math.h>
 #include <string.h>
 
 #include "libavutil/common.h"
+#include "libavutil/intfloat.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 
 #include "libswscale/swscale.h"
@@ -398,6 +401,147 @@ static void check_input_planar_rgb_to_a(void)
     sws_freeContext(ctx);
 }
 
+#define RGB_LINE_W 256
+
+static const enum AVPixelFormat rgb_line_packed_fmts[] = {
+    AV_PIX_FMT_RGB24, AV_PIX_FMT_RGBA, AV_PIX_FMT_ARGB,
+};
+
+static const enum AVPixelFormat rgb_line_planar_fmts[] = {
+    AV_PIX_FMT_GBRP,      AV_PIX_FMT_GBRAP,
+    AV_PIX_FMT_GBRPF32LE, AV_PIX_FMT_GBRAPF32LE,
+};
+
+static struct SwsContext *alloc_unscaled_context(enum AVPixelFormat src,
+                                                 enum AVPixelFormat dst)
+{
+    struct SwsContext *ctx = sws_alloc_context();
+
+    if (!ctx)
+        return NULL;
+    av_opt_set_int(ctx, "srcw", RGB_LINE_W, 0);
+    av_opt_set_int(ctx, "srch", 2, 0);
+    av_opt_set_int(ctx, "dstw", RGB_LINE_W, 0);
+    av_opt_set_int(ctx, "dsth", 2, 0);
+    av_opt_set_int(ctx, "src_format", src, 0);
+    av_opt_set_int(ctx, "dst_format", dst, 0);
+    av_opt_set_int(ctx, "sws_flags", SWS_BILINEAR, 0);
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        sws_freeContext(ctx), ctx = NULL;
+    return ctx;
+}
+
+static void check_rgb2gbrp_line(void)
+{
+    const int plane_size = RGB_LINE_W * 4;
+    LOCAL_ALIGNED_32(uint8_t, src, [RGB_LINE_W * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_buf, [4 * RGB_LINE_W * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_buf, [4 * RGB_LINE_W * 4]);
+
+    declare_func(void, uint8_t *dst[4], const uint8_t *src, int width);
+
+    randomize_buffers(src, RGB_LINE_W * 4);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(rgb_line_packed_fmts); i++) {
+        for (int j = 0; j < FF_ARRAY_ELEMS(rgb_line_planar_fmts); j++) {
+            const enum AVPixelFormat planar = rgb_line_planar_fmts[j];
+            const int alpha = !!isALPHA(planar);
+            struct SwsContext *ctx = alloc_unscaled_context(rgb_line_packed_fmts[i],
+                                                            planar);
+            uint8_t *dst0[4] = { NULL }, *dst1[4] = { NULL };
+
+            if (!ctx) {
+                fail();
+                return;
+            }
+            for (int p = 0; p < 3 + alpha; p++) {
+                dst0[p] = dst0_buf + p * plane_size;
+                dst1[p] = dst1_buf + p * plane_size;
+            }
+            if (check_func(ctx->rgb2gbrp_line, "%s_to_%s",
+                           av_get_pix_fmt_name(rgb_line_packed_fmts[i]),
+                           av_get_pix_fmt_name(planar))) {
+                for (int w = 64; w <= RGB_LINE_W; w += 64) {
+                    memset(dst0_buf, 0, 4 * plane_size);
+                    memset(dst1_buf, 0, 4 * plane_size);
+                    call_ref(dst0, src, w);
+                    call_new(dst1, src, w);
+                    if (memcmp(dst0_buf, dst1_buf, 4 * plane_size))
+                        fail();
+                }
+                bench_new(dst1, src, RGB_LINE_W);
+            }
+            sws_freeContext(ctx);
+        }
+    }
+}
+
+/* in and out of range values, halfway between two 8-bit values, NaN and
+ * infinities */
+static void randomize_float_plane(uint8_t *buf, int width)
+{
+    for (int i = 0; i < width; i++) {
+        float f;
+
+        switch (rnd() & 7) {
+        case 0:  f = NAN;                                           break;
+        case 1:  f = rnd() & 1 ? INFINITY : -INFINITY;              break;
+        case 2:  f = (rnd() & 0xff) / 255.0f;                       break;
+        case 3:  f = ((rnd() & 0xff) + 0.5f) / 255.0f;              break;
+        default: f = (rnd() & 0xffffff) / (float)0xffffff * 2.0f - 0.5f;
+        }
+        AV_WN32(buf + 4 * i, av_float2int(f));
+    }
+}
+
+static void check_gbrp2rgb_line(void)
+{
+    const int plane_size = RGB_LINE_W * 4;
+    LOCAL_ALIGNED_32(uint8_t, src_buf, [4 * RGB_LINE_W * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [RGB_LINE_W * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [RGB_LINE_W * 4]);
+
+    declare_func(void, uint8_t *dst, const uint8_t *src[4], int width);
+
+    for (int j = 0; j < FF_ARRAY_ELEMS(rgb_line_planar_fmts); j++) {
+        const enum AVPixelFormat planar = rgb_line_planar_fmts[j];
+        const int alpha = !!isALPHA(planar);
+        const uint8_t *src[4] = { NULL };
+
+        for (int p = 0; p < 3 + alpha; p++) {
+            src[p] = src_buf + p * plane_size;
+            if (isFloat(planar))
+                randomize_float_plane(src_buf + p * plane_size, RGB_LINE_W);
+            else
+                randomize_buffers(src_buf + p * plane_size, RGB_LINE_W);
+        }
+
+        for (int i = 0; i < FF_ARRAY_ELEMS(rgb_line_packed_fmts); i++) {
+            struct SwsContext *ctx = alloc_unscaled_context(planar,
+                                                            rgb_line_packed_fmts[i]);
+
+            if (!ctx) {
+                fail();
+                return;
+            }
+            if (check_func(ctx->gbrp2rgb_line, "%s_to_%s",
+                           av_get_pix_fmt_name(planar),
+                           av_get_pix_fmt_name(rgb_line_packed_fmts[i]))) {
+                for (int w = 64; w <= RGB_LINE_W; w += 64) {
+                    memset(dst0, 0, RGB_LINE_W * 4);
+                    memset(dst1, 0, RGB_LINE_W * 4);
+                    call_ref(dst0, src, w);
+                    call_new(dst1, src, w);
+                    if (memcmp(dst0, dst1, RGB_LINE_W * 4))
+                        fail();
+                }
+                bench_new(dst1, src, RGB_LINE_W);
+            }
+            sws_freeContext(ctx);
+        }
+    }
+}
+
 void checkasm_check_sw_gbrp(void)
 {
     check_output_yuv2gbrp();
@@ -411,4 +555,10 @@ void checkasm_check_sw_gbrp(void)
 
     check_input_planar_rgb_to_a();
     report("input_planar_rgb_a");
+
+    check_rgb2gbrp_line();
+    report("rgb2gbrp_line");
+
+    check_gbrp2rgb_line();
+    report("gbrp2rgb_line");
 }
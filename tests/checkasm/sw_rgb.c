@@ -22,8 +22,12 @@
 #include "libavutil/common.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
 
 #include "libswscale/rgb2rgb.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
 
 #include "checkasm.h"
 
@@ -179,6 +183,343 @@ static void check_interleave_bytes(void)
     }
 }
 
+#define LINE_W 128
+
+/* the unscaled planar YUV <-> RGB line functions are picked by
+ * sws_init_context(), without dithering so that the table based yuv2rgb
+ * converters do not take precedence */
+static struct SwsContext *alloc_unscaled_context(enum AVPixelFormat src,
+                                                 enum AVPixelFormat dst)
+{
+    struct SwsContext *ctx = sws_alloc_context();
+
+    if (!ctx)
+        return NULL;
+    av_opt_set_int(ctx, "srcw", LINE_W, 0);
+    av_opt_set_int(ctx, "srch", 2, 0);
+    av_opt_set_int(ctx, "dstw", LINE_W, 0);
+    av_opt_set_int(ctx, "dsth", 2, 0);
+    av_opt_set_int(ctx, "src_format", src, 0);
+    av_opt_set_int(ctx, "dst_format", dst, 0);
+    av_opt_set_int(ctx, "sws_flags", SWS_BILINEAR, 0);
+    av_opt_set_int(ctx, "sws_dither", SWS_DITHER_NONE, 0);
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        sws_freeContext(ctx), ctx = NULL;
+    return ctx;
+}
+
+static void check_yuv2rgb_chroma_row(void)
+{
+    static const enum AVPixelFormat src_fmts[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P10,
+    };
+    LOCAL_ALIGNED_32(uint16_t, src0, [LINE_W]);
+    LOCAL_ALIGNED_32(uint16_t, src1, [LINE_W]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [LINE_W]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [LINE_W]);
+
+    declare_func(void, uint16_t *dst, const uint8_t *src0,
+                 const uint8_t *src1, int width);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(src_fmts); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src_fmts[i]);
+        const int depth = desc->comp[0].depth;
+        struct SwsContext *ctx = alloc_unscaled_context(src_fmts[i],
+                                                        AV_PIX_FMT_GBRP);
+
+        if (!ctx) {
+            fail();
+            return;
+        }
+        for (int j = 0; j < LINE_W; j++) {
+            if (depth > 8) {
+                src0[j] = rnd() & ((1 << depth) - 1);
+                src1[j] = rnd() & ((1 << depth) - 1);
+            } else {
+                ((uint8_t *)src0)[j] = rnd();
+                ((uint8_t *)src1)[j] = rnd();
+            }
+        }
+        if (check_func(ctx->yuv2rgb_chroma_row, "yuv2rgb_chroma_row_%d",
+                       depth > 8 ? 16 : 8)) {
+            for (int w = 16; w <= LINE_W; w += 16) {
+                memset(dst0, 0, LINE_W * sizeof(*dst0));
+                memset(dst1, 0, LINE_W * sizeof(*dst1));
+                call_ref(dst0, (const uint8_t *)src0, (const uint8_t *)src1, w);
+                call_new(dst1, (const uint8_t *)src0, (const uint8_t *)src1, w);
+                if (memcmp(dst0, dst1, LINE_W * sizeof(*dst0)))
+                    fail();
+            }
+            bench_new(dst1, (const uint8_t *)src0, (const uint8_t *)src1, LINE_W);
+        }
+        sws_freeContext(ctx);
+    }
+}
+
+static void check_yuv2rgb_line(void)
+{
+    static const enum AVPixelFormat src_fmts[] = {
+        AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV422P,
+        AV_PIX_FMT_YUV444P12, AV_PIX_FMT_YUV422P10,
+    };
+    static const struct {
+        enum AVPixelFormat fmt;
+        const char *name;
+        int bpp;
+    } dst_fmts[] = {
+        { AV_PIX_FMT_RGB24,   "rgb24",   3 },
+        { AV_PIX_FMT_GBRP,    "gbrp",    1 },
+        { AV_PIX_FMT_GBRPF32, "gbrpf32", 4 },
+    };
+    LOCAL_ALIGNED_32(uint16_t, src_y, [LINE_W]);
+    /* the chroma rows are padded by one sample on each side */
+    LOCAL_ALIGNED_32(uint16_t, src_u, [LINE_W + 2]);
+    LOCAL_ALIGNED_32(uint16_t, src_v, [LINE_W + 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_buf, [3 * LINE_W * 4 + 3 * 64]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_buf, [3 * LINE_W * 4 + 3 * 64]);
+    const int plane_size = LINE_W * 4 + 64;
+
+    declare_func(void, uint8_t *dst[3], const uint8_t *srcY,
+                 const uint16_t *srcU, const uint16_t *srcV,
+                 const int32_t *coeffs, int width);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(src_fmts); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src_fmts[i]);
+        const int depth = desc->comp[0].depth;
+        const int hsub  = desc->log2_chroma_w;
+
+        for (int j = 0; j < LINE_W; j++) {
+            if (depth > 8)
+                src_y[j] = rnd() & ((1 << depth) - 1);
+            else
+                ((uint8_t *)src_y)[j] = rnd();
+        }
+        /* the rows hold 3:1 weighted sums of two chroma lines */
+        for (int j = 0; j < LINE_W + 2; j++) {
+            src_u[j] = rnd() % (4 << depth);
+            src_v[j] = rnd() % (4 << depth);
+        }
+
+        for (int k = 0; k < FF_ARRAY_ELEMS(dst_fmts); k++) {
+            struct SwsContext *ctx = alloc_unscaled_context(src_fmts[i],
+                                                            dst_fmts[k].fmt);
+            uint8_t *dst0[3], *dst1[3];
+            int32_t coeffs[YUV2RGB_NB_COEFFS];
+
+            if (!ctx) {
+                fail();
+                return;
+            }
+            coeffs[YUV2RGB_Y_OFFSET] = ctx->yuv2rgb_y_offset;
+            coeffs[YUV2RGB_Y_COEFF]  = ctx->yuv2rgb_y_coeff;
+            coeffs[YUV2RGB_V2R]      = ctx->yuv2rgb_v2r_coeff;
+            coeffs[YUV2RGB_V2G]      = ctx->yuv2rgb_v2g_coeff;
+            coeffs[YUV2RGB_U2G]      = ctx->yuv2rgb_u2g_coeff;
+            coeffs[YUV2RGB_U2B]      = ctx->yuv2rgb_u2b_coeff;
+            coeffs[YUV2RGB_Y_SHIFT]  = 17 - depth;
+            coeffs[YUV2RGB_C_SHIFT]  = 15 - depth - 2 * hsub;
+            for (int p = 0; p < 3; p++) {
+                dst0[p] = dst0_buf + p * plane_size;
+                dst1[p] = dst1_buf + p * plane_size;
+            }
+
+            if (check_func(ctx->yuv2rgb_line, "yuv2%s_%s_%d_line",
+                           dst_fmts[k].name, hsub ? "422" : "444",
+                           depth > 8 ? 16 : 8)) {
+                for (int w = 32; w <= LINE_W; w += 32) {
+                    memset(dst0_buf, 0, 3 * plane_size);
+                    memset(dst1_buf, 0, 3 * plane_size);
+                    call_ref(dst0, (const uint8_t *)src_y, src_u + 1, src_v + 1,
+                             coeffs, w);
+                    call_new(dst1, (const uint8_t *)src_y, src_u + 1, src_v + 1,
+                             coeffs, w);
+                    if (memcmp(dst0_buf, dst1_buf, 3 * plane_size))
+                        fail();
+                }
+                bench_new(dst1, (const uint8_t *)src_y, src_u + 1, src_v + 1,
+                          coeffs, LINE_W);
+            }
+            sws_freeContext(ctx);
+        }
+    }
+}
+
+static const struct {
+    enum AVPixelFormat fmt;
+    const char *name;
+} rgb2yuv_src_fmts[] = {
+    { AV_PIX_FMT_RGB24, "rgb24" },
+    { AV_PIX_FMT_GBRP,  "gbrp"  },
+};
+
+static const enum AVPixelFormat rgb2yuv_dst_fmts[] = {
+    AV_PIX_FMT_YUV444P,   AV_PIX_FMT_YUV422P,   AV_PIX_FMT_YUV420P,
+    AV_PIX_FMT_YUV444P10, AV_PIX_FMT_YUV422P10, AV_PIX_FMT_YUV420P10,
+};
+
+/* limited range coefficients, as set up by rgbToPlanarYuvWrapper() */
+static struct SwsContext *alloc_rgb2yuv_context(enum AVPixelFormat src,
+                                                enum AVPixelFormat dst,
+                                                int32_t *coeffs)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dst);
+    const int depth = desc->comp[0].depth;
+    const int sub   = desc->log2_chroma_w + desc->log2_chroma_h;
+    const int sh    = RGB2YUV_SHIFT - (depth - 8);
+    struct SwsContext *ctx = alloc_unscaled_context(src, dst);
+
+    if (!ctx)
+        return NULL;
+    for (int p = 0; p < 9; p++)
+        coeffs[p] = ctx->input_rgb2yuv_table[p];
+    coeffs[RGB2YUV_Y_ADD]   = (16 << RGB2YUV_SHIFT) + (1 << (sh - 1));
+    coeffs[RGB2YUV_C_ADD]   = (128 << RGB2YUV_SHIFT << sub) + (1 << (sh + sub - 1));
+    coeffs[RGB2YUV_Y_SHIFT] = sh;
+    coeffs[RGB2YUV_C_SHIFT] = sh + sub;
+    coeffs[RGB2YUV_MAX]     = (1 << depth) - 1;
+    return ctx;
+}
+
+static void check_rgb2yuv_luma(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src_buf, [3 * LINE_W * 3]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [LINE_W * 2 + 64]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [LINE_W * 2 + 64]);
+    const uint8_t *src[3] = { src_buf, src_buf + 3 * LINE_W, src_buf + 6 * LINE_W };
+
+    declare_func(void, uint8_t *dst, const uint8_t *src[3],
+                 const int32_t *coeffs, int width);
+
+    randomize_buffers(src_buf, 3 * LINE_W * 3);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(rgb2yuv_src_fmts); i++) {
+        for (int k = 0; k < FF_ARRAY_ELEMS(rgb2yuv_dst_fmts); k++) {
+            const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(rgb2yuv_dst_fmts[k]);
+            int32_t coeffs[RGB2YUV_NB_COEFFS];
+            struct SwsContext *ctx = alloc_rgb2yuv_context(rgb2yuv_src_fmts[i].fmt,
+                                                           rgb2yuv_dst_fmts[k],
+                                                           coeffs);
+
+            if (!ctx) {
+                fail();
+                return;
+            }
+            if (check_func(ctx->rgb2yuv_luma, "%stoyuv_%d_luma",
+                           rgb2yuv_src_fmts[i].name,
+                           desc->comp[0].depth > 8 ? 16 : 8)) {
+                for (int w = 32; w <= LINE_W; w += 32) {
+                    memset(dst0, 0, LINE_W * 2 + 64);
+                    memset(dst1, 0, LINE_W * 2 + 64);
+                    call_ref(dst0, src, coeffs, w);
+                    call_new(dst1, src, coeffs, w);
+                    if (memcmp(dst0, dst1, LINE_W * 2 + 64))
+                        fail();
+                }
+                bench_new(dst1, src, coeffs, LINE_W);
+            }
+            sws_freeContext(ctx);
+        }
+    }
+}
+
+static void check_rgb2yuv_chroma(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src_buf, [2 * 3 * LINE_W * 3]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [2 * (LINE_W * 2 + 64)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [2 * (LINE_W * 2 + 64)]);
+    const int plane_size = LINE_W * 2 + 64;
+    const uint8_t *src0[3], *src1[3];
+
+    declare_func(void, uint8_t *dstU, uint8_t *dstV, const uint8_t *src0[3],
+                 const uint8_t *src1[3], const int32_t *coeffs, int width);
+
+    randomize_buffers(src_buf, 2 * 3 * LINE_W * 3);
+    for (int p = 0; p < 3; p++) {
+        src0[p] = src_buf + p * 3 * LINE_W;
+        src1[p] = src_buf + (p + 3) * 3 * LINE_W;
+    }
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(rgb2yuv_src_fmts); i++) {
+        for (int k = 0; k < FF_ARRAY_ELEMS(rgb2yuv_dst_fmts); k++) {
+            const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(rgb2yuv_dst_fmts[k]);
+            int32_t coeffs[RGB2YUV_NB_COEFFS];
+            struct SwsContext *ctx = alloc_rgb2yuv_context(rgb2yuv_src_fmts[i].fmt,
+                                                           rgb2yuv_dst_fmts[k],
+                                                           coeffs);
+
+            if (!ctx) {
+                fail();
+                return;
+            }
+            if (check_func(ctx->rgb2yuv_chroma, "%stoyuv_%s_%d_chroma",
+                           rgb2yuv_src_fmts[i].name,
+                           desc->log2_chroma_h ? "420" :
+                           desc->log2_chroma_w ? "422" : "444",
+                           desc->comp[0].depth > 8 ? 16 : 8)) {
+                for (int w = 32; w <= LINE_W; w += 32) {
+                    memset(dst0, 0, 2 * plane_size);
+                    memset(dst1, 0, 2 * plane_size);
+                    call_ref(dst0, dst0 + plane_size, src0, src1, coeffs, w);
+                    call_new(dst1, dst1 + plane_size, src0, src1, coeffs, w);
+                    if (memcmp(dst0, dst1, 2 * plane_size))
+                        fail();
+                }
+                bench_new(dst1, dst1 + plane_size, src0, src1, coeffs, LINE_W);
+            }
+            sws_freeContext(ctx);
+        }
+    }
+}
+
+static void check_bayer_interp_line(void)
+{
+    static const struct {
+        enum AVPixelFormat src, dst;
+        const char *name;
+    } fmts[] = {
+        { AV_PIX_FMT_BAYER_BGGR8,    AV_PIX_FMT_GBRP,   "8"       },
+        { AV_PIX_FMT_BAYER_BGGR16LE, AV_PIX_FMT_GBRP16, "16"      },
+        { AV_PIX_FMT_BAYER_BGGR16LE, AV_PIX_FMT_GBRP,   "16_to_8" },
+    };
+    /* three lines, the pixels left and right of the line are read too */
+    const ptrdiff_t src_stride = 2 * LINE_W + 64;
+    LOCAL_ALIGNED_32(uint8_t, src_buf, [3 * (2 * LINE_W + 64)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [3 * (LINE_W * 2 + 64)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [3 * (LINE_W * 2 + 64)]);
+    const int plane_size = LINE_W * 2 + 64;
+    const uint8_t *src = src_buf + src_stride + 32;
+
+    declare_func(void, uint8_t *dst_c, uint8_t *dst_g, uint8_t *dst_o,
+                 const uint8_t *src, ptrdiff_t src_stride, int width);
+
+    randomize_buffers(src_buf, 3 * src_stride);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+        struct SwsContext *ctx = alloc_unscaled_context(fmts[i].src, fmts[i].dst);
+
+        if (!ctx) {
+            fail();
+            return;
+        }
+        if (check_func(ctx->bayer_interp_line, "bayer_interp_line_%s",
+                       fmts[i].name)) {
+            for (int w = 32; w <= LINE_W; w += 32) {
+                memset(dst0, 0, 3 * plane_size);
+                memset(dst1, 0, 3 * plane_size);
+                call_ref(dst0, dst0 + plane_size, dst0 + 2 * plane_size,
+                         src, src_stride, w);
+                call_new(dst1, dst1 + plane_size, dst1 + 2 * plane_size,
+                         src, src_stride, w);
+                if (memcmp(dst0, dst1, 3 * plane_size))
+                    fail();
+            }
+            bench_new(dst1, dst1 + plane_size, dst1 + 2 * plane_size,
+                      src, src_stride, LINE_W);
+        }
+        sws_freeContext(ctx);
+    }
+}
+
 void checkasm_check_sw_rgb(void)
 {
     ff_sws_rgb2rgb_init();
@@ -203,4 +544,19 @@ void checkasm_check_sw_rgb(void)
 
     check_interleave_bytes();
     report("interleave_bytes");
+
+    check_yuv2rgb_chroma_row();
+    report("yuv2rgb_chroma_row");
+
+    check_yuv2rgb_line();
+    report("yuv2rgb_line");
+
+    check_rgb2yuv_luma();
+    report("rgb2yuv_luma");
+
+    check_rgb2yuv_chroma();
+    report("rgb2yuv_chroma");
+
+    check_bayer_interp_line();
+    report("bayer_interp_line");
 }
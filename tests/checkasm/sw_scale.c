@@ -17,6 +17,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <limits.h>
 #include <string.h>
 
 #include "libavutil/common.h"
@@ -358,6 +359,121 @@ static void check_hscale(void)
     sws_freeContext(ctx);
 }
 
+#define LINEAR_WIDTH 512
+
+static void check_linear(void)
+{
+    static const int widths[] = { 1, 7, 8, 31, 144, LINEAR_WIDTH };
+    static const int filter_sizes[] = { 1, 2, 4, 7 };
+    SwsLinearContext lin = { 0 };
+    const float *lines[8];
+    int i, j, w, fsi, depth;
+
+    LOCAL_ALIGNED_32(uint16_t, src, [LINEAR_WIDTH]);
+    LOCAL_ALIGNED_32(float, srcf, [LINEAR_WIDTH * 2 + 8]);
+    LOCAL_ALIGNED_32(float, filter, [8 * LINEAR_WIDTH]);
+    LOCAL_ALIGNED_32(int32_t, filterPos, [LINEAR_WIDTH]);
+    LOCAL_ALIGNED_32(float, ring, [8 * LINEAR_WIDTH]);
+    LOCAL_ALIGNED_32(float, dst0, [LINEAR_WIDTH]);
+    LOCAL_ALIGNED_32(float, dst1, [LINEAR_WIDTH]);
+
+    for (i = 0; i < LINEAR_WIDTH * 2 + 8; i++)
+        srcf[i] = rnd() / (float)UINT_MAX;
+    for (i = 0; i < LINEAR_WIDTH; i++)
+        filterPos[i] = rnd() % (LINEAR_WIDTH * 2);
+    for (i = 0; i < 8 * LINEAR_WIDTH; i++) {
+        filter[i] = rnd() / (float)UINT_MAX - 0.25f;
+        /* outside of [0, 1] and tiny values, to hit the clipping and the
+         * start of the table of the conversion from linear light */
+        ring[i] = i % 37 ? rnd() / (float)UINT_MAX * 1.25f - 0.125f : 1e-12f;
+    }
+    randomize_buffers((uint8_t *)src, LINEAR_WIDTH * 2);
+
+    for (depth = 8; depth <= 16; depth += 8) {
+        declare_func(void, float *dst, const uint8_t *src, const float *lut,
+                     int width);
+
+        ff_sws_uninit_linear(&lin);
+        lin.is16 = depth > 8;
+        lin.planes = 3;
+        lin.vFilterSize = 1;
+        lin.dstStride = LINEAR_WIDTH;
+        if (ff_sws_init_linear(&lin, 2.2, LINEAR_WIDTH, LINEAR_WIDTH) < 0)
+            fail();
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            w = widths[i];
+            if (check_func(lin.linearize, "linearize_%d_%d", depth, w)) {
+                memset(dst0, 0, LINEAR_WIDTH * sizeof(dst0[0]));
+                memset(dst1, 0, LINEAR_WIDTH * sizeof(dst1[0]));
+                call_ref(dst0, (const uint8_t *)src, lin.lut, w);
+                call_new(dst1, (const uint8_t *)src, lin.lut, w);
+                if (memcmp(dst0, dst1, LINEAR_WIDTH * sizeof(dst0[0])))
+                    fail();
+                bench_new(dst1, (const uint8_t *)src, lin.lut, w);
+            }
+        }
+    }
+
+    for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+        const int size = filter_sizes[fsi];
+
+        declare_func(void, float *dst, const float *src, const float *filter,
+                     const int32_t *filterPos, int filterSize, int width);
+
+        /* the width is the padded output stride */
+        for (w = 16; w <= LINEAR_WIDTH; w *= 32) {
+            if (check_func(lin.hscale, "linear_hscale_fs_%d_dstW_%d", size, w)) {
+                call_ref(dst0, srcf, filter, filterPos, size, w);
+                call_new(dst1, srcf, filter, filterPos, size, w);
+                if (memcmp(dst0, dst1, w * sizeof(dst0[0])))
+                    fail();
+                bench_new(dst1, srcf, filter, filterPos, size, w);
+            }
+        }
+    }
+
+    for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+        const int size = filter_sizes[fsi];
+
+        for (j = 0; j < size; j++)
+            lines[j] = ring + j * LINEAR_WIDTH;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            declare_func(void, float *dst, const float *const *src,
+                         const float *filter, int filterSize, int width);
+            w = widths[i];
+            if (check_func(lin.vscale, "linear_vscale_fs_%d_dstW_%d", size, w)) {
+                memset(dst0, 0, LINEAR_WIDTH * sizeof(dst0[0]));
+                memset(dst1, 0, LINEAR_WIDTH * sizeof(dst1[0]));
+                call_ref(dst0, lines, filter, size, w);
+                call_new(dst1, lines, filter, size, w);
+                if (memcmp(dst0, dst1, LINEAR_WIDTH * sizeof(dst0[0])))
+                    fail();
+                bench_new(dst1, lines, filter, size, w);
+            }
+        }
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            declare_func(void, float *dst, const float *const *src,
+                         const float *filter, int filterSize,
+                         const float *lut, int width);
+            w = widths[i];
+            if (check_func(lin.vscale_delin, "linear_vscale_delin_fs_%d_dstW_%d", size, w)) {
+                memset(dst0, 0, LINEAR_WIDTH * sizeof(dst0[0]));
+                memset(dst1, 0, LINEAR_WIDTH * sizeof(dst1[0]));
+                call_ref(dst0, lines, filter, size, lin.delin_lut, w);
+                call_new(dst1, lines, filter, size, lin.delin_lut, w);
+                if (memcmp(dst0, dst1, LINEAR_WIDTH * sizeof(dst0[0])))
+                    fail();
+                bench_new(dst1, lines, filter, size, lin.delin_lut, w);
+            }
+        }
+    }
+
+    ff_sws_uninit_linear(&lin);
+}
+
 void checkasm_check_sw_scale(void)
 {
     check_hscale();
@@ -368,4 +484,6 @@ void checkasm_check_sw_scale(void)
     check_yuv2yuvX(0);
     check_yuv2yuvX(1);
     report("yuv2yuvX");
+    check_linear();
+    report("linear");
 }
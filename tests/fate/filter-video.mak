@@ -124,6 +124,20 @@ FATE_FILTER-$(call FILTERFRAMECRC, FRAMERATE TESTSRC2 FORMAT SCALE) += fate-filt
 fate-filter-framerate-12bit-up: CMD = framecrc -lavfi testsrc2=r=50:d=1,format=pix_fmts=yuv422p12le,scale,framerate=fps=60,scale -t 1 -pix_fmt yuv422p12le
 fate-filter-framerate-12bit-down: CMD = framecrc -lavfi testsrc2=r=60:d=1,format=pix_fmts=yuv422p12le,scale,framerate=fps=50,scale -t 1 -pix_fmt yuv422p12le
 
+FATE_FILTER-$(call FILTERFRAMECRC, MULTISCALE TESTSRC2 FORMAT) += fate-filter-multiscale
+fate-filter-multiscale: CMD = framecrc -lavfi testsrc2=r=5:d=1,format=yuv420p,multiscale=sizes=240\|160x90\|120:flags=bicubic+accurate_rnd+bitexact
+
+FATE_FILTER-$(call FILTERFRAMECRC, MULTISCALE TESTSRC2 FORMAT) += fate-filter-multiscale-formats
+fate-filter-multiscale-formats: CMD = framecrc -lavfi "testsrc2=r=5:d=1,format=yuv420p,multiscale=sizes=160x120|80x60:flags=bicubic+accurate_rnd+bitexact[a][b];[a]format=rgb24;[b]format=yuv444p"
+
+FATE_FILTER-$(call FILTERFRAMECRC, MULTISCALE TESTSRC2 FORMAT SETPARAMS) += fate-filter-multiscale-bt709
+fate-filter-multiscale-bt709: CMD = framecrc -lavfi "testsrc2=r=5:d=1,format=yuv420p,setparams=colorspace=bt709:range=tv,multiscale=sizes=160x120|80x60:cascade=0:flags=bicubic+accurate_rnd+bitexact[a][b];[a]format=rgb24;[b]format=gbrp"
+
+# downscaling a black and white checkerboard in linear light gives 186, not 128
+FATE_FILTER-$(call FILTERFRAMECRC, NULLSRC FORMAT GEQ SCALE) += fate-filter-scale-gamma fate-filter-scale-gamma-int
+fate-filter-scale-gamma: CMD = framecrc -lavfi "nullsrc=s=64x64:d=0.04,format=gbrp,geq=r=255*mod(X+Y\,2):g=255*mod(X+Y\,2):b=255*mod(X+Y\,2),scale=32:32:flags=bilinear+bitexact:gamma=1" -pix_fmt rgb24
+fate-filter-scale-gamma-int: CMD = framecrc -lavfi "nullsrc=s=64x64:d=0.04,format=gbrp,geq=r=255*mod(X+Y\,2):g=255*mod(X+Y\,2):b=255*mod(X+Y\,2),scale=32:32:flags=bilinear+bitexact:gamma=1:gamma_float=0" -pix_fmt rgb24
+
 FATE_FILTER-$(call FILTERFRAMECRC, MINTERPOLATE TESTSRC2) += fate-filter-minterpolate-up fate-filter-minterpolate-down
 fate-filter-minterpolate-up: CMD = framecrc -lavfi testsrc2=r=2:d=10,minterpolate=fps=10 -t 1
 fate-filter-minterpolate-down: CMD = framecrc -lavfi testsrc2=r=2:d=10,minterpolate=fps=1 -t 1
@@ -168,6 +182,9 @@ fate-filter-negate: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf perms=random,negate
 FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_HISTOGRAM_FILTER) += fate-filter-histogram-levels
 fate-filter-histogram-levels: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf histogram -flags +bitexact -sws_flags +accurate_rnd+bitexact
 
+FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_HISTOGRAM_FILTER) += fate-filter-histogram-levels-step
+fate-filter-histogram-levels-step: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf histogram=step=2 -flags +bitexact -sws_flags +accurate_rnd+bitexact
+
 FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_WAVEFORM_FILTER) += fate-filter-waveform_column
 fate-filter-waveform_column: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf waveform -flags +bitexact -sws_flags +accurate_rnd+bitexact
 
@@ -195,6 +212,9 @@ fate-filter-vectorscope_color3: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf vectors
 FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_VECTORSCOPE_FILTER) += fate-filter-vectorscope_color4
 fate-filter-vectorscope_color4: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf vectorscope=color4 -sws_flags +accurate_rnd+bitexact -frames:v 3
 
+FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_VECTORSCOPE_FILTER) += fate-filter-vectorscope_color2-step
+fate-filter-vectorscope_color2-step: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf vectorscope=color2:step=2 -sws_flags +accurate_rnd+bitexact -frames:v 3
+
 FATE_FILTER_VSYNTH_PGMYUV-$(call ALLYES, VECTORSCOPE_FILTER SCALE_FILTER) += fate-filter-vectorscope_xy
 fate-filter-vectorscope_xy: CMD = framecrc -auto_conversion_filters -c:v pgmyuv -i $(SRC) -vf vectorscope=x=0:y=1 -sws_flags +accurate_rnd+bitexact -frames:v 3
 
@@ -664,10 +684,18 @@ FATE_METADATA_FILTER-$(call ALLYES, $(CROPDETECT_DEPS)) += fate-filter-metadata-
 fate-filter-metadata-cropdetect2: SRC = $(TARGET_SAMPLES)/filter/cropdetect2.mp4
 fate-filter-metadata-cropdetect2: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;movie='$(SRC)',mestimate,cropdetect=mode=mvedges,metadata=mode=print"
 
+CROPDETECT_SPARSE_DEPS = LAVFI_INDEV TESTSRC2_FILTER PAD_FILTER SCALE_FILTER CROPDETECT_FILTER
+FATE_METADATA_FILTER-$(call ALLYES, $(CROPDETECT_SPARSE_DEPS)) += fate-filter-metadata-cropdetect-sparse
+fate-filter-metadata-cropdetect-sparse: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;testsrc2=s=320x180:r=10:d=1,pad=352:288:16:54,cropdetect=sparse=8:reset=4:round=2"
+
 FREEZEDETECT_DEPS = LAVFI_INDEV MPTESTSRC_FILTER SCALE_FILTER FREEZEDETECT_FILTER
 FATE_METADATA_FILTER-$(call ALLYES, $(FREEZEDETECT_DEPS)) += fate-filter-metadata-freezedetect
 fate-filter-metadata-freezedetect: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;mptestsrc=r=25:d=10:m=51,freezedetect"
 
+IDET_DEPS = LAVFI_INDEV TESTSRC2_FILTER TINTERLACE_FILTER SCALE_FILTER IDET_FILTER
+FATE_METADATA_FILTER-$(call ALLYES, $(IDET_DEPS)) += fate-filter-metadata-idet-step
+fate-filter-metadata-idet-step: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;testsrc2=s=320x240:r=50:d=0.4,format=yuv420p,tinterlace=mode=interleave_top,idet=step=4"
+
 SIGNALSTATS_DEPS = LAVFI_INDEV COLOR_FILTER SCALE_FILTER SIGNALSTATS_FILTER
 FATE_METADATA_FILTER-$(call ALLYES, $(SIGNALSTATS_DEPS)) += fate-filter-metadata-signalstats-yuv420p fate-filter-metadata-signalstats-yuv420p10
 fate-filter-metadata-signalstats-yuv420p: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;color=white:duration=1:r=1,signalstats"